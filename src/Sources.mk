@@ -122,6 +122,7 @@ else
         SOURCES += $(shell $(FIND) ./application -maxdepth 1 -type f -name "*.cpp")
         SOURCES += $(shell $(FIND) ./application/database -type f -name "*.cpp")
         SOURCES += $(shell $(FIND) ./application/OpenDeck -type f -name "*.cpp")
+        SOURCES += $(shell $(FIND) ./application/interface -maxdepth 1 -type f -name "*.cpp")
         SOURCES += $(shell $(FIND) ./application/interface/analog -type f -name "*.cpp")
         SOURCES += $(shell $(FIND) ./application/interface/digital/input -type f -name "*.cpp")
         SOURCES += $(shell $(FIND) ./application/interface/digital/output/leds -maxdepth 1 -type f -name "*.cpp")
@@ -0,0 +1,181 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "MIDIClock.h"
+#include "board/Board.h"
+
+namespace
+{
+    ///
+    /// \brief Shortest and longest time between two clock messages, in 1/256 of millisecond.
+    /// @{
+
+    constexpr uint32_t PERIOD_MIN = (60000UL * 256) / (MIDI_CLOCK_BPM_MAX * MIDI_CLOCK_PPQN);
+    constexpr uint32_t PERIOD_MAX = (60000UL * 256) / (MIDI_CLOCK_BPM_MIN * MIDI_CLOCK_PPQN);
+
+    /// @}
+
+    ///
+    /// \brief Parts of the phase error by which the phase and the tempo of local clock are corrected.
+    /// Tempo is corrected by smaller part so that the jitter of single message is averaged out.
+    /// @{
+
+    constexpr int32_t PHASE_CORRECTION     = 4;
+    constexpr int32_t FREQUENCY_CORRECTION = 16;
+
+    /// @}
+
+    ///
+    /// \brief Largest number of local ticks reported in single call of update.
+    /// If more ticks are due, local clock is restarted from current time.
+    ///
+    constexpr uint8_t MAX_TICKS = 4;
+}    // namespace
+
+///
+/// \brief Returns current time in 1/256 of millisecond based on microsecond timer.
+/// 125 us equal 32 units exactly, so microseconds are converted in such steps and the rest is kept for next call.
+///
+uint32_t MIDIClock::currentTime()
+{
+    uint32_t us = Board::runTimeUs();
+
+    //overflow doesn't matter since only the differences between times are used
+    usRemainder += us - lastUs;
+    lastUs = us;
+    time += (usRemainder / 125) * 32;
+    usRemainder %= 125;
+
+    return time;
+}
+
+///
+/// \brief Handles received MIDI clock message.
+/// Tempo is estimated from the time between the first two messages. Afterwards, each message
+/// is compared with the nearest local tick and the difference is used to correct local clock.
+///
+void MIDIClock::tick()
+{
+    uint32_t now      = currentTime();
+    uint32_t interval = now - lastReceived;
+
+    lastReceived = now;
+
+    if (!locked)
+    {
+        //report the message as is until the tempo is known
+        if (pending < MAX_TICKS)
+            pending++;
+
+        if (received && (interval >= PERIOD_MIN) && (interval <= PERIOD_MAX))
+        {
+            period   = interval;
+            nextTick = now + period;
+            locked   = true;
+        }
+
+        received = true;
+        return;
+    }
+
+    int32_t error = static_cast<int32_t>(now - nextTick);
+    int32_t half  = static_cast<int32_t>(period / 2);
+
+    //message received closer to the last local tick than to the next one
+    if (error < -half)
+        error += period;
+
+    if (error < -half)
+        error = -half;
+    else if (error > half)
+        error = half;
+
+    nextTick += error / PHASE_CORRECTION;
+    period += error / FREQUENCY_CORRECTION;
+
+    if (period < PERIOD_MIN)
+        period = PERIOD_MIN;
+    else if (period > PERIOD_MAX)
+        period = PERIOD_MAX;
+}
+
+///
+/// \brief Aligns local clock with received MIDI start message.
+/// Next local tick is expected once the time between two clock messages passes.
+///
+void MIDIClock::start()
+{
+    if (locked)
+        nextTick = currentTime() + period;
+}
+
+///
+/// \brief Checks how many clock ticks have elapsed since the last call.
+/// Local clock is stopped if no clock message has been received for MIDI_CLOCK_HOLD_TIME
+/// milliseconds and it's started again once the tempo is estimated from new messages.
+/// \returns Number of elapsed ticks.
+///
+uint8_t MIDIClock::update()
+{
+    uint8_t ticks = pending;
+    pending       = 0;
+
+    if (!locked)
+        return ticks;
+
+    uint32_t now = currentTime();
+
+    if ((now - lastReceived) > (static_cast<uint32_t>(MIDI_CLOCK_HOLD_TIME) << 8))
+    {
+        locked   = false;
+        received = false;
+        return ticks;
+    }
+
+    while (static_cast<int32_t>(now - nextTick) >= 0)
+    {
+        if (ticks == MAX_TICKS)
+        {
+            nextTick = now + period;
+            break;
+        }
+
+        nextTick += period;
+        ticks++;
+    }
+
+    return ticks;
+}
+
+bool MIDIClock::isLocked()
+{
+    return locked;
+}
+
+///
+/// \brief Returns the tempo of received MIDI clock rounded to whole BPM, or 0 if the tempo isn't known.
+///
+uint16_t MIDIClock::bpm()
+{
+    if (!locked)
+        return 0;
+
+    constexpr uint32_t beat = 60000UL * 256 / MIDI_CLOCK_PPQN;
+
+    return (beat + (period / 2)) / period;
+}
@@ -0,0 +1,101 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <inttypes.h>
+
+///
+/// \brief Number of MIDI clock messages sent per quarter note.
+///
+#define MIDI_CLOCK_PPQN 24
+
+///
+/// \brief Lowest and highest tempo in BPM which can be tracked.
+/// Clock messages arriving outside of this range aren't used to estimate the tempo.
+/// @{
+
+#define MIDI_CLOCK_BPM_MIN 20
+#define MIDI_CLOCK_BPM_MAX 300
+
+/// @}
+
+///
+/// \brief Time in milliseconds during which local clock keeps running after clock messages stop arriving.
+///
+#define MIDI_CLOCK_HOLD_TIME 1000
+
+///
+/// \brief Tracks the tempo of incoming MIDI clock and generates local clock ticks locked to it.
+/// Local ticks follow smoothed tempo estimate instead of the time at which clock messages are
+/// processed, so they don't inherit the jitter of USB transfers and main loop. Phase of local
+/// clock is pulled towards each received message, and tempo is corrected by the remaining error.
+/// All times are kept in 1/256 of millisecond.
+///
+class MIDIClock
+{
+    public:
+    MIDIClock() {}
+
+    void     tick();
+    void     start();
+    uint8_t  update();
+    bool     isLocked();
+    uint16_t bpm();
+
+    private:
+    uint32_t currentTime();
+
+    ///
+    /// \brief True once the tempo has been estimated and local clock is running.
+    ///
+    bool locked = false;
+
+    ///
+    /// \brief True if at least one clock message has been received since the clock has been unlocked.
+    ///
+    bool received = false;
+
+    ///
+    /// \brief Number of received clock messages which haven't been reported while the clock isn't locked.
+    ///
+    uint8_t pending = 0;
+
+    ///
+    /// \brief Time at which the last clock message has been received.
+    ///
+    uint32_t lastReceived = 0;
+
+    ///
+    /// \brief Time at which the next local tick is due.
+    ///
+    uint32_t nextTick = 0;
+
+    ///
+    /// \brief Estimated time between two clock messages.
+    ///
+    uint32_t period = 0;
+
+    ///
+    /// \brief Current time, value of microsecond timer at which it has been updated
+    /// and microseconds which haven't been added to it yet.
+    ///
+    uint32_t time        = 0;
+    uint32_t lastUs      = 0;
+    uint32_t usRemainder = 0;
+};
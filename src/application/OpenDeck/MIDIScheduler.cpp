@@ -0,0 +1,835 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "MIDIScheduler.h"
+#include "board/Board.h"
+#include "core/src/general/RingBuffer.h"
+#if defined(DIN_MIDI_SUPPORTED) || !defined(USB_MIDI_SUPPORTED)
+#include "common/OpenDeckMIDIformat/OpenDeckMIDIformat.h"
+#endif
+#ifdef USB_UMP_SUPPORTED
+#include "UMP.h"
+#endif
+
+namespace
+{
+    uint32_t usbDropped;
+
+    MIDIScheduler::selectionHandler_t selectionHandler;
+
+    ///
+    /// \brief Reports the message to selection handler if it's CC message which changes NRPN parameter selection.
+    ///
+    void checkSelection(MIDI::interface_t interface, uint8_t status, uint8_t control, bool written)
+    {
+        if (selectionHandler == nullptr)
+            return;
+
+        if (((status & 0xF0) != 0xB0) || (control < 98) || (control > 101))
+            return;
+
+        selectionHandler(interface, status & 0x0F, written);
+    }
+
+    ///
+    /// \brief Cable used for USB packets written by the MIDI module.
+    ///
+    MIDIScheduler::usbCable_t usbCable;
+
+    ///
+    /// \brief Cable on which the last USB packet has been received.
+    ///
+    MIDIScheduler::usbCable_t usbReceivedCable;
+
+    ///
+    /// \brief Address of the board to which the traffic received on daisy-chain cable is sent, 0 for all the boards.
+    ///
+    uint8_t daisyChainAddress;
+
+    MIDIScheduler::inputStats_t usbInputStats;
+
+    ///
+    /// \brief Checks if the message with specified status byte carries continuous control
+    /// (control change, pitch bend or aftertouch). Newer value of such control follows soon
+    /// so these messages can be dropped if there is no room for them.
+    ///
+    bool isDroppable(uint8_t status)
+    {
+        switch (status & 0xF0)
+        {
+        case 0xA0:
+        case 0xB0:
+        case 0xD0:
+        case 0xE0:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+#ifndef USB_MIDI_SUPPORTED
+    ///
+    /// \brief Returns the number of bytes which can be written to USB link without blocking.
+    /// Packets collected for the next batch frame are sent from the same buffer.
+    ///
+    size_t linkSpace()
+    {
+        size_t space   = Board::UART::txSpace(UART_USB_LINK_CHANNEL);
+        size_t pending = OpenDeckMIDIformat::pendingBytes(UART_USB_LINK_CHANNEL);
+
+        return space > pending ? space - pending : 0;
+    }
+#endif
+
+#ifdef USB_UMP_SUPPORTED
+    UMP ump;
+#endif
+
+    ///
+    /// \brief USB packets which can't be dropped and couldn't be written right away, oldest first.
+    /// Retried on each flush so that the main loop never waits for the host or USB link.
+    ///
+    MIDI::USBMIDIpacket_t usbRetry[MIDI_SCHEDULER_USB_RETRY_SIZE];
+    uint8_t               usbRetryCount;
+
+    ///
+    /// \brief Checks if the USB interface can accept packets at all.
+    /// Packets aren't kept for retry while the host isn't connected.
+    ///
+    bool usbReady()
+    {
+#ifdef USB_MIDI_SUPPORTED
+        return Board::USB::isConfigured();
+#else
+        return true;
+#endif
+    }
+
+    ///
+    /// \brief Writes USB packet to USB interface if there is room for it.
+    /// \returns True if the packet has been written, false otherwise.
+    ///
+    bool writeUSBpacket(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+    {
+#ifdef USB_MIDI_SUPPORTED
+#ifdef USB_UMP_SUPPORTED
+        if (Board::USB::isUMPenabled())
+        {
+            uint32_t words[UMP_MAX_WORDS];
+            uint8_t  count = UMP::fromUSBMIDI(USBMIDIpacket, words);
+
+            //packets without UMP equivalent are ignored
+            return !count || Board::USB::writeUMP(words, count);
+        }
+#endif
+
+        return Board::USB::writeMIDI(USBMIDIpacket);
+#else
+        if (linkSpace() < MIDI_SCHEDULER_USB_LINK_PACKET_SIZE)
+            return false;
+
+        return OpenDeckMIDIformat::write(UART_USB_LINK_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midi);
+#endif
+    }
+
+    ///
+    /// \brief Writes as many packets waiting for retry as there is room for, in order.
+    ///
+    void retryUSB()
+    {
+        if (!usbReady())
+        {
+            usbDropped += usbRetryCount;
+            usbRetryCount = 0;
+            return;
+        }
+
+        uint8_t sent = 0;
+
+        while ((sent < usbRetryCount) && writeUSBpacket(usbRetry[sent]))
+            sent++;
+
+        if (!sent)
+            return;
+
+        usbRetryCount -= sent;
+
+        for (int i = 0; i < usbRetryCount; i++)
+            usbRetry[i] = usbRetry[i + sent];
+    }
+
+#ifdef USB_UMP_SUPPORTED
+    ///
+    /// \brief USB MIDI packets converted from the last UMP message received from host.
+    ///
+    MIDI::USBMIDIpacket_t umpPackets[UMP_MAX_USB_PACKETS];
+    uint8_t               umpPacketCount;
+    uint8_t               umpPacketIndex;
+
+    ///
+    /// \brief Words of UMP message received from host so far.
+    /// Message can span over several reads if the host hasn't sent all of its words yet.
+    ///
+    uint32_t umpWords[UMP_MAX_WORDS];
+    uint8_t  umpWordCount;
+
+    ///
+    /// \brief If set, USB packets written by the MIDI module are discarded since the
+    /// same message has already been sent as single high-resolution message.
+    ///
+    bool usbMuted;
+
+    ///
+    /// \brief Reads single UMP word. Each USB MIDI packet received in USB MIDI 2.0 mode holds one word.
+    ///
+    bool readUMPword(uint32_t& word)
+    {
+        MIDI::USBMIDIpacket_t packet;
+
+        if (!Board::USB::readMIDI(packet))
+            return false;
+
+        word = packet.Event | (packet.Data1 << 8) | (static_cast<uint32_t>(packet.Data2) << 16) | (static_cast<uint32_t>(packet.Data3) << 24);
+        return true;
+    }
+
+    ///
+    /// \brief Reads UMP message from USB interface and returns it packet by packet
+    /// after converting it to USB MIDI packets.
+    ///
+    bool readUMP(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+    {
+        while (umpPacketIndex == umpPacketCount)
+        {
+            if (!umpWordCount)
+            {
+                if (!readUMPword(umpWords[0]))
+                    return false;
+
+                umpWordCount = 1;
+            }
+
+            uint8_t count = UMP::messageWords(umpWords[0]);
+
+            for (; umpWordCount < count; umpWordCount++)
+            {
+                //remaining words are read on next call
+                if (!readUMPword(umpWords[umpWordCount]))
+                    return false;
+            }
+
+            umpWordCount   = 0;
+            umpPacketIndex = 0;
+            umpPacketCount = ump.toUSBMIDI(umpWords, umpPackets);
+        }
+
+        USBMIDIpacket = umpPackets[umpPacketIndex++];
+        return true;
+    }
+#endif
+
+#ifdef DIN_MIDI_SUPPORTED
+    uint32_t                    dinDropped;
+    MIDIScheduler::inputStats_t dinInputStats;
+
+    ///
+    /// \brief Status byte of the message which is currently being written by the MIDI module.
+    ///
+    uint8_t runningStatus;
+
+    ///
+    /// \brief Last status byte which was actually written to UART.
+    /// Differs from runningStatus if the message with new status byte was dropped.
+    ///
+    uint8_t sentStatus;
+
+    ///
+    /// \brief Number of data bytes left in the message which is currently being written.
+    ///
+    uint8_t remaining;
+
+    bool dropping;
+    bool sysExActive;
+
+    ///
+    /// \brief Bytes of the messages which can't be dropped and couldn't be written right away.
+    /// Retried on each flush so that the main loop never waits for UART.
+    ///
+    core::RingBuffer<uint8_t, MIDI_SCHEDULER_DIN_RETRY_SIZE> dinRetry;
+
+    ///
+    /// \brief Writes single byte to DIN MIDI interface without waiting for space.
+    /// Byte is kept for retry if there is no room or if earlier bytes are still waiting,
+    /// so that the order of the bytes is preserved. If there is no room for retry either,
+    /// byte is dropped and counted.
+    ///
+    void writeDINbyte(uint8_t data)
+    {
+        if (dinRetry.isEmpty() && Board::UART::txSpace(UART_MIDI_CHANNEL))
+        {
+            Board::UART::write(UART_MIDI_CHANNEL, data);
+            return;
+        }
+
+        if (!dinRetry.insert(data))
+            dinDropped++;
+    }
+
+    ///
+    /// \brief Writes as many bytes waiting for retry as there is room for.
+    ///
+    void retryDIN()
+    {
+        uint8_t data;
+
+        while (Board::UART::txSpace(UART_MIDI_CHANNEL) && dinRetry.remove(data))
+            Board::UART::write(UART_MIDI_CHANNEL, data);
+    }
+
+    ///
+    /// \brief Returns total length of MIDI message in bytes based on its status byte.
+    ///
+    uint8_t messageLength(uint8_t status)
+    {
+        switch (status & 0xF0)
+        {
+        case 0xC0:
+        case 0xD0:
+            return 2;
+
+        case 0xF0:
+        {
+            switch (status)
+            {
+            case 0xF1:
+            case 0xF3:
+                return 2;
+
+            case 0xF2:
+                return 3;
+
+            default:
+                return 1;
+            }
+        }
+
+        default:
+            return 3;
+        }
+    }
+
+    ///
+    /// \brief Checks if the message with specified status byte and length should be written to DIN TX buffer.
+    /// Continuous controls are dropped if they can't be written right away. Other messages are
+    /// always written since they wait for retry if needed. Dropped message is counted.
+    ///
+    bool reserveDIN(uint8_t status, size_t length)
+    {
+        dropping = isDroppable(status) && (!dinRetry.isEmpty() || (Board::UART::txSpace(UART_MIDI_CHANNEL) < length));
+
+        if (dropping)
+            dinDropped++;
+
+        return !dropping;
+    }
+#endif
+}    // namespace
+
+#ifdef DIN_MIDI_SUPPORTED
+///
+/// \brief Writes single byte coming from the MIDI module to DIN MIDI interface.
+/// Whether the message is written or dropped is decided once its first byte arrives.
+/// Only continuous controls are dropped if there is no room, all other messages wait for retry
+/// so that note off messages don't get lost. When the message with new status byte is dropped, status byte is inserted before the
+/// following message which relies on running status.
+/// \returns Always true since the remaining bytes of dropped message are expected to follow.
+///
+bool MIDIScheduler::writeDIN(uint8_t data)
+{
+    //real-time messages are single byte and can be inserted anywhere, even inside other messages
+    if (data >= 0xF8)
+    {
+        writeDINbyte(data);
+        return true;
+    }
+
+    if (sysExActive)
+    {
+        if ((data == 0xF7) || !(data & 0x80))
+        {
+            if (data == 0xF7)
+                sysExActive = false;
+
+            writeDINbyte(data);
+            return true;
+        }
+
+        //any other status byte terminates system exclusive message
+        sysExActive = false;
+    }
+
+    if (data & 0x80)
+    {
+        if (data == 0xF0)
+        {
+            sysExActive   = true;
+            runningStatus = 0;
+            sentStatus    = 0;
+            remaining     = 0;
+
+            writeDINbyte(data);
+            return true;
+        }
+
+        remaining = messageLength(data) - 1;
+
+        //system common messages cancel running status
+        runningStatus = (data < 0xF0) ? data : 0;
+
+        if (reserveDIN(data, remaining + 1))
+        {
+            sentStatus = runningStatus;
+            writeDINbyte(data);
+        }
+
+        return true;
+    }
+
+    if (!remaining)
+    {
+        //new message using running status
+        if (!runningStatus)
+            return true;    //stray data byte
+
+        remaining = messageLength(runningStatus) - 1;
+
+        bool insertStatus = sentStatus != runningStatus;
+
+        if (reserveDIN(runningStatus, remaining + insertStatus) && insertStatus)
+        {
+            sentStatus = runningStatus;
+            writeDINbyte(runningStatus);
+        }
+    }
+
+    //first data byte of control change message holds the control number
+    if (remaining == 2)
+        checkSelection(MIDI::interface_t::din, runningStatus, data, !dropping);
+
+    remaining--;
+
+    if (!dropping)
+        writeDINbyte(data);
+
+    return true;
+}
+
+///
+/// \brief Resets the state of DIN MIDI output.
+/// Should be called once the DIN MIDI interface is initialized.
+///
+void MIDIScheduler::resetDIN()
+{
+    runningStatus = 0;
+    sentStatus    = 0;
+    remaining     = 0;
+    dropping      = false;
+    sysExActive   = false;
+    dinRetry.reset();
+}
+#endif
+
+///
+/// \brief Writes USB MIDI packet coming from the MIDI module to USB interface
+/// using the cable set with setUSBcable.
+/// \returns True if the packet has been written, false if it was dropped.
+///
+bool MIDIScheduler::writeUSB(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+{
+#ifdef USB_UMP_SUPPORTED
+    if (usbMuted)
+        return true;
+#endif
+
+    bool written = forwardUSB(USBMIDIpacket, usbCable);
+
+    //code index number 0x0B is used for control change
+    if ((USBMIDIpacket.Event & 0x0F) == 0x0B)
+        checkSelection(MIDI::interface_t::usb, USBMIDIpacket.Data1, USBMIDIpacket.Data2, written);
+
+    return written;
+}
+
+///
+/// \brief Registers the function called for each CC message which changes NRPN parameter selection.
+/// Used to keep track of the selection on each interface.
+///
+void MIDIScheduler::registerSelectionHandler(selectionHandler_t handler)
+{
+    selectionHandler = handler;
+}
+
+///
+/// \brief Writes USB MIDI packet to USB interface using specified cable.
+/// \returns True if the packet has been written, false if it was dropped.
+///
+bool MIDIScheduler::forwardUSB(MIDI::USBMIDIpacket_t& USBMIDIpacket, usbCable_t cable)
+{
+    //cable number is stored in upper nibble of event byte
+    USBMIDIpacket.Event = (static_cast<uint8_t>(cable) << 4) | (USBMIDIpacket.Event & 0x0F);
+
+    //code index numbers of channel messages match upper nibble of their status byte
+    //only continuous controls are dropped, other packets wait for retry
+    bool droppable = isDroppable((USBMIDIpacket.Event & 0x0F) << 4);
+
+    //packets waiting for retry are written first so that the order is preserved
+    if ((!usbRetryCount || droppable) && writeUSBpacket(USBMIDIpacket))
+        return true;
+
+    if (!droppable && usbReady() && (usbRetryCount < MIDI_SCHEDULER_USB_RETRY_SIZE))
+    {
+        usbRetry[usbRetryCount++] = USBMIDIpacket;
+        return true;
+    }
+
+    usbDropped++;
+    return false;
+}
+
+///
+/// \brief Reads USB MIDI packet from USB interface and remembers the cable on which it has been received.
+/// \returns True if the packet is available, false otherwise.
+///
+bool MIDIScheduler::readUSB(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+{
+#ifdef USB_MIDI_SUPPORTED
+#ifdef USB_UMP_SUPPORTED
+    if (Board::USB::isUMPenabled())
+    {
+        if (!readUMP(USBMIDIpacket))
+            return false;
+    }
+    else
+    {
+        //leftovers from USB MIDI 2.0 mode are no longer valid
+        umpPacketIndex = umpPacketCount;
+        umpWordCount   = 0;
+        ump.reset();
+
+        if (!Board::USB::readMIDI(USBMIDIpacket))
+            return false;
+    }
+#else
+    if (!Board::USB::readMIDI(USBMIDIpacket))
+        return false;
+#endif
+#else
+    OpenDeckMIDIformat::packetType_t odPacketType;
+
+    if (!OpenDeckMIDIformat::read(UART_USB_LINK_CHANNEL, USBMIDIpacket, odPacketType))
+        return false;
+
+    if (odPacketType != OpenDeckMIDIformat::packetType_t::midi)
+        return false;
+#endif
+
+    uint8_t cable = USBMIDIpacket.Event >> 4;
+
+    //host shouldn't use cables which aren't defined in descriptors
+    if (cable >= static_cast<uint8_t>(usbCable_t::AMOUNT))
+        cable = static_cast<uint8_t>(usbCable_t::performance);
+
+    usbReceivedCable = static_cast<usbCable_t>(cable);
+    return true;
+}
+
+///
+/// \brief Sets the cable used for all subsequent USB packets written by the MIDI module.
+///
+void MIDIScheduler::setUSBcable(usbCable_t cable)
+{
+    usbCable = cable;
+}
+
+///
+/// \brief Returns the cable on which the last USB packet has been received.
+///
+MIDIScheduler::usbCable_t MIDIScheduler::receivedUSBcable()
+{
+    return usbReceivedCable;
+}
+
+///
+/// \brief Checks whether the specified cable carries the traffic of other boards in daisy-chain configuration.
+///
+bool MIDIScheduler::isDaisyChainCable(usbCable_t cable)
+{
+    return cable >= usbCable_t::daisyChain;
+}
+
+///
+/// \brief Returns the cable used for the board with specified address in daisy-chain configuration.
+/// Boards which don't have cable of their own share the daisy-chain cable.
+///
+MIDIScheduler::usbCable_t MIDIScheduler::nodeCable(uint8_t address)
+{
+    uint8_t cable = static_cast<uint8_t>(usbCable_t::daisyChain) + address;
+
+    if (!address || (cable >= static_cast<uint8_t>(usbCable_t::AMOUNT)))
+        return usbCable_t::daisyChain;
+
+    return static_cast<usbCable_t>(cable);
+}
+
+///
+/// \brief Returns the address of the board to which the traffic received on specified daisy-chain cable is sent.
+/// \returns Board address, or 0 if the traffic is meant for all the boards.
+///
+uint8_t MIDIScheduler::cableNode(usbCable_t cable)
+{
+    if (cable < usbCable_t::daisyChain)
+        return 0;
+
+    if (cable == usbCable_t::daisyChain)
+        return daisyChainAddress;
+
+    return static_cast<uint8_t>(cable) - static_cast<uint8_t>(usbCable_t::daisyChain);
+}
+
+///
+/// \brief Selects the board to which the traffic received on shared daisy-chain cable is sent.
+/// Used to reach the boards which don't have cable of their own one by one.
+/// @param [in] address Board address, or 0 to send the traffic to all the boards.
+///
+void MIDIScheduler::setDaisyChainTarget(uint8_t address)
+{
+    daisyChainAddress = address;
+}
+
+uint8_t MIDIScheduler::daisyChainTarget()
+{
+    return daisyChainAddress;
+}
+
+///
+/// \brief Calculates the number of 3-byte MIDI messages which continuous controls can send without
+/// blocking on any of the interfaces. Part of each buffer is kept free for notes and real-time messages.
+///
+size_t MIDIScheduler::capacity()
+{
+    //native USB isn't a bottleneck
+    size_t capacity = 0xFF;
+
+#ifndef USB_MIDI_SUPPORTED
+    size_t usbSpace = linkSpace();
+
+    if (usbSpace < MIDI_SCHEDULER_USB_LINK_RESERVE)
+        return 0;
+
+    capacity = (usbSpace - MIDI_SCHEDULER_USB_LINK_RESERVE) / MIDI_SCHEDULER_USB_LINK_PACKET_SIZE;
+#endif
+
+#ifdef DIN_MIDI_SUPPORTED
+    size_t dinSpace = Board::UART::txSpace(UART_MIDI_CHANNEL);
+
+    if (dinSpace < MIDI_SCHEDULER_DIN_RESERVE)
+        return 0;
+
+    if (((dinSpace - MIDI_SCHEDULER_DIN_RESERVE) / 3) < capacity)
+        capacity = (dinSpace - MIDI_SCHEDULER_DIN_RESERVE) / 3;
+#endif
+
+    return capacity;
+}
+
+///
+/// \brief Sends all the data collected during the current pass through the main loop.
+/// Messages which couldn't be written earlier are retried first.
+/// Packets for USB link and daisy chain are collected until UART interface becomes idle
+/// so that as many of them as possible are sent in single frame.
+///
+void MIDIScheduler::flush()
+{
+    retryUSB();
+
+#ifdef DIN_MIDI_SUPPORTED
+    retryDIN();
+#endif
+
+#ifdef USB_MIDI_SUPPORTED
+    Board::USB::flushMIDI();
+#else
+    OpenDeckMIDIformat::flush(UART_USB_LINK_CHANNEL);
+#endif
+
+#ifdef DIN_MIDI_SUPPORTED
+    OpenDeckMIDIformat::flush(UART_MIDI_CHANNEL);
+#endif
+}
+
+///
+/// \brief Returns the number of bytes waiting to be sent on specified interface.
+/// USB packets are passed on to the endpoint right away so USB queue depth is
+/// reported only when USB link is used. Packets collected for the next batch frame
+/// are included.
+///
+size_t MIDIScheduler::queueDepth(MIDI::interface_t interface)
+{
+    switch (interface)
+    {
+#ifdef DIN_MIDI_SUPPORTED
+    case MIDI::interface_t::din:
+        return Board::UART::txPending(UART_MIDI_CHANNEL);
+#endif
+
+#ifndef USB_MIDI_SUPPORTED
+    case MIDI::interface_t::usb:
+        return Board::UART::txPending(UART_USB_LINK_CHANNEL) + OpenDeckMIDIformat::pendingBytes(UART_USB_LINK_CHANNEL);
+#endif
+
+    default:
+        return 0;
+    }
+}
+
+///
+/// \brief Returns the number of messages dropped on specified interface since startup.
+///
+uint32_t MIDIScheduler::dropped(MIDI::interface_t interface)
+{
+    switch (interface)
+    {
+#ifdef DIN_MIDI_SUPPORTED
+    case MIDI::interface_t::din:
+        return dinDropped;
+#endif
+
+    case MIDI::interface_t::usb:
+        return usbDropped;
+
+    default:
+        return 0;
+    }
+}
+
+///
+/// \brief Returns the amount of incoming data waiting to be processed on specified interface.
+/// Bytes are reported for DIN MIDI and packets for USB. Native USB reports only the packets
+/// which can be read in one go.
+///
+size_t MIDIScheduler::inputPending(MIDI::interface_t interface)
+{
+    switch (interface)
+    {
+#ifdef DIN_MIDI_SUPPORTED
+    case MIDI::interface_t::din:
+        return Board::UART::rxPending(UART_MIDI_CHANNEL);
+#endif
+
+    case MIDI::interface_t::usb:
+    {
+#ifdef USB_MIDI_SUPPORTED
+        MIDI::USBMIDIpacket_t* packets;
+        size_t                 pending = Board::USB::peekMIDI(packets);
+
+#ifdef USB_UMP_SUPPORTED
+        pending += umpPacketCount - umpPacketIndex;
+#endif
+
+        return pending;
+#else
+        return Board::UART::rxPending(UART_USB_LINK_CHANNEL) / MIDI_SCHEDULER_USB_LINK_PACKET_SIZE;
+#endif
+    }
+
+    default:
+        return 0;
+    }
+}
+
+///
+/// \brief Returns statistics about incoming data on specified interface.
+/// Statistics are updated by the caller which processes incoming data.
+///
+MIDIScheduler::inputStats_t& MIDIScheduler::inputStats(MIDI::interface_t interface)
+{
+#ifdef DIN_MIDI_SUPPORTED
+    if (interface == MIDI::interface_t::din)
+        return dinInputStats;
+#endif
+
+    return usbInputStats;
+}
+
+#ifdef USB_UMP_SUPPORTED
+///
+/// \brief Sends the message generated by MIDI output stage to USB as single MIDI 2.0 message.
+/// Used only for messages which would otherwise be sent as several MIDI 1.0 messages
+/// (NRPN and 14-bit control change). Assignable controller message is used for NRPN.
+/// \returns True if the message has been sent to USB, false if it should be sent using the MIDI module.
+///
+bool MIDIScheduler::writeHighRes(Interface::MIDIOutput::message_t type, uint8_t channel, uint16_t id, uint16_t value)
+{
+    if (!Board::USB::isUMPenabled())
+        return false;
+
+    using message_t = Interface::MIDIOutput::message_t;
+
+    uint32_t words[UMP_MAX_WORDS];
+    uint8_t  group = static_cast<uint8_t>(usbCable);
+
+    switch (type)
+    {
+    case message_t::nrpn7bit:
+    {
+        UMP::channelVoice(group, UMP::opcode_t::assignableController, channel, ((id >> 7) << 8) | (id & 0x7F), UMP::scaleUp(value, 7, 32), words);
+    }
+    break;
+
+    case message_t::nrpn14bit:
+    {
+        UMP::channelVoice(group, UMP::opcode_t::assignableController, channel, ((id >> 7) << 8) | (id & 0x7F), UMP::scaleUp(value, 14, 32), words);
+    }
+    break;
+
+    case message_t::controlChange14bit:
+    {
+        UMP::channelVoice(group, UMP::opcode_t::controlChange, channel, id << 8, UMP::scaleUp(value, 14, 32), words);
+    }
+    break;
+
+    default:
+        return false;
+    }
+
+    if (!Board::USB::writeUMP(words, 2))
+        usbDropped++;
+
+    return true;
+}
+
+///
+/// \brief Enables or disables discarding of USB packets written by the MIDI module.
+/// Used while the message which has already been sent using writeHighRes is sent to other interfaces.
+///
+void MIDIScheduler::muteUSB(bool state)
+{
+    usbMuted = state;
+}
+#endif
@@ -0,0 +1,112 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include "midi/src/MIDI.h"
+#include "interface/MIDIOutput.h"
+
+///
+/// \brief Number of bytes in DIN MIDI TX buffer which continuous controls can't use.
+/// Ensures that note and real-time messages can be sent even while controls are moving.
+///
+#define MIDI_SCHEDULER_DIN_RESERVE 9
+
+///
+/// \brief Number of bytes used to send single USB MIDI packet over USB link.
+///
+#define MIDI_SCHEDULER_USB_LINK_PACKET_SIZE 6
+
+///
+/// \brief Number of bytes in USB link TX buffer which continuous controls can't use.
+///
+#define MIDI_SCHEDULER_USB_LINK_RESERVE (2 * MIDI_SCHEDULER_USB_LINK_PACKET_SIZE)
+
+///
+/// \brief Sits between the MIDI module and outgoing interfaces.
+/// Continuous controls (control change, pitch bend and aftertouch) for which there is no room
+/// are dropped as a whole and counted since newer value follows soon. All other messages wait
+/// in small retry queue for each interface and are written on flush once there is room for them:
+/// dropped note off would leave the note stuck and system exclusive messages carry configuration
+/// responses. Main loop never waits for space. Messages are dropped only once the retry queue is full.
+/// Once the host selects USB MIDI 2.0, USB packets are translated to and from Universal MIDI Packets.
+///
+class MIDIScheduler
+{
+    public:
+    MIDIScheduler() {}
+
+    ///
+    /// \brief List of virtual cables exposed over USB.
+    /// Must match the cables defined in USB descriptors.
+    ///
+    enum class usbCable_t : uint8_t
+    {
+        performance,      ///< MIDI traffic generated by components and received from host.
+        configuration,    ///< SysEx configuration and component info messages.
+        daisyChain,       ///< Traffic from and to other boards in daisy-chain configuration.
+                          ///< Used for boards which don't have cable of their own. Traffic from host is sent
+                          ///< to all the boards or only to the board selected with setDaisyChainTarget.
+        node1,            ///< Traffic from and to the board with address 1 in daisy-chain configuration.
+        node2,            ///< Traffic from and to the board with address 2 in daisy-chain configuration.
+        node3,            ///< Traffic from and to the board with address 3 in daisy-chain configuration.
+        node4,            ///< Traffic from and to the board with address 4 in daisy-chain configuration.
+        AMOUNT
+    };
+
+    ///
+    /// \brief Called once CC message which changes NRPN parameter selection (CC 98-101)
+    /// is written to or dropped on USB or DIN interface.
+    ///
+    using selectionHandler_t = void (*)(MIDI::interface_t interface, uint8_t channel, bool written);
+
+    ///
+    /// \brief Structure holding statistics about incoming data on single interface.
+    ///
+    typedef struct
+    {
+        size_t   maxDepth;    ///< Largest amount of data found waiting to be processed.
+        uint32_t maxAge;      ///< Longest time in milliseconds for which data waited to be processed.
+    } inputStats_t;
+
+#ifdef DIN_MIDI_SUPPORTED
+    static bool writeDIN(uint8_t data);
+    static void resetDIN();
+#endif
+    static void          registerSelectionHandler(selectionHandler_t handler);
+    static bool          writeUSB(MIDI::USBMIDIpacket_t& USBMIDIpacket);
+    static bool          forwardUSB(MIDI::USBMIDIpacket_t& USBMIDIpacket, usbCable_t cable);
+    static bool          readUSB(MIDI::USBMIDIpacket_t& USBMIDIpacket);
+    static void          setUSBcable(usbCable_t cable);
+    static usbCable_t    receivedUSBcable();
+    static bool          isDaisyChainCable(usbCable_t cable);
+    static usbCable_t    nodeCable(uint8_t address);
+    static uint8_t       cableNode(usbCable_t cable);
+    static void          setDaisyChainTarget(uint8_t address);
+    static uint8_t       daisyChainTarget();
+    static size_t        capacity();
+    static void          flush();
+    static size_t        queueDepth(MIDI::interface_t interface);
+    static uint32_t      dropped(MIDI::interface_t interface);
+    static size_t        inputPending(MIDI::interface_t interface);
+    static inputStats_t& inputStats(MIDI::interface_t interface);
+#ifdef USB_UMP_SUPPORTED
+    static bool writeHighRes(Interface::MIDIOutput::message_t type, uint8_t channel, uint16_t id, uint16_t value);
+    static void muteUSB(bool state);
+#endif
+};
@@ -20,11 +20,15 @@ limitations under the License.
 #include "core/src/general/Timing.h"
 #include "core/src/general/Interrupt.h"
 #include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
+#include "MIDIScheduler.h"
+#include "MIDIClock.h"
 
 // clang-format off
 ComponentInfo                       cinfo;
 Database                            database(Board::eeprom::read, Board::eeprom::write, EEPROM_SIZE - 3);
 MIDI                                midi;
+Interface::MIDIOutput               midiOutput(midi);
 Interface::digital::input::Common   digitalInputCommon;
 #ifdef DISPLAY_SUPPORTED
 Interface::Display                  display(database);
@@ -35,20 +39,23 @@ Interface::Display                  display(database);
 SDW                                 sdw;
 Interface::Touchscreen              touchscreen(sdw);
 #endif
+#if defined(LEDS_SUPPORTED) || defined(DISPLAY_SUPPORTED)
+MIDIClock                           midiClock;
+#endif
 #ifdef LEDS_SUPPORTED
 Interface::digital::output::LEDs    leds(database);
 #endif
 #ifdef LEDS_SUPPORTED
 #ifdef DISPLAY_SUPPORTED
-Interface::analog::Analog           analog(database, midi, leds, display, cinfo);
+Interface::analog::Analog           analog(database, midiOutput, leds, display, cinfo);
 #else
-Interface::analog::Analog           analog(database, midi, leds, cinfo);
+Interface::analog::Analog           analog(database, midiOutput, leds, cinfo);
 #endif
 #else
 #ifdef DISPLAY_SUPPORTED
-Interface::analog::Analog           analog(database, midi, display, cinfo);
+Interface::analog::Analog           analog(database, midiOutput, display, cinfo);
 #else
-Interface::analog::Analog           analog(database, midi, cinfo);
+Interface::analog::Analog           analog(database, midiOutput, cinfo);
 #endif
 #endif
 #ifdef LEDS_SUPPORTED
@@ -65,9 +72,9 @@ Interface::digital::input::Buttons  buttons(database, midi, cinfo);
 #endif
 #endif
 #ifdef DISPLAY_SUPPORTED
-Interface::digital::input::Encoders encoders(database, midi, display, cinfo);
+Interface::digital::input::Encoders encoders(database, midiOutput, display, cinfo);
 #else
-Interface::digital::input::Encoders encoders(database, midi, cinfo);
+Interface::digital::input::Encoders encoders(database, midiOutput, cinfo);
 #endif
 #ifdef LEDS_SUPPORTED
 #ifdef DISPLAY_SUPPORTED
@@ -84,6 +91,83 @@ SysConfig                           sysConfig(database, midi, buttons, encoders,
 #endif
 // clang-format on
 
+namespace
+{
+#ifdef USB_MIDI_SUPPORTED
+    ///
+    /// \brief Holds USB connection state from last pass through the main loop.
+    ///
+    bool usbConfigured;
+#endif
+
+    ///
+    /// \brief USB cable on which the configuration has been received last.
+    /// Component info messages are sent on the same cable.
+    ///
+    MIDIScheduler::usbCable_t configCable = MIDIScheduler::usbCable_t::configuration;
+
+#ifdef DISPLAY_SUPPORTED
+    ///
+    /// \brief Tempo of received MIDI clock last shown on display.
+    ///
+    uint16_t lastClockBPM;
+#endif
+
+    ///
+    /// \brief Holds the state used to measure how long incoming data waits to be processed.
+    ///
+    typedef struct
+    {
+        bool     waiting;
+        uint32_t since;
+    } inputTracker_t;
+
+    inputTracker_t usbInput;
+#ifdef DIN_MIDI_SUPPORTED
+    inputTracker_t dinInput;
+#endif
+
+    ///
+    /// \brief Time at which the previous call of checkMIDI has finished.
+    ///
+    uint32_t lastInputCheck;
+
+    ///
+    /// \brief Updates the input statistics for specified interface before the incoming data is processed.
+    ///
+    void inputCheckStart(MIDI::interface_t interface, inputTracker_t& tracker)
+    {
+        auto&  stats   = MIDIScheduler::inputStats(interface);
+        size_t pending = MIDIScheduler::inputPending(interface);
+
+        if (pending > stats.maxDepth)
+            stats.maxDepth = pending;
+
+        //data could have arrived right after the previous check
+        if (pending && !tracker.waiting)
+        {
+            tracker.waiting = true;
+            tracker.since   = lastInputCheck;
+        }
+    }
+
+    ///
+    /// \brief Updates the input statistics for specified interface once the incoming data is processed.
+    /// Waiting time is known only once all the pending data is processed.
+    ///
+    void inputCheckEnd(MIDI::interface_t interface, inputTracker_t& tracker, uint32_t now)
+    {
+        if (!tracker.waiting || MIDIScheduler::inputPending(interface))
+            return;
+
+        auto& stats     = MIDIScheduler::inputStats(interface);
+        tracker.waiting = false;
+
+        if ((now - tracker.since) > stats.maxAge)
+            stats.maxAge = now - tracker.since;
+    }
+}    // namespace
+
 void OpenDeck::init()
 {
     Board::init();
@@ -95,6 +179,7 @@ void OpenDeck::init()
 #endif
 
     encoders.init();
+    analog.init();
 
 #ifdef DISPLAY_SUPPORTED
     display.init(true);
@@ -108,7 +193,22 @@ void OpenDeck::init()
 #endif
 
     cinfo.registerHandler([](Database::block_t dbBlock, SysExConf::sysExParameter_t componentID) {
-        return sysConfig.sendCInfo(dbBlock, componentID);
+        MIDIScheduler::setUSBcable(configCable);
+        bool result = sysConfig.sendCInfo(dbBlock, componentID);
+        MIDIScheduler::setUSBcable(MIDIScheduler::usbCable_t::performance);
+
+        return result;
+    });
+
+    midiOutput.registerCapacityHandler(MIDIScheduler::capacity);
+#ifdef USB_UMP_SUPPORTED
+    midiOutput.registerHighResHandler(MIDIScheduler::writeHighRes, MIDIScheduler::muteUSB);
+#endif
+
+    //buttons send control changes using the MIDI module directly
+    //parameter selection is tracked on the interfaces so that it's updated regardless of the sender
+    MIDIScheduler::registerSelectionHandler([](MIDI::interface_t interface, uint8_t channel, bool written) {
+        midiOutput.selectionChanged(interface, channel, written);
     });
 
     analog.setButtonHandler([](uint8_t analogIndex, uint16_t adcValue) {
@@ -122,6 +222,9 @@ void OpenDeck::init()
 #endif
 
     database.setPresetChangeHandler([](uint8_t preset) {
+        //make sure analog settings from new preset are applied
+        analog.init();
+
 #ifdef LEDS_SUPPORTED
         leds.midiToState(MIDI::messageType_t::programChange, preset, 0, 0, true);
 #endif
@@ -152,10 +255,26 @@ void OpenDeck::checkComponents()
         }
 
         analog.update();
+#if defined(LEDS_SUPPORTED) || defined(DISPLAY_SUPPORTED)
+        uint8_t clockTicks = midiClock.update();
+#endif
 #ifdef LEDS_SUPPORTED
+        for (; clockTicks; clockTicks--)
+            leds.checkBlinking(true);
+
         leds.checkBlinking();
 #endif
 
+#ifdef DISPLAY_SUPPORTED
+        if (midiClock.bpm() != lastClockBPM)
+        {
+            lastClockBPM = midiClock.bpm();
+
+            if (lastClockBPM)
+                display.displayMIDIevent(Interface::Display::eventType_t::in, Interface::Display::event_t::sysRealTimeClock, lastClockBPM, 0, 0);
+        }
+#endif
+
 #ifdef DISPLAY_SUPPORTED
         display.update();
 #endif
@@ -178,7 +297,13 @@ void OpenDeck::checkMIDI()
         switch (messageType)
         {
         case MIDI::messageType_t::systemExclusive:
+            //respond on the same cable on which the request has been received
+            if (interface == MIDI::interface_t::usb)
+                configCable = MIDIScheduler::receivedUSBcable();
+
+            MIDIScheduler::setUSBcable(configCable);
             sysConfig.handleSysEx(midi.getSysExArray(interface), midi.getSysExArrayLength(interface));
+            MIDIScheduler::setUSBcable(MIDIScheduler::usbCable_t::performance);
             break;
 
         case MIDI::messageType_t::noteOn:
@@ -244,12 +369,16 @@ void OpenDeck::checkMIDI()
             break;
 
         case MIDI::messageType_t::sysRealTimeClock:
-#ifdef LEDS_SUPPORTED
-            leds.checkBlinking(true);
+            //blinking is driven by local clock locked to received messages
+#if defined(LEDS_SUPPORTED) || defined(DISPLAY_SUPPORTED)
+            midiClock.tick();
 #endif
             break;
 
         case MIDI::messageType_t::sysRealTimeStart:
+#if defined(LEDS_SUPPORTED) || defined(DISPLAY_SUPPORTED)
+            midiClock.start();
+#endif
 #ifdef LEDS_SUPPORTED
             leds.resetBlinking();
             leds.checkBlinking(true);
@@ -261,56 +390,118 @@ void OpenDeck::checkMIDI()
         }
     };
 
-    //note: mega/uno
-    //"fake" usb interface - din data is stored as usb data so use usb callback to read the usb
-    //packet stored in midi object
-    if (midi.read(MIDI::interface_t::usb))
-        processMessage(MIDI::interface_t::usb);
+#ifdef DIN_MIDI_SUPPORTED
+    bool dinEnabled   = sysConfig.isMIDIfeatureEnabled(SysConfig::midiFeature_t::dinEnabled);
+    bool mergeEnabled = sysConfig.isMIDIfeatureEnabled(SysConfig::midiFeature_t::mergeEnabled);
+    auto mergeType    = sysConfig.midiMergeType();
+
+    //incoming DIN data isn't read here in DIN to USB merge mode - don't wait for it
+    bool dinPending = dinEnabled && !(mergeEnabled && (mergeType == SysConfig::midiMergeType_t::DINtoUSB));
+#endif
+
+    auto isInputPending = [&]() {
+        if (MIDIScheduler::inputPending(MIDI::interface_t::usb))
+            return true;
 
 #ifdef DIN_MIDI_SUPPORTED
-    if (sysConfig.isMIDIfeatureEnabled(SysConfig::midiFeature_t::dinEnabled))
-    {
-        if (sysConfig.isMIDIfeatureEnabled(SysConfig::midiFeature_t::mergeEnabled))
-        {
-            auto mergeType = sysConfig.midiMergeType();
+        if (dinPending && MIDIScheduler::inputPending(MIDI::interface_t::din))
+            return true;
+#endif
 
-            switch (mergeType)
-            {
-            case SysConfig::midiMergeType_t::DINtoDIN:
-                //dump everything from DIN MIDI in to USB MIDI out
-                midi.read(MIDI::interface_t::din, MIDI::filterMode_t::fullUSB);
-                break;
+        return false;
+    };
 
-                // case midiMergeDINtoDIN:
-                //loopback is automatically configured here
-                // break;
+    uint32_t start = core::timing::currentRunTimeMs();
+    size_t   reads = 0;
 
-                // case midiMergeODmaster:
-                //already configured
-                // break;
+    inputCheckStart(MIDI::interface_t::usb, usbInput);
+#ifdef DIN_MIDI_SUPPORTED
+    if (dinEnabled)
+        inputCheckStart(MIDI::interface_t::din, dinInput);
+#endif
 
-            case SysConfig::midiMergeType_t::odSlaveInitial:
-                //handle the traffic regulary until slave is properly configured
-                //(upon receiving message from master)
+    //process everything which is pending instead of single message per main loop pass
+    //stop once the budget is used so that components are still checked regularly
+    do
+    {
+        //note: mega/uno
+        //"fake" usb interface - din data is stored as usb data so use usb callback to read the usb
+        //packet stored in midi object
+        if (midi.read(MIDI::interface_t::usb))
+        {
+            //traffic on daisy-chain cable is meant for other boards only
+            if (!MIDIScheduler::isDaisyChainCable(MIDIScheduler::receivedUSBcable()))
+                processMessage(MIDI::interface_t::usb);
+        }
+
+#ifdef DIN_MIDI_SUPPORTED
+        if (dinEnabled)
+        {
+            if (mergeEnabled)
+            {
+                switch (mergeType)
+                {
+                case SysConfig::midiMergeType_t::DINtoDIN:
+                    //dump everything from DIN MIDI in to USB MIDI out
+                    midi.read(MIDI::interface_t::din, MIDI::filterMode_t::fullUSB);
+                    break;
+
+                    // case midiMergeDINtoDIN:
+                    //loopback is automatically configured here
+                    // break;
+
+                    // case midiMergeODmaster:
+                    //already configured
+                    // break;
+
+                case SysConfig::midiMergeType_t::odSlaveInitial:
+                    //handle the traffic regulary until slave is properly configured
+                    //(upon receiving message from master)
+                    if (midi.read(MIDI::interface_t::din))
+                        processMessage(MIDI::interface_t::din);
+                    break;
+
+                default:
+                    break;
+                }
+            }
+            else
+            {
                 if (midi.read(MIDI::interface_t::din))
                     processMessage(MIDI::interface_t::din);
-                break;
-
-            default:
-                break;
             }
         }
-        else
-        {
-            if (midi.read(MIDI::interface_t::din))
-                processMessage(MIDI::interface_t::din);
-        }
-    }
 #endif
+    } while ((++reads < MIDI_INPUT_BUDGET_READS) && ((core::timing::currentRunTimeMs() - start) < MIDI_INPUT_BUDGET_TIME) && isInputPending());
+
+    uint32_t now = core::timing::currentRunTimeMs();
+
+    inputCheckEnd(MIDI::interface_t::usb, usbInput, now);
+#ifdef DIN_MIDI_SUPPORTED
+    if (dinEnabled)
+        inputCheckEnd(MIDI::interface_t::din, dinInput, now);
+#endif
+
+    lastInputCheck = now;
 }
 
 void OpenDeck::update()
 {
+#ifdef USB_MIDI_SUPPORTED
+    //host doesn't know about previously selected NRPN parameters after reconnect
+    if (Board::USB::isConfigured() != usbConfigured)
+    {
+        usbConfigured = !usbConfigured;
+
+        if (usbConfigured)
+            midiOutput.resetNRPNselection(MIDI::interface_t::usb);
+    }
+#endif
+
     checkMIDI();
     checkComponents();
+    midiOutput.update();
+
+    //send everything written to USB during this pass at once
+    MIDIScheduler::flush();
 }
\ No newline at end of file
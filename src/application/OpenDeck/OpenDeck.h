@@ -36,6 +36,22 @@ limitations under the License.
 #endif
 #include "midi/src/MIDI.h"
 
+///
+/// \brief Maximum number of read passes over all MIDI interfaces in single call of checkMIDI.
+/// Can be overriden in board definition.
+///
+#ifndef MIDI_INPUT_BUDGET_READS
+#define MIDI_INPUT_BUDGET_READS 32
+#endif
+
+///
+/// \brief Maximum time in milliseconds spent in single call of checkMIDI.
+/// Checked only after each read pass. Can be overriden in board definition.
+///
+#ifndef MIDI_INPUT_BUDGET_TIME
+#define MIDI_INPUT_BUDGET_TIME 2
+#endif
+
 class OpenDeck
 {
     public:
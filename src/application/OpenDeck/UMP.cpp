@@ -0,0 +1,486 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "UMP.h"
+
+namespace
+{
+    ///
+    /// \brief List of UMP message types used by the device.
+    ///
+    enum messageType_t : uint8_t
+    {
+        systemCommon = 0x01,
+        midi1Voice   = 0x02,
+        sysEx7       = 0x03,
+        midi2Voice   = 0x04,
+    };
+
+    ///
+    /// \brief List of statuses of UMP system exclusive message.
+    ///
+    enum sysExStatus_t : uint8_t
+    {
+        sysExComplete = 0x00,
+        sysExStart    = 0x01,
+        sysExContinue = 0x02,
+        sysExEnd      = 0x03,
+    };
+
+    uint32_t umpHeader(uint8_t type, uint8_t group)
+    {
+        return (static_cast<uint32_t>(type) << 28) | (static_cast<uint32_t>(group & 0x0F) << 24);
+    }
+
+    void setPacket(MIDI::USBMIDIpacket_t& packet, uint8_t group, uint8_t cin, uint8_t data1, uint8_t data2, uint8_t data3)
+    {
+        packet.Event = (group << 4) | cin;
+        packet.Data1 = data1;
+        packet.Data2 = data2;
+        packet.Data3 = data3;
+    }
+}    // namespace
+
+///
+/// \brief Returns total number of 32-bit words in UMP message based on its first word.
+///
+uint8_t UMP::messageWords(uint32_t word)
+{
+    switch (word >> 28)
+    {
+    case 0x03:
+    case 0x04:
+    case 0x08:
+    case 0x09:
+    case 0x0A:
+        return 2;
+
+    case 0x0B:
+    case 0x0C:
+        return 3;
+
+    case 0x05:
+    case 0x0D:
+    case 0x0E:
+    case 0x0F:
+        return 4;
+
+    default:
+        return 1;
+    }
+}
+
+///
+/// \brief Converts value to higher resolution using min-center-max scaling defined in MIDI 2.0 specification.
+/// Minimum, center and maximum values of the source range are converted to minimum, center and maximum
+/// values of the destination range.
+///
+uint32_t UMP::scaleUp(uint32_t value, uint8_t srcBits, uint8_t dstBits)
+{
+    uint8_t  scaleBits = dstBits - srcBits;
+    uint32_t scaled    = value << scaleBits;
+    uint32_t center    = static_cast<uint32_t>(1) << (srcBits - 1);
+
+    if (value <= center)
+        return scaled;
+
+    //fill the lower bits by repeating the bits below the highest source bit
+    uint8_t  repeatBits  = srcBits - 1;
+    uint32_t repeatValue = value & ((static_cast<uint32_t>(1) << repeatBits) - 1);
+
+    if (scaleBits > repeatBits)
+        repeatValue <<= scaleBits - repeatBits;
+    else
+        repeatValue >>= repeatBits - scaleBits;
+
+    while (repeatValue)
+    {
+        scaled |= repeatValue;
+        repeatValue >>= repeatBits;
+    }
+
+    return scaled;
+}
+
+///
+/// \brief Converts value to lower resolution.
+///
+uint32_t UMP::scaleDown(uint32_t value, uint8_t srcBits, uint8_t dstBits)
+{
+    return value >> (srcBits - dstBits);
+}
+
+///
+/// \brief Creates MIDI 2.0 channel voice message.
+/// @param [in] group   UMP group.
+/// @param [in] opcode  Message opcode.
+/// @param [in] channel MIDI channel (0-15).
+/// @param [in] index   Two bytes following the channel, ie. note number and attribute type for notes or
+///                     bank and index for registered and assignable controllers.
+/// @param [in] value   Data word of the message.
+/// @param [in,out] words   Array in which the message is stored.
+/// \returns Number of words in the message.
+///
+uint8_t UMP::channelVoice(uint8_t group, opcode_t opcode, uint8_t channel, uint16_t index, uint32_t value, uint32_t* words)
+{
+    words[0] = umpHeader(midi2Voice, group) |
+               (static_cast<uint32_t>(opcode) << 20) |
+               (static_cast<uint32_t>(channel & 0x0F) << 16) |
+               index;
+    words[1] = value;
+
+    return 2;
+}
+
+///
+/// \brief Converts USB MIDI packet to UMP message.
+/// Each system exclusive packet is converted to separate UMP message holding up to three bytes.
+/// @param [in] packet      USB MIDI packet to convert.
+/// @param [in,out] words   Array in which the message is stored. Must hold at least UMP_MAX_WORDS words.
+/// \returns Number of words in the message, 0 if the packet can't be converted.
+///
+uint8_t UMP::fromUSBMIDI(const MIDI::USBMIDIpacket_t& packet, uint32_t* words)
+{
+    uint8_t group = packet.Event >> 4;
+    uint8_t cin   = packet.Event & 0x0F;
+
+    switch (cin)
+    {
+    case 0x08:
+    case 0x09:
+    case 0x0A:
+    case 0x0B:
+    case 0x0C:
+    case 0x0D:
+    case 0x0E:
+    {
+        auto    opcode  = static_cast<opcode_t>(packet.Data1 >> 4);
+        uint8_t channel = packet.Data1 & 0x0F;
+
+        switch (opcode)
+        {
+        case opcode_t::noteOn:
+        case opcode_t::noteOff:
+        {
+            //note on with velocity 0 is note off in MIDI 1.0 only
+            if (!packet.Data3)
+                opcode = opcode_t::noteOff;
+
+            return channelVoice(group, opcode, channel, packet.Data2 << 8, scaleUp(packet.Data3, 7, 16) << 16, words);
+        }
+
+        case opcode_t::polyPressure:
+        case opcode_t::controlChange:
+            return channelVoice(group, opcode, channel, packet.Data2 << 8, scaleUp(packet.Data3, 7, 32), words);
+
+        case opcode_t::programChange:
+            return channelVoice(group, opcode, channel, 0, static_cast<uint32_t>(packet.Data2) << 24, words);
+
+        case opcode_t::channelPressure:
+            return channelVoice(group, opcode, channel, 0, scaleUp(packet.Data2, 7, 32), words);
+
+        case opcode_t::pitchBend:
+            return channelVoice(group, opcode, channel, 0, scaleUp(packet.Data2 | (packet.Data3 << 7), 14, 32), words);
+
+        default:
+            return 0;
+        }
+    }
+
+    case 0x02:
+    case 0x03:
+    case 0x05:
+    case 0x0F:
+    {
+        //single byte system exclusive end uses the same code index number as single byte system common message
+        if ((cin != 0x05) || (packet.Data1 != 0xF7))
+        {
+            if (packet.Data1 < 0xF1)
+                return 0;
+
+            words[0] = umpHeader(systemCommon, group) |
+                       (static_cast<uint32_t>(packet.Data1) << 16) |
+                       (static_cast<uint32_t>(packet.Data2) << 8) |
+                       packet.Data3;
+
+            return 1;
+        }
+    }
+
+        //fall through
+
+    case 0x04:
+    case 0x06:
+    case 0x07:
+    {
+        uint8_t length   = (cin == 0x04) ? 3 : (cin - 0x04);
+        uint8_t data[6]  = {};
+        uint8_t count    = 0;
+        bool    start    = false;
+        bool    end      = false;
+        uint8_t bytes[3] = { packet.Data1, packet.Data2, packet.Data3 };
+
+        for (int i = 0; i < length; i++)
+        {
+            if (bytes[i] == 0xF0)
+                start = true;
+            else if (bytes[i] == 0xF7)
+                end = true;
+            else
+                data[count++] = bytes[i];
+        }
+
+        uint8_t status = start ? (end ? sysExComplete : sysExStart) : (end ? sysExEnd : sysExContinue);
+
+        words[0] = umpHeader(sysEx7, group) |
+                   (static_cast<uint32_t>(status) << 20) |
+                   (static_cast<uint32_t>(count) << 16) |
+                   (static_cast<uint32_t>(data[0]) << 8) |
+                   data[1];
+        words[1] = static_cast<uint32_t>(data[2]) << 24;
+
+        return 2;
+    }
+
+    default:
+        return 0;
+    }
+}
+
+///
+/// \brief Converts UMP message received from host to USB MIDI packets.
+/// MIDI 2.0 channel voice messages are converted to MIDI 1.0 messages with reduced resolution.
+/// Messages without MIDI 1.0 equivalent are ignored.
+/// @param [in] words           Complete UMP message.
+/// @param [in,out] packets     Array in which converted packets are stored. Must hold at least UMP_MAX_USB_PACKETS packets.
+/// \returns Number of converted packets.
+///
+uint8_t UMP::toUSBMIDI(const uint32_t* words, MIDI::USBMIDIpacket_t* packets)
+{
+    uint8_t type   = words[0] >> 28;
+    uint8_t group  = (words[0] >> 24) & 0x0F;
+    uint8_t status = (words[0] >> 16) & 0xFF;
+    uint8_t data1  = (words[0] >> 8) & 0x7F;
+    uint8_t data2  = words[0] & 0x7F;
+
+    switch (type)
+    {
+    case systemCommon:
+    {
+        switch (status)
+        {
+        case 0xF2:
+        {
+            setPacket(packets[0], group, 0x03, status, data1, data2);
+        }
+        break;
+
+        case 0xF1:
+        case 0xF3:
+        {
+            setPacket(packets[0], group, 0x02, status, data1, 0);
+        }
+        break;
+
+        case 0xF6:
+        {
+            setPacket(packets[0], group, 0x05, status, 0, 0);
+        }
+        break;
+
+        default:
+        {
+            if (status < 0xF8)
+                return 0;
+
+            setPacket(packets[0], group, 0x0F, status, 0, 0);
+        }
+        break;
+        }
+
+        return 1;
+    }
+
+    case midi1Voice:
+    {
+        if ((status < 0x80) || (status >= 0xF0))
+            return 0;
+
+        setPacket(packets[0], group, status >> 4, status, data1, data2);
+        return 1;
+    }
+
+    case midi2Voice:
+    {
+        auto    opcode  = static_cast<opcode_t>(status >> 4);
+        uint8_t channel = status & 0x0F;
+        uint8_t value7  = scaleDown(words[1], 32, 7);
+        uint8_t cin     = static_cast<uint8_t>(opcode);
+
+        switch (opcode)
+        {
+        case opcode_t::noteOff:
+        case opcode_t::noteOn:
+        {
+            uint8_t velocity = scaleDown(words[1] >> 16, 16, 7);
+
+            //velocity 0 would be interpreted as note off
+            if ((opcode == opcode_t::noteOn) && !velocity)
+                velocity = 1;
+
+            setPacket(packets[0], group, cin, status, data1, velocity);
+            return 1;
+        }
+
+        case opcode_t::polyPressure:
+        case opcode_t::controlChange:
+        {
+            setPacket(packets[0], group, cin, status, data1, value7);
+            return 1;
+        }
+
+        case opcode_t::programChange:
+        {
+            uint8_t count = 0;
+
+            //bank is valid only if the lowest option flag is set
+            if (words[0] & 0x01)
+            {
+                setPacket(packets[count++], group, 0x0B, 0xB0 | channel, 0, (words[1] >> 8) & 0x7F);
+                setPacket(packets[count++], group, 0x0B, 0xB0 | channel, 32, words[1] & 0x7F);
+            }
+
+            setPacket(packets[count++], group, cin, status, (words[1] >> 24) & 0x7F, 0);
+            return count;
+        }
+
+        case opcode_t::channelPressure:
+        {
+            setPacket(packets[0], group, cin, status, value7, 0);
+            return 1;
+        }
+
+        case opcode_t::pitchBend:
+        {
+            uint16_t value14 = scaleDown(words[1], 32, 14);
+
+            setPacket(packets[0], group, cin, status, value14 & 0x7F, value14 >> 7);
+            return 1;
+        }
+
+        case opcode_t::registeredController:
+        case opcode_t::assignableController:
+        {
+            uint16_t value14     = scaleDown(words[1], 32, 14);
+            uint8_t  controlBase = (opcode == opcode_t::registeredController) ? 101 : 99;
+            uint8_t  ccStatus    = 0xB0 | channel;
+
+            setPacket(packets[0], group, 0x0B, ccStatus, controlBase, data1);
+            setPacket(packets[1], group, 0x0B, ccStatus, controlBase - 1, data2);
+            setPacket(packets[2], group, 0x0B, ccStatus, 6, value14 >> 7);
+            setPacket(packets[3], group, 0x0B, ccStatus, 38, value14 & 0x7F);
+            return 4;
+        }
+
+        default:
+            return 0;
+        }
+    }
+
+    case sysEx7:
+    {
+        uint8_t sysExStatus = status >> 4;
+        uint8_t length      = status & 0x0F;
+        uint8_t bytes[sizeof(sysExCarry) + 8];
+        uint8_t count = 0;
+
+        if (length > 6)
+            return 0;
+
+        if ((sysExStatus == sysExComplete) || (sysExStatus == sysExStart))
+        {
+            //new message discards any unfinished one
+            sysExCarryLength = 0;
+            bytes[count++]   = 0xF0;
+        }
+        else
+        {
+            for (int i = 0; i < sysExCarryLength; i++)
+                bytes[count++] = sysExCarry[i];
+        }
+
+        for (int i = 0; i < length; i++)
+        {
+            //data bytes start at second byte of first word
+            uint8_t word  = (i + 2) / 4;
+            uint8_t shift = (3 - ((i + 2) % 4)) * 8;
+
+            bytes[count++] = (words[word] >> shift) & 0x7F;
+        }
+
+        bool end = (sysExStatus == sysExComplete) || (sysExStatus == sysExEnd);
+
+        if (end)
+            bytes[count++] = 0xF7;
+
+        uint8_t packetCount = 0;
+        uint8_t index       = 0;
+
+        //packets which don't end the message must be full
+        while (((count - index) > 3) || (!end && ((count - index) == 3)))
+        {
+            setPacket(packets[packetCount++], group, 0x04, bytes[index], bytes[index + 1], bytes[index + 2]);
+            index += 3;
+        }
+
+        if (end)
+        {
+            uint8_t remaining = count - index;
+
+            setPacket(packets[packetCount++],
+                      group,
+                      0x04 + remaining,
+                      bytes[index],
+                      (remaining > 1) ? bytes[index + 1] : 0,
+                      (remaining > 2) ? bytes[index + 2] : 0);
+
+            sysExCarryLength = 0;
+        }
+        else
+        {
+            sysExCarryLength = count - index;
+
+            for (int i = 0; i < sysExCarryLength; i++)
+                sysExCarry[i] = bytes[index + i];
+        }
+
+        return packetCount;
+    }
+
+    default:
+        return 0;
+    }
+}
+
+///
+/// \brief Discards unfinished system exclusive message received from host.
+///
+void UMP::reset()
+{
+    sysExCarryLength = 0;
+}
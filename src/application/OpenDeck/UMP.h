@@ -0,0 +1,73 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include "midi/src/MIDI.h"
+
+///
+/// \brief Largest number of 32-bit words in single Universal MIDI Packet.
+///
+#define UMP_MAX_WORDS 4
+
+///
+/// \brief Largest number of USB MIDI packets produced from single Universal MIDI Packet.
+///
+#define UMP_MAX_USB_PACKETS 4
+
+///
+/// \brief Translates between USB MIDI 1.0 event packets and Universal MIDI Packets (UMP).
+/// Channel voice messages are sent to host as MIDI 2.0 channel voice messages with values
+/// upscaled to full resolution. Cable number of USB MIDI packet is used as UMP group.
+///
+class UMP
+{
+    public:
+    UMP() {}
+
+    ///
+    /// \brief List of MIDI 2.0 channel voice message opcodes.
+    ///
+    enum class opcode_t : uint8_t
+    {
+        registeredController = 0x02,
+        assignableController = 0x03,
+        noteOff              = 0x08,
+        noteOn               = 0x09,
+        polyPressure         = 0x0A,
+        controlChange        = 0x0B,
+        programChange        = 0x0C,
+        channelPressure      = 0x0D,
+        pitchBend            = 0x0E,
+    };
+
+    static uint8_t  messageWords(uint32_t word);
+    static uint32_t scaleUp(uint32_t value, uint8_t srcBits, uint8_t dstBits);
+    static uint32_t scaleDown(uint32_t value, uint8_t srcBits, uint8_t dstBits);
+    static uint8_t  channelVoice(uint8_t group, opcode_t opcode, uint8_t channel, uint16_t index, uint32_t value, uint32_t* words);
+    static uint8_t  fromUSBMIDI(const MIDI::USBMIDIpacket_t& packet, uint32_t* words);
+    uint8_t         toUSBMIDI(const uint32_t* words, MIDI::USBMIDIpacket_t* packets);
+    void            reset();
+
+    private:
+    ///
+    /// \brief System exclusive bytes received from host which don't fill the whole USB MIDI packet yet.
+    ///
+    uint8_t sysExCarry[2]    = {};
+    uint8_t sysExCarryLength = 0;
+};
@@ -33,19 +33,28 @@ limitations under the License.
 #define SYSEX_CR_DISABLE_PROCESSING        0x64
 #define SYSEX_CR_DAISY_CHAIN               0x6D
 #define SYSEX_CR_SUPPORTED_PRESETS         0x50
+#define SYSEX_CR_MIDI_INPUT_STATS          0x69
+#define SYSEX_CR_LINK_STATS                0x6C
 
 /// @}
 
 ///
 /// \brief Total number of custom requests.
 ///
-#define NUMBER_OF_CUSTOM_REQUESTS 11
+#define NUMBER_OF_CUSTOM_REQUESTS 13
 
 ///
 /// \brief Custom ID used when sending info about components to host.
 ///
 #define SYSEX_CM_COMPONENT_ID 0x49
 
+///
+/// \brief Custom ID used by host to set the state of multiple LEDs in single message.
+/// Message is sent in request format with this ID in place of wish, followed by
+/// the index of the first LED as two 7-bit bytes and one state byte per LED.
+///
+#define SYSEX_CM_LED_STATE 0x4C
+
 ///
 /// \brief Minimum time difference in milliseconds between sending two identical component info messages.
 ///
@@ -1,4 +1,5 @@
 #include "SysConfig.h"
+#include "OpenDeck/MIDIScheduler.h"
 
 SysConfig::result_t SysConfig::SysExDataHandler::get(uint8_t block, uint8_t section, size_t index, SysExConf::sysExParameter_t& value)
 {
@@ -62,12 +63,26 @@ SysConfig::result_t SysConfig::onGetGlobal(Section::global_t section, size_t ind
     switch (section)
     {
     case Section::global_t::midiFeature:
-    case Section::global_t::midiMerge:
     {
         result = database.read(dbSection(section), index, readValue) ? SysConfig::result_t::ok : SysConfig::result_t::error;
     }
     break;
 
+    case Section::global_t::midiMerge:
+    {
+        //target of daisy-chain cable isn't stored in database
+        if (static_cast<midiMerge_t>(index) == midiMerge_t::daisyChainTarget)
+        {
+            readValue = MIDIScheduler::daisyChainTarget();
+            result    = SysConfig::result_t::ok;
+        }
+        else
+        {
+            result = database.read(dbSection(section), index, readValue) ? SysConfig::result_t::ok : SysConfig::result_t::error;
+        }
+    }
+    break;
+
     case Section::global_t::presets:
     {
         auto setting = static_cast<presetSetting_t>(index);
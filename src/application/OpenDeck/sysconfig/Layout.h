@@ -221,6 +221,41 @@ namespace
             .numberOfParameters = MAX_NUMBER_OF_ANALOG,
             .newValueMin        = 1,
             .newValueMax        = 16,
+        },
+
+        //response curve section
+        {
+            .numberOfParameters = MAX_NUMBER_OF_ANALOG,
+            .newValueMin        = 0,
+            .newValueMax        = static_cast<SysExConf::sysExParameter_t>(Interface::analog::Analog::curve_t::AMOUNT) - 1,
+        },
+
+        //user curve points section
+        {
+            .numberOfParameters = ANALOG_CURVE_POINTS,
+            .newValueMin        = 0,
+            .newValueMax        = 127,
+        },
+
+        //aftertouch type section
+        {
+            .numberOfParameters = MAX_NUMBER_OF_ANALOG,
+            .newValueMin        = 0,
+            .newValueMax        = static_cast<SysExConf::sysExParameter_t>(Interface::analog::Analog::aftertouchType_t::AMOUNT) - 1,
+        },
+
+        //peak window section
+        {
+            .numberOfParameters = MAX_NUMBER_OF_ANALOG,
+            .newValueMin        = 0,
+            .newValueMax        = FSR_PEAK_WINDOW_MAX,
+        },
+
+        //piezo setting section
+        {
+            .numberOfParameters = static_cast<uint8_t>(Interface::analog::Analog::piezoSetting_t::AMOUNT),
+            .newValueMin        = 0,
+            .newValueMax        = 0,
         }
     };
 
@@ -391,5 +426,15 @@ namespace
             .requestID     = SYSEX_CR_SUPPORTED_PRESETS,
             .connOpenCheck = true,
         },
+
+        {
+            .requestID     = SYSEX_CR_MIDI_INPUT_STATS,
+            .connOpenCheck = true,
+        },
+
+        {
+            .requestID     = SYSEX_CR_LINK_STATS,
+            .connOpenCheck = true,
+        },
     };
 }    // namespace
\ No newline at end of file
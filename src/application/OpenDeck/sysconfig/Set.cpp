@@ -1,4 +1,6 @@
 #include "SysConfig.h"
+#include "OpenDeck/MIDIScheduler.h"
+#include "common/OpenDeckMIDIformat/OpenDeckMIDIformat.h"
 
 SysExConf::DataHandler::result_t SysConfig::SysExDataHandler::set(uint8_t                     block,
                                                                   uint8_t                     section,
@@ -189,6 +191,24 @@ SysConfig::result_t SysConfig::onSetGlobal(Section::global_t section, size_t ind
         }
         break;
 
+        case midiMerge_t::daisyChainTarget:
+        {
+            //selects the board which receives the traffic sent by host on daisy-chain cable
+            //not stored - after restart, the traffic is sent to all the boards again
+            writeToDb = false;
+
+            if ((newValue >= 0) && (newValue <= OPENDECK_MIDI_FORMAT_MAX_NODES))
+            {
+                MIDIScheduler::setDaisyChainTarget(newValue);
+                result = SysConfig::result_t::ok;
+            }
+            else
+            {
+                result = SysConfig::result_t::notSupported;
+            }
+        }
+        break;
+
         default:
             break;
         }
@@ -316,13 +336,60 @@ SysConfig::result_t SysConfig::onSetAnalog(Section::analog_t section, size_t ind
 
         encDec_14bit.mergeTo14bit();
         result = database.update(dbSection(section), index, encDec_14bit.value) ? SysConfig::result_t::ok : SysConfig::result_t::error;
+
+        //limits are applied only after the reset
+        if ((section != Section::analog_t::midiID) && (section != Section::analog_t::midiID_MSB))
+            analog.debounceReset(index);
     }
     break;
 
+    case Section::analog_t::enable:
     case Section::analog_t::type:
+    case Section::analog_t::invert:
+    case Section::analog_t::curve:
+    case Section::analog_t::aftertouchType:
     {
+        result = database.update(dbSection(section), index, newValue) ? SysConfig::result_t::ok : SysConfig::result_t::error;
         analog.debounceReset(index);
+    }
+    break;
+
+    case Section::analog_t::userCurve:
+    {
         result = database.update(dbSection(section), index, newValue) ? SysConfig::result_t::ok : SysConfig::result_t::error;
+
+        //user curve is shared between all analog components
+        analog.init();
+    }
+    break;
+
+    case Section::analog_t::piezoSetting:
+    {
+        auto setting = static_cast<Interface::analog::Analog::piezoSetting_t>(index);
+        bool valid   = false;
+
+        switch (setting)
+        {
+        case Interface::analog::Analog::piezoSetting_t::maskTime:
+        {
+            valid = (newValue >= 0) && (newValue <= PIEZO_MASK_TIME_MAX);
+        }
+        break;
+
+        case Interface::analog::Analog::piezoSetting_t::crosstalk:
+        {
+            valid = (newValue >= 0) && (newValue <= MIDI_7_BIT_VALUE_MAX);
+        }
+        break;
+
+        default:
+            break;
+        }
+
+        if (valid)
+            result = database.update(dbSection(section), index, newValue) ? SysConfig::result_t::ok : SysConfig::result_t::error;
+        else
+            result = SysConfig::result_t::notSupported;
     }
     break;
 
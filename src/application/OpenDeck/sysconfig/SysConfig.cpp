@@ -21,6 +21,7 @@ limitations under the License.
 #include "Layout.h"
 #include "core/src/general/Timing.h"
 #include "common/OpenDeckMIDIformat/OpenDeckMIDIformat.h"
+#include "OpenDeck/MIDIScheduler.h"
 #include "board/Board.h"
 
 Database::block_t SysConfig::dbBlock(uint8_t index)
@@ -86,6 +87,33 @@ Database::Section::display_t SysConfig::dbSection(Section::display_t section)
 
 void SysConfig::handleSysEx(const uint8_t* array, size_t size)
 {
+#ifdef LEDS_SUPPORTED
+    //bulk led state is handled here directly since custom requests can't carry any data
+    //configuration doesn't need to be enabled for this message, the same as for note/cc led control
+    //F0 + manufacturer ID + status + part + custom ID + first led (2 bytes) + at least one state + F7
+    if ((size >= 10) &&
+        (array[1] == SYSEX_MANUFACTURER_ID_0) &&
+        (array[2] == SYSEX_MANUFACTURER_ID_1) &&
+        (array[3] == SYSEX_MANUFACTURER_ID_2) &&
+        (array[4] == static_cast<uint8_t>(SysExConf::status_t::request)) &&
+        (array[5] == 0x00) &&
+        (array[6] == SYSEX_CM_LED_STATE))
+    {
+        //truncated message - don't treat the last received byte as led state
+        if (array[size - 1] != 0xF7)
+            return;
+
+        MIDI::encDec_14bit_t encDec_14bit;
+
+        encDec_14bit.high = array[7];
+        encDec_14bit.low  = array[8];
+        encDec_14bit.mergeTo14bit();
+
+        leds.setStates(encDec_14bit.value, &array[9], size - 10);
+        return;
+    }
+#endif
+
     sysExConf.handleMessage(array, size);
 }
 
@@ -166,6 +194,77 @@ SysConfig::result_t SysConfig::SysExDataHandler::customRequest(size_t request, C
     }
     break;
 
+    case SYSEX_CR_MIDI_INPUT_STATS:
+    {
+        //report the largest queue depth and waiting time since the last request
+        //values are saturated to fit in single 7-bit parameter
+        auto appendStats = [&customResponse](MIDI::interface_t interface) {
+            auto& stats = MIDIScheduler::inputStats(interface);
+
+            customResponse.append(stats.maxDepth > 0x7F ? 0x7F : stats.maxDepth);
+            customResponse.append(stats.maxAge > 0x7F ? 0x7F : stats.maxAge);
+
+            stats.maxDepth = 0;
+            stats.maxAge   = 0;
+        };
+
+        appendStats(MIDI::interface_t::usb);
+#ifdef DIN_MIDI_SUPPORTED
+        appendStats(MIDI::interface_t::din);
+#endif
+    }
+    break;
+
+    case SYSEX_CR_LINK_STATS:
+    {
+        //report the counters collected on the channels using OpenDeck format since the last request
+        //counters are saturated to fit in two 7-bit parameters
+        //ping and hop times are in microseconds and use three 7-bit parameters instead
+        auto appendStats = [&customResponse](uint8_t channel) {
+            OpenDeckMIDIformat::stats_t stats;
+            MIDI::encDec_14bit_t        encDec_14bit;
+
+            OpenDeckMIDIformat::stats(channel, stats);
+
+            auto append14bit = [&customResponse, &encDec_14bit](uint32_t value) {
+                encDec_14bit.value = value > 0x3FFF ? 0x3FFF : value;
+                encDec_14bit.split14bit();
+
+                customResponse.append(encDec_14bit.high);
+                customResponse.append(encDec_14bit.low);
+            };
+
+            auto append21bit = [&customResponse](uint32_t value) {
+                if (value > 0x1FFFFF)
+                    value = 0x1FFFFF;
+
+                customResponse.append((value >> 14) & 0x7F);
+                customResponse.append((value >> 7) & 0x7F);
+                customResponse.append(value & 0x7F);
+            };
+
+            append14bit(stats.framesSent);
+            append14bit(stats.framesReceived);
+            append14bit(stats.crcErrors);
+            append14bit(stats.resyncs);
+            append14bit(stats.rxOverflows);
+            append14bit(stats.pingsLost);
+            append21bit(stats.pingTime);
+            customResponse.append(stats.pingHops);
+            append21bit(stats.hopTime);
+
+            OpenDeckMIDIformat::resetStats(channel);
+        };
+
+#ifndef USB_MIDI_SUPPORTED
+        appendStats(UART_USB_LINK_CHANNEL);
+#endif
+#ifdef DIN_MIDI_SUPPORTED
+        appendStats(UART_MIDI_CHANNEL);
+#endif
+    }
+    break;
+
 #ifdef DIN_MIDI_SUPPORTED
     case SYSEX_CR_DAISY_CHAIN:
     {
@@ -244,9 +343,8 @@ void SysConfig::setupMIDIoverUART(uint32_t baudRate, bool initRX, bool initTX)
 
     if (initTX)
     {
-        midi.handleUARTwrite([](uint8_t data) {
-            return Board::UART::write(UART_MIDI_CHANNEL, data);
-        });
+        MIDIScheduler::resetDIN();
+        midi.handleUARTwrite(MIDIScheduler::writeDIN);
     }
     else
     {
@@ -257,29 +355,14 @@ void SysConfig::setupMIDIoverUART(uint32_t baudRate, bool initRX, bool initTX)
 
 void SysConfig::setupMIDIoverUSB()
 {
-#ifdef USB_MIDI_SUPPORTED
-    midi.handleUSBread(Board::USB::readMIDI);
-    midi.handleUSBwrite(Board::USB::writeMIDI);
-#else
+#ifndef USB_MIDI_SUPPORTED
     //enable uart-to-usb link when usb isn't supported directly
     Board::UART::init(UART_USB_LINK_CHANNEL, UART_BAUDRATE_MIDI_OD);
-
-    midi.handleUSBread([](MIDI::USBMIDIpacket_t& USBMIDIpacket) {
-        OpenDeckMIDIformat::packetType_t odPacketType;
-
-        if (OpenDeckMIDIformat::read(UART_USB_LINK_CHANNEL, USBMIDIpacket, odPacketType))
-        {
-            if (odPacketType == OpenDeckMIDIformat::packetType_t::midi)
-                return true;
-        }
-
-        return false;
-    });
-
-    midi.handleUSBwrite([](MIDI::USBMIDIpacket_t& USBMIDIpacket) {
-        return OpenDeckMIDIformat::write(UART_USB_LINK_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midi);
-    });
+    OpenDeckMIDIformat::negotiateBaudRate(UART_USB_LINK_CHANNEL);
 #endif
+
+    midi.handleUSBread(MIDIScheduler::readUSB);
+    midi.handleUSBwrite(MIDIScheduler::writeUSB);
 }
 
 bool SysConfig::sendCInfo(Database::block_t dbBlock, SysExConf::sysExParameter_t componentID)
@@ -356,49 +439,41 @@ void SysConfig::configureMIDImerge(midiMergeType_t mergeType)
         Board::UART::init(UART_MIDI_CHANNEL, UART_BAUDRATE_MIDI_OD);
         //before enabling master configuration, send slave request to other boards
         sendDaisyChainRequest();
+        //slaves take part in negotiation once they're configured
+        OpenDeckMIDIformat::negotiateBaudRate(UART_MIDI_CHANNEL);
 
         midi.handleUSBread([](MIDI::USBMIDIpacket_t& USBMIDIpacket) {
-            //dump everything from MIDI in to USB MIDI out
-            MIDI::USBMIDIpacket_t            slavePacket;
-            OpenDeckMIDIformat::packetType_t packetType;
-
             //use this function to forward all incoming data from other boards to usb
-            if (OpenDeckMIDIformat::read(UART_MIDI_CHANNEL, slavePacket, packetType))
-            {
+            OpenDeckMIDIformat::readAll(UART_MIDI_CHANNEL, [](MIDI::USBMIDIpacket_t& slavePacket, OpenDeckMIDIformat::packetType_t packetType) {
+                //host can tell traffic from slaves apart by the cable
+                //slaves put their address in the cable number
                 if (packetType == OpenDeckMIDIformat::packetType_t::midi)
-                {
-#ifdef USB_MIDI_SUPPORTED
-                    Board::USB::writeMIDI(slavePacket);
-#else
-                    OpenDeckMIDIformat::write(UART_USB_LINK_CHANNEL, slavePacket, OpenDeckMIDIformat::packetType_t::midi);
-#endif
-                }
-            }
+                    MIDIScheduler::forwardUSB(slavePacket, MIDIScheduler::nodeCable(slavePacket.Event >> 4));
+            });
 
-//read usb midi data and forward it to uart in od format
-#ifdef USB_MIDI_SUPPORTED
-            if (Board::USB::readMIDI(USBMIDIpacket))
-            {
-                return OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midiDaisyChain);
-            }
-#else
-            if (OpenDeckMIDIformat::read(UART_USB_LINK_CHANNEL, USBMIDIpacket, packetType))
-            {
-                if (packetType == OpenDeckMIDIformat::packetType_t::midi)
-                    return OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midiDaisyChain);
-            }
-#endif
+            //read usb midi data and forward it to uart in od format
+            if (!MIDIScheduler::readUSB(USBMIDIpacket))
+                return false;
 
-            return false;
-        });
+            auto    cable = MIDIScheduler::receivedUSBcable();
+            uint8_t cin   = USBMIDIpacket.Event & 0x0F;
 
-#ifdef USB_MIDI_SUPPORTED
-        midi.handleUSBwrite(Board::USB::writeMIDI);
-#else
-        midi.handleUSBwrite([](MIDI::USBMIDIpacket_t& USBMIDIpacket) {
-            return OpenDeckMIDIformat::write(UART_USB_LINK_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midi);
+            //configuration is sent to other boards only on their own cables or on daisy-chain cable
+            //code index numbers 0x04-0x07 are used for system exclusive packets
+            if (cable == MIDIScheduler::usbCable_t::configuration)
+                return true;
+
+            if ((cable == MIDIScheduler::usbCable_t::performance) && (cin >= 0x04) && (cin <= 0x07))
+                return true;
+
+            //destination address is sent in the cable number
+            USBMIDIpacket.Event = (MIDIScheduler::cableNode(cable) << 4) | cin;
+
+            return OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midiDaisyChain);
         });
-#endif
+
+        midi.handleUSBwrite(MIDIScheduler::writeUSB);
+
         //unused
         midi.handleUARTread(nullptr);
         midi.handleUARTwrite(nullptr);
@@ -409,14 +484,34 @@ void SysConfig::configureMIDImerge(midiMergeType_t mergeType)
     {
         Board::UART::setLoopbackState(UART_MIDI_CHANNEL, false);
         Board::UART::init(UART_MIDI_CHANNEL, UART_BAUDRATE_MIDI_OD);
-        //forward all incoming messages to other boards
+        //baud rate is negotiated by master
+        OpenDeckMIDIformat::resetBaudRate(UART_MIDI_CHANNEL);
+        //forward all incoming messages which aren't meant only for this board to other boards
         midi.handleUSBread([](MIDI::USBMIDIpacket_t& USBMIDIpacket) {
             OpenDeckMIDIformat::packetType_t packetType;
+            uint8_t                          address = OpenDeckMIDIformat::address(UART_MIDI_CHANNEL);
 
-            if (OpenDeckMIDIformat::read(UART_MIDI_CHANNEL, USBMIDIpacket, packetType))
+            //pass on all the traffic which isn't processed here at once
+            while (OpenDeckMIDIformat::read(UART_MIDI_CHANNEL, USBMIDIpacket, packetType))
             {
-                if (packetType != OpenDeckMIDIformat::packetType_t::internalCommand)
-                    return OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, packetType);
+                if (packetType == OpenDeckMIDIformat::packetType_t::internalCommand)
+                    continue;
+
+                //traffic from other slaves is sent to master
+                if (packetType == OpenDeckMIDIformat::packetType_t::midi)
+                {
+                    OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, packetType);
+                    continue;
+                }
+
+                //traffic from master is sent either to all the boards or to single one
+                uint8_t destination = USBMIDIpacket.Event >> 4;
+
+                if (!destination || (destination != address))
+                    OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, packetType);
+
+                if (!destination || (destination == address))
+                    return true;
             }
 
             return false;
@@ -424,6 +519,8 @@ void SysConfig::configureMIDImerge(midiMergeType_t mergeType)
 
         //write data to uart (opendeck format)
         midi.handleUSBwrite([](MIDI::USBMIDIpacket_t& USBMIDIpacket) {
+            //master tells the boards apart by the address in cable number
+            USBMIDIpacket.Event = (OpenDeckMIDIformat::address(UART_MIDI_CHANNEL) << 4) | (USBMIDIpacket.Event & 0x0F);
             return OpenDeckMIDIformat::write(UART_MIDI_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midi);
         });
 
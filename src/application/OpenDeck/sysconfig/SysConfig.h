@@ -130,6 +130,11 @@ class SysConfig
             upperLimit,
             upperLimit_MSB,
             midiChannel,
+            curve,
+            userCurve,
+            aftertouchType,
+            peakWindow,
+            piezoSetting,
             AMOUNT
         };
 
@@ -175,6 +180,7 @@ class SysConfig
         mergeType,
         mergeUSBchannel,
         mergeDINchannel,
+        daisyChainTarget,
         AMOUNT
     };
 
@@ -305,7 +311,12 @@ class SysConfig
         Database::Section::analog_t::lowerLimit,
         Database::Section::analog_t::upperLimit,
         Database::Section::analog_t::upperLimit,
-        Database::Section::analog_t::midiChannel
+        Database::Section::analog_t::midiChannel,
+        Database::Section::analog_t::curve,
+        Database::Section::analog_t::userCurve,
+        Database::Section::analog_t::aftertouchType,
+        Database::Section::analog_t::peakWindow,
+        Database::Section::analog_t::piezoSetting
     };
 
     const Database::Section::leds_t sysEx2DB_leds[static_cast<uint8_t>(Section::leds_t::AMOUNT)] = {
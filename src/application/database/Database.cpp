@@ -143,6 +143,12 @@ uint8_t Database::getPreset()
 ///
 void Database::writeCustomValues()
 {
+    //default user curve is linear
+    for (int i = 0; i < ANALOG_CURVE_POINTS; i++)
+        update(Database::Section::analog_t::userCurve, i, (i * MIDI_7_BIT_VALUE_MAX) / ANALOG_CURVE_SEGMENTS);
+
+    update(Database::Section::analog_t::piezoSetting, static_cast<size_t>(Interface::analog::Analog::piezoSetting_t::maskTime), PIEZO_MASK_TIME_DEFAULT);
+
 #ifdef DISPLAY_SUPPORTED
     update(Database::Section::display_t::setting, static_cast<size_t>(Interface::Display::setting_t::MIDIeventTime), MIN_MESSAGE_RETENTION_TIME);
 #endif
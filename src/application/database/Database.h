@@ -87,6 +87,11 @@ class Database : public LESSDB
             lowerLimit,
             upperLimit,
             midiChannel,
+            curve,
+            userCurve,
+            aftertouchType,
+            peakWindow,
+            piezoSetting,
             AMOUNT
         };
 
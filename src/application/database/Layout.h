@@ -21,6 +21,7 @@ limitations under the License.
 #include "Database.h"
 #include "board/Board.h"
 #include "interface/digital/output/leds/LEDs.h"
+#include "interface/analog/Analog.h"
 #include "interface/display/Display.h"
 #include "OpenDeck/sysconfig/SysConfig.h"
 #include "interface/display/Config.h"
@@ -275,6 +276,56 @@ namespace
             .defaultValue           = 0,
             .autoIncrement          = false,
             .address                = 0,
+        },
+
+        //response curve section
+        {
+            .numberOfParameters     = MAX_NUMBER_OF_ANALOG,
+            .parameterType          = LESSDB::sectionParameterType_t::halfByte,
+            .preserveOnPartialReset = false,
+            .defaultValue           = 0,
+            .autoIncrement          = false,
+            .address                = 0,
+        },
+
+        //user curve points section
+        {
+            .numberOfParameters     = ANALOG_CURVE_POINTS,
+            .parameterType          = LESSDB::sectionParameterType_t::byte,
+            .preserveOnPartialReset = false,
+            .defaultValue           = 0,
+            .autoIncrement          = false,
+            .address                = 0,
+        },
+
+        //aftertouch type section
+        {
+            .numberOfParameters     = MAX_NUMBER_OF_ANALOG,
+            .parameterType          = LESSDB::sectionParameterType_t::halfByte,
+            .preserveOnPartialReset = false,
+            .defaultValue           = 0,
+            .autoIncrement          = false,
+            .address                = 0,
+        },
+
+        //peak window section
+        {
+            .numberOfParameters     = MAX_NUMBER_OF_ANALOG,
+            .parameterType          = LESSDB::sectionParameterType_t::byte,
+            .preserveOnPartialReset = false,
+            .defaultValue           = 0,
+            .autoIncrement          = false,
+            .address                = 0,
+        },
+
+        //piezo setting section
+        {
+            .numberOfParameters     = static_cast<uint8_t>(Interface::analog::Analog::piezoSetting_t::AMOUNT),
+            .parameterType          = LESSDB::sectionParameterType_t::byte,
+            .preserveOnPartialReset = false,
+            .defaultValue           = 0,
+            .autoIncrement          = false,
+            .address                = 0,
         }
     };
 
@@ -0,0 +1,329 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "MIDIOutput.h"
+#include "core/src/general/Timing.h"
+
+using namespace Interface;
+
+void MIDIOutput::sendNoteOn(uint8_t note, uint8_t velocity, uint8_t channel)
+{
+    midi.sendNoteOn(note, velocity, channel);
+}
+
+void MIDIOutput::sendNoteOff(uint8_t note, uint8_t velocity, uint8_t channel)
+{
+    midi.sendNoteOff(note, velocity, channel);
+}
+
+///
+/// \brief Sends control change message which carries a relative change right away.
+/// Each such message is a single step, so it's never coalesced with the pending value for the same control.
+/// @param [in] id          Control change number.
+/// @param [in] value       Encoded step.
+/// @param [in] channel     MIDI channel.
+///
+void MIDIOutput::sendControlChangeRelative(uint8_t id, uint8_t value, uint8_t channel)
+{
+    transmit({ message_t::controlChange, channel, id, value });
+}
+
+///
+/// \brief Sends continuous control value or stores it until the link has enough free space.
+/// If the value for the same control is already pending, it's replaced with the new one.
+/// @param [in] type        Type of MIDI message.
+/// @param [in] channel     MIDI channel.
+/// @param [in] id          Control ID: CC or NRPN number, note for polyphonic aftertouch. Ignored for other types.
+/// @param [in] value       Control value.
+///
+void MIDIOutput::send(message_t type, uint8_t channel, uint16_t id, uint16_t value)
+{
+    if ((type == message_t::programChange) || (type == message_t::pitchBend) || (type == message_t::afterTouchChannel))
+        id = 0;
+
+    pending_t message = { type, channel, id, value };
+
+    for (int i = 0; i < pendingCount; i++)
+    {
+        if ((pending[i].type == type) && (pending[i].channel == channel) && (pending[i].id == id))
+        {
+            pending[i].value = value;
+            return;
+        }
+    }
+
+    //nothing is waiting - no need to store the message if it can be sent right away
+    if (!pendingCount && canSend(message))
+    {
+        transmit(message);
+        return;
+    }
+
+    if (pendingCount == MIDI_OUTPUT_QUEUE_SIZE)
+    {
+        //no more room - send the oldest message even if it has to wait for the link
+        transmit(pending[0]);
+        remove(0);
+    }
+
+    pending[pendingCount++] = message;
+}
+
+///
+/// \brief Shares free space on the link between the controls with pending values.
+/// Pending controls are visited in order and each one can send at most one message per pass:
+/// once sent, the control has to queue up behind the others with its next value, so a single
+/// busy control can't take all the free space. Message which doesn't fit into the remaining
+/// space is skipped so that cheaper messages of other controls can still be sent, but only once:
+/// if the oldest control is skipped again in the next pass, nothing else is sent until there is
+/// enough space for it.
+/// Should be called after each pass through the main loop.
+///
+void MIDIOutput::update()
+{
+#if MIDI_OUTPUT_NRPN_REFRESH_TIME > 0
+    if ((core::timing::currentRunTimeMs() - lastNRPNreset) >= MIDI_OUTPUT_NRPN_REFRESH_TIME)
+        resetNRPNselection();
+#endif
+
+    if (!pendingCount)
+        return;
+
+    size_t  space = (capacityHandler == nullptr) ? SIZE_MAX : capacityHandler();
+    uint8_t index = 0;
+
+    while (index < pendingCount)
+    {
+        size_t cost = messageCost(pending[index]);
+
+        if (cost > space)
+        {
+            if (!index)
+            {
+                if (oldestSkipped)
+                    return;
+
+                oldestSkipped = true;
+            }
+
+            index++;
+            continue;
+        }
+
+        space -= cost;
+        transmit(pending[index]);
+        remove(index);
+    }
+}
+
+///
+/// \brief Forgets last selected NRPN parameters so that they are selected again with next NRPN message.
+/// Should be called once the receiving side could have lost the selection, ie. on reconnect.
+///
+void MIDIOutput::resetNRPNselection()
+{
+    for (int i = 0; i < MIDI_OUTPUT_INTERFACES; i++)
+        resetNRPNselection(static_cast<MIDI::interface_t>(i));
+
+    lastNRPNreset = core::timing::currentRunTimeMs();
+}
+
+///
+/// \brief Forgets last selected NRPN parameters on specified interface only.
+///
+void MIDIOutput::resetNRPNselection(MIDI::interface_t interface)
+{
+    for (int i = 0; i < 16; i++)
+        selectedNRPN[static_cast<uint8_t>(interface)][i] = NRPN_NOT_SELECTED;
+}
+
+///
+/// \brief Informs the output stage about CC message which changes NRPN parameter selection (CC 98-101).
+/// Should be called for each such message written to or dropped on the interface, regardless of whether
+/// it has been sent by this class or by any other component using the MIDI module directly.
+/// @param [in] interface   Interface on which the message has been written or dropped.
+/// @param [in] channel     MIDI channel of the message.
+/// @param [in] written     True if the message has been written, false if it was dropped.
+///
+void MIDIOutput::selectionChanged(MIDI::interface_t interface, uint8_t channel, bool written)
+{
+    //own parameter selection is kept only on the interfaces it has reached
+    if (selecting && written)
+        return;
+
+    selectedNRPN[static_cast<uint8_t>(interface)][channel & 0x0F] = NRPN_NOT_SELECTED;
+}
+
+///
+/// \brief Checks if the NRPN parameter is selected on specified channel on all interfaces.
+///
+bool MIDIOutput::isNRPNselected(uint8_t channel, uint16_t id)
+{
+    for (int i = 0; i < MIDI_OUTPUT_INTERFACES; i++)
+    {
+        if (selectedNRPN[i][channel & 0x0F] != id)
+            return false;
+    }
+
+    return true;
+}
+
+///
+/// \brief Checks if the link has enough free space to send the message without waiting.
+///
+bool MIDIOutput::canSend(const pending_t& message)
+{
+    if (capacityHandler == nullptr)
+        return true;
+
+    return capacityHandler() >= messageCost(message);
+}
+
+///
+/// \brief Returns the number of 3-byte MIDI messages needed to send the message.
+///
+size_t MIDIOutput::messageCost(const pending_t& message)
+{
+    size_t cost = typeCost[static_cast<uint8_t>(message.type)];
+
+    if ((message.type == message_t::nrpn7bit) || (message.type == message_t::nrpn14bit))
+    {
+        if (!isNRPNselected(message.channel, message.id))
+            cost += 2;
+    }
+
+    return cost;
+}
+
+void MIDIOutput::transmit(const pending_t& message)
+{
+    MIDI::encDec_14bit_t encDec_14bit;
+
+    bool highRes = (highResHandler != nullptr) && highResHandler(message.type, message.channel, message.id, message.value);
+
+    //message is still sent using the MIDI module to reach other interfaces
+    if (highRes)
+        usbMuteHandler(true);
+
+    switch (message.type)
+    {
+    case message_t::controlChange:
+    {
+        midi.sendControlChange(message.id, message.value, message.channel);
+
+        //parameter selection is changed by the control itself
+        if ((message.id >= 98) && (message.id <= 101))
+        {
+            for (int i = 0; i < MIDI_OUTPUT_INTERFACES; i++)
+                selectedNRPN[i][message.channel & 0x0F] = NRPN_NOT_SELECTED;
+        }
+    }
+    break;
+
+    case message_t::programChange:
+    {
+        midi.sendProgramChange(message.value, message.channel);
+    }
+    break;
+
+    case message_t::pitchBend:
+    {
+        midi.sendPitchBend(message.value, message.channel);
+    }
+    break;
+
+    case message_t::afterTouchChannel:
+    {
+        midi.sendAfterTouch(message.value, message.channel);
+    }
+    break;
+
+    case message_t::afterTouchPoly:
+    {
+        midi.sendAfterTouch(message.value, message.channel, message.id);
+    }
+    break;
+
+    case message_t::nrpn7bit:
+    case message_t::nrpn14bit:
+    {
+        if (!isNRPNselected(message.channel, message.id))
+        {
+            //selection is cleared on the interfaces which drop any part of it
+            for (int i = 0; i < MIDI_OUTPUT_INTERFACES; i++)
+                selectedNRPN[i][message.channel & 0x0F] = message.id;
+
+            //first message contains higher byte
+            encDec_14bit.value = message.id;
+            encDec_14bit.split14bit();
+
+            selecting = true;
+            midi.sendControlChange(99, encDec_14bit.high, message.channel);
+            midi.sendControlChange(98, encDec_14bit.low, message.channel);
+            selecting = false;
+        }
+
+        if (message.type == message_t::nrpn7bit)
+        {
+            midi.sendControlChange(6, message.value, message.channel);
+        }
+        else
+        {
+            encDec_14bit.value = message.value;
+            encDec_14bit.split14bit();
+
+            midi.sendControlChange(6, encDec_14bit.high, message.channel);
+            midi.sendControlChange(38, encDec_14bit.low, message.channel);
+        }
+    }
+    break;
+
+    case message_t::controlChange14bit:
+    {
+        encDec_14bit.value = message.value;
+        encDec_14bit.split14bit();
+
+        midi.sendControlChange(message.id, encDec_14bit.high, message.channel);
+        midi.sendControlChange(message.id + 32, encDec_14bit.low, message.channel);
+
+        if ((message.id + 32 >= 98) && (message.id + 32 <= 101))
+        {
+            for (int i = 0; i < MIDI_OUTPUT_INTERFACES; i++)
+                selectedNRPN[i][message.channel & 0x0F] = NRPN_NOT_SELECTED;
+        }
+    }
+    break;
+
+    default:
+        break;
+    }
+
+    if (highRes)
+        usbMuteHandler(false);
+}
+
+void MIDIOutput::remove(uint8_t index)
+{
+    if (!index)
+        oldestSkipped = false;
+
+    pendingCount--;
+
+    for (int i = index; i < pendingCount; i++)
+        pending[i] = pending[i + 1];
+}
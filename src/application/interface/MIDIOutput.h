@@ -0,0 +1,177 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include "midi/src/MIDI.h"
+
+///
+/// \brief Maximum number of controls which can have pending value at the same time.
+///
+#define MIDI_OUTPUT_QUEUE_SIZE 16
+
+///
+/// \brief Time in milliseconds after which NRPN parameter is selected again even if it hasn't changed.
+/// Receivers which missed the selection (ie. connected to DIN port later) get it this way.
+/// Set to 0 to disable periodic selection.
+///
+#define MIDI_OUTPUT_NRPN_REFRESH_TIME 2000
+
+///
+/// \brief Number of interfaces on which NRPN parameter selection is tracked (USB and DIN).
+///
+#define MIDI_OUTPUT_INTERFACES 2
+
+namespace Interface
+{
+    ///
+    /// \brief Output stage for MIDI messages sent by components.
+    /// Continuous controls (CC, pitch bend, NRPN etc.) are sent only while the outgoing link
+    /// has enough free space. Until then, only the newest value is kept for each control
+    /// (message type, channel and ID), so fast movements don't queue up stale values.
+    /// Free space is shared between pending controls in round-robin order, one message per control.
+    /// Note on, note off and relative control change messages are always sent immediately.
+    /// NRPN parameter is selected only when it differs from the one last selected on the same channel.
+    /// Selection is tracked for each interface since the interfaces can drop messages independently.
+    /// If high-resolution handler is registered, messages it accepts aren't sent to USB using the
+    /// MIDI module - other interfaces still receive MIDI 1.0 messages.
+    /// \defgroup interfaceMIDIOutput MIDI output
+    /// \ingroup interface
+    /// @{
+    ///
+
+    class MIDIOutput
+    {
+        public:
+        ///
+        /// \brief Returns the number of 3-byte MIDI messages which can be sent without blocking.
+        ///
+        using capacityHandler_t = size_t (*)();
+
+        enum class message_t : uint8_t
+        {
+            controlChange,
+            programChange,
+            pitchBend,
+            afterTouchChannel,
+            afterTouchPoly,
+            nrpn7bit,
+            nrpn14bit,
+            controlChange14bit,
+            AMOUNT
+        };
+
+        ///
+        /// \brief Sends the message to USB as single high-resolution message.
+        /// \returns True if the message has been sent, false if it should be sent using the MIDI module.
+        ///
+        using highResHandler_t = bool (*)(message_t type, uint8_t channel, uint16_t id, uint16_t value);
+
+        ///
+        /// \brief Enables or disables USB output of the MIDI module.
+        ///
+        using usbMuteHandler_t = void (*)(bool state);
+
+        MIDIOutput(MIDI& midi)
+            : midi(midi)
+        {
+            resetNRPNselection();
+        }
+
+        void registerCapacityHandler(capacityHandler_t handler)
+        {
+            capacityHandler = handler;
+        }
+
+        void registerHighResHandler(highResHandler_t sendHandler, usbMuteHandler_t muteHandler)
+        {
+            highResHandler = sendHandler;
+            usbMuteHandler = muteHandler;
+        }
+
+        void sendNoteOn(uint8_t note, uint8_t velocity, uint8_t channel);
+        void sendNoteOff(uint8_t note, uint8_t velocity, uint8_t channel);
+        void sendControlChangeRelative(uint8_t id, uint8_t value, uint8_t channel);
+        void send(message_t type, uint8_t channel, uint16_t id, uint16_t value);
+        void update();
+        void resetNRPNselection();
+        void resetNRPNselection(MIDI::interface_t interface);
+        void selectionChanged(MIDI::interface_t interface, uint8_t channel, bool written);
+
+        private:
+        typedef struct
+        {
+            message_t type;
+            uint8_t   channel;
+            uint16_t  id;
+            uint16_t  value;
+        } pending_t;
+
+        bool   isNRPNselected(uint8_t channel, uint16_t id);
+        bool   canSend(const pending_t& message);
+        size_t messageCost(const pending_t& message);
+        void   transmit(const pending_t& message);
+        void   remove(uint8_t index);
+
+        MIDI&             midi;
+        capacityHandler_t capacityHandler = nullptr;
+        highResHandler_t  highResHandler  = nullptr;
+        usbMuteHandler_t  usbMuteHandler  = nullptr;
+
+        ///
+        /// \brief Messages waiting to be sent, oldest first.
+        ///
+        pending_t pending[MIDI_OUTPUT_QUEUE_SIZE] = {};
+        uint8_t   pendingCount                    = 0;
+
+        ///
+        /// \brief Set once the oldest pending message has been skipped because it didn't fit on the link.
+        ///
+        bool oldestSkipped = false;
+
+        ///
+        /// \brief Last selected NRPN parameter for each interface and MIDI channel.
+        /// Set to NRPN_NOT_SELECTED if the selection isn't known.
+        ///
+        static constexpr uint16_t NRPN_NOT_SELECTED                        = 0xFFFF;
+        uint16_t                  selectedNRPN[MIDI_OUTPUT_INTERFACES][16] = {};
+        uint32_t                  lastNRPNreset                            = 0;
+
+        ///
+        /// \brief Set while NRPN parameter selection is being sent.
+        ///
+        bool selecting = false;
+
+        ///
+        /// \brief Number of 3-byte MIDI messages needed to send each message type.
+        /// NRPN parameter selection requires two additional messages.
+        ///
+        const uint8_t typeCost[static_cast<uint8_t>(message_t::AMOUNT)] = {
+            1,    //controlChange
+            1,    //programChange
+            1,    //pitchBend
+            1,    //afterTouchChannel
+            1,    //afterTouchPoly
+            1,    //nrpn7bit
+            2,    //nrpn14bit
+            2,    //controlChange14bit
+        };
+    };
+
+    /// @}
+}    // namespace Interface
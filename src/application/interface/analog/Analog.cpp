@@ -20,70 +20,235 @@ limitations under the License.
 #include "board/Board.h"
 #include "core/src/general/Helpers.h"
 
+#ifdef __AVR__
+#include <avr/pgmspace.h>
+#endif
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+
 using namespace Interface::analog;
 
+namespace
+{
+    ///
+    /// \brief Predefined response curves in 14-bit resolution.
+    /// Each curve is described with ANALOG_CURVE_POINTS equally spaced points
+    /// between which the values are linearly interpolated.
+    /// Linear and custom curves aren't stored here. Table is kept in flash on AVR.
+    ///
+    constexpr uint16_t curveTable[static_cast<uint8_t>(Analog::curve_t::custom) - 1][ANALOG_CURVE_POINTS] PROGMEM = {
+        //log
+        {
+            0,
+            3175,
+            5363,
+            7034,
+            8386,
+            9522,
+            10501,
+            11362,
+            12129,
+            12822,
+            13453,
+            14033,
+            14569,
+            15068,
+            15534,
+            15971,
+            16383
+        },
+
+        //exp
+        {
+            0,
+            282,
+            607,
+            983,
+            1417,
+            1918,
+            2496,
+            3165,
+            3936,
+            4827,
+            5856,
+            7044,
+            8416,
+            10001,
+            11830,
+            13943,
+            16383
+        },
+
+        //s-curve
+        {
+            0,
+            184,
+            704,
+            1512,
+            2560,
+            3800,
+            5184,
+            6664,
+            8192,
+            9719,
+            11199,
+            12583,
+            13823,
+            14871,
+            15679,
+            16199,
+            16383
+        }
+    };
+}    // namespace
+
+void Analog::init()
+{
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+        debounceReset(i);
+}
+
 void Analog::update()
 {
     if (!Board::io::isAnalogDataAvailable())
         return;
 
-    //check values
-    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    //check only the components whose value has changed
+    for (int group = 0; group < ANALOG_GROUPS; group++)
     {
-        //don't process component if it's not enabled
-        if (!database.read(Database::Section::analog_t::enable, i))
-            continue;
+        uint8_t mask   = Board::io::getAnalogChangeMask(group) | pending[group];
+        pending[group] = 0;
 
-        int16_t analogData = Board::io::getAnalogValue(i);
-        auto    type       = static_cast<type_t>(database.read(Database::Section::analog_t::type, i));
-
-        if (expFilterUsed)
+        for (int i = group << 3; mask && (i < MAX_NUMBER_OF_ANALOG); i++, mask >>= 1)
         {
-            //normally use exponential filter (factor 0.5 for easier bitwise math), but not around the edges
-            if (analogData <= ANALOG_STEP_MIN_DIFF_7_BIT)
-                analogData = 0;
-            else if (analogData >= (ADC_MAX_VALUE - ANALOG_STEP_MIN_DIFF_7_BIT))
-                analogData = ADC_MAX_VALUE;
-            else
-                analogData = (analogData >> 1) + (lastAnalogueValue[i] >> 1);
+            if (mask & 0x01)
+                processComponent(i);
         }
+    }
 
-        if (type != type_t::button)
-        {
-            switch (type)
-            {
-            case type_t::potentiometerControlChange:
-            case type_t::potentiometerNote:
-            case type_t::nrpn7b:
-            case type_t::nrpn14b:
-            case type_t::pitchBend:
-            case type_t::cc14bit:
-                checkPotentiometerValue(type, i, analogData);
-                break;
-
-            case type_t::fsr:
-                checkFSRvalue(i, analogData);
-                break;
-
-            default:
-                break;
-            }
-        }
+    Board::io::continueAnalogReadout();
+}
+
+void Analog::processComponent(uint8_t analogID)
+{
+    //don't process component if it's not enabled
+    if (!database.read(Database::Section::analog_t::enable, analogID))
+        return;
+
+    int16_t  analogData = Board::io::getAnalogValue(analogID);
+    int16_t  rawData    = analogData;
+    uint16_t lastValue  = lastAnalogueValue[analogID];
+    auto     type       = static_cast<type_t>(database.read(Database::Section::analog_t::type, analogID));
+    bool     recheck    = false;
+
+    //piezo strikes are too short to be filtered
+    if (expFilterUsed && (type != type_t::piezo))
+    {
+        //normally use exponential filter (factor 0.5 for easier bitwise math), but not around the edges
+        if (analogData <= ANALOG_STEP_MIN_DIFF_7_BIT)
+            analogData = 0;
+        else if (analogData >= (ADC_MAX_VALUE - ANALOG_STEP_MIN_DIFF_7_BIT))
+            analogData = ADC_MAX_VALUE;
         else
+            analogData = (analogData >> 1) + (lastAnalogueValue[analogID] >> 1);
+    }
+
+    if (type != type_t::button)
+    {
+        switch (type)
         {
-            if (buttonHandler != nullptr)
-                (*buttonHandler)(i, analogData);
+        case type_t::potentiometerControlChange:
+        case type_t::potentiometerNote:
+        case type_t::nrpn7b:
+        case type_t::nrpn14b:
+        case type_t::pitchBend:
+        case type_t::cc14bit:
+            checkPotentiometerValue(type, analogID, analogData);
+            break;
+
+        case type_t::fsr:
+            recheck = checkFSRvalue(analogID, analogData);
+            break;
+
+        case type_t::piezo:
+            recheck = checkPiezoValue(analogID, analogData);
+            break;
+
+        default:
+            break;
         }
     }
+    else
+    {
+        if (buttonHandler != nullptr)
+            (*buttonHandler)(analogID, analogData);
+    }
 
-    Board::io::continueAnalogReadout();
+    //filtered value is still moving towards the raw one - check it again on next readout
+    //even if the raw value doesn't change
+    if (expFilterUsed && (lastAnalogueValue[analogID] != lastValue) && (analogData != rawData))
+        recheck = true;
+
+    if (recheck)
+        BIT_SET(pending[analogID >> 3], analogID & 0x07);
 }
 
 void Analog::debounceReset(uint16_t index)
 {
     lastDirection[index]     = potDirection_t::initial;
     lastAnalogueValue[index] = 0;
-    fsrPressed[index]        = false;
+    componentState[index]    = {};
+
+    //make sure the component is checked on next readout
+    BIT_SET(pending[index >> 3], index & 0x07);
+
+    //pads need faster sampling in order to catch the strike peak
+    bool enabled = database.read(Database::Section::analog_t::enable, index);
+    auto type    = static_cast<type_t>(database.read(Database::Section::analog_t::type, index));
+
+    Board::io::setAnalogFastLane(index, enabled && ((type == type_t::fsr) || (type == type_t::piezo)));
+    Board::io::setAnalogBurst(index, enabled && (type == type_t::piezo));
+
+    //ignore noise smaller than the step needed for new 7-bit value
+    //14-bit values need every change of raw value
+    if ((type == type_t::nrpn14b) || (type == type_t::pitchBend) || (type == type_t::cc14bit))
+        Board::io::setAnalogChangeThreshold(index, ANALOG_STEP_MIN_DIFF_14_BIT);
+    else
+        Board::io::setAnalogChangeThreshold(index, ANALOG_CHANGE_THRESHOLD);
+}
+
+///
+/// \brief Sends note on or note off for specified analog component.
+///
+void Analog::sendNote(uint8_t analogID, bool state, uint8_t velocity)
+{
+    uint8_t note    = database.read(Database::Section::analog_t::midiID, analogID);
+    uint8_t channel = database.read(Database::Section::analog_t::midiChannel, analogID);
+
+    if (state)
+    {
+        midi.sendNoteOn(note, velocity, channel);
+#ifdef DISPLAY_SUPPORTED
+        display.displayMIDIevent(Display::eventType_t::out, Display::event_t::noteOn, note, velocity, channel + 1);
+#endif
+#ifdef LEDS_SUPPORTED
+        leds.midiToState(MIDI::messageType_t::noteOn, note, velocity, channel, true);
+#endif
+    }
+    else
+    {
+        midi.sendNoteOff(note, 0, channel);
+#ifdef DISPLAY_SUPPORTED
+        display.displayMIDIevent(Display::eventType_t::out, Display::event_t::noteOff, note, 0, channel + 1);
+#endif
+#ifdef LEDS_SUPPORTED
+        leds.midiToState(MIDI::messageType_t::noteOff, note, 0, channel, true);
+#endif
+    }
+
+    cInfo.send(Database::block_t::analog, analogID);
 }
 
 ///
@@ -102,4 +267,19 @@ void Analog::enableExpFiltering()
 void Analog::disableExpFiltering()
 {
     expFilterUsed = false;
-}
\ No newline at end of file
+}
+
+///
+/// \brief Retrieves single point of specified response curve in 14-bit resolution.
+///
+uint16_t Analog::curvePoint(curve_t curve, uint8_t index)
+{
+    if (curve == curve_t::custom)
+        return (userCurve[index] << 7) | userCurve[index];
+
+#ifdef __AVR__
+    return pgm_read_word(&curveTable[static_cast<uint8_t>(curve) - 1][index]);
+#else
+    return curveTable[static_cast<uint8_t>(curve) - 1][index];
+#endif
+}
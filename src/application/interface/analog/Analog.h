@@ -27,6 +27,8 @@ limitations under the License.
 #include "interface/display/Display.h"
 #endif
 #include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
+#include "Constants.h"
 
 namespace Interface
 {
@@ -44,18 +46,18 @@ namespace Interface
             public:
 #ifdef LEDS_SUPPORTED
 #ifndef DISPLAY_SUPPORTED
-            Analog(Database& database, MIDI& midi, Interface::digital::output::LEDs& leds, ComponentInfo& cInfo)
+            Analog(Database& database, MIDIOutput& midi, Interface::digital::output::LEDs& leds, ComponentInfo& cInfo)
                 :
 #else
-            Analog(Database& database, MIDI& midi, Interface::digital::output::LEDs& leds, Display& display, ComponentInfo& cInfo)
+            Analog(Database& database, MIDIOutput& midi, Interface::digital::output::LEDs& leds, Display& display, ComponentInfo& cInfo)
                 :
 #endif
 #else
 #ifdef DISPLAY_SUPPORTED
-            Analog(Database& database, MIDI& midi, Display& display, ComponentInfo& cInfo)
+            Analog(Database& database, MIDIOutput& midi, Display& display, ComponentInfo& cInfo)
                 :
 #else
-            Analog(Database& database, MIDI& midi, ComponentInfo& cInfo)
+            Analog(Database& database, MIDIOutput& midi, ComponentInfo& cInfo)
                 :
 #endif
 #endif
@@ -68,7 +70,11 @@ namespace Interface
                 , display(display)
 #endif
                 , cInfo(cInfo)
-            {}
+            {
+                //make sure all analog components are checked on first readout
+                for (int i = 0; i < ANALOG_GROUPS; i++)
+                    pending[i] = 0xFF;
+            }
 
             enum class type_t : uint8_t
             {
@@ -80,6 +86,7 @@ namespace Interface
                 nrpn14b,
                 pitchBend,
                 cc14bit,
+                piezo,
                 AMOUNT
             };
 
@@ -89,6 +96,32 @@ namespace Interface
                 aftertouch
             };
 
+            enum class aftertouchType_t : uint8_t
+            {
+                none,
+                channel,
+                poly,
+                AMOUNT
+            };
+
+            enum class piezoSetting_t : uint8_t
+            {
+                maskTime,
+                crosstalk,
+                AMOUNT
+            };
+
+            enum class curve_t : uint8_t
+            {
+                linear,
+                log,
+                exp,
+                sCurve,
+                custom,
+                AMOUNT
+            };
+
+            void init();
             void update();
             void debounceReset(uint16_t index);
             void setButtonHandler(void (*fptr)(uint8_t adcIndex, uint16_t adcValue));
@@ -103,18 +136,84 @@ namespace Interface
                 increasing
             };
 
+            ///
+            /// \brief Precomputed conversion from full-range MIDI value to the value which is sent.
+            /// Lower/upper limits and inversion are folded into offset, gain and direction so that
+            /// the conversion requires only single multiplication and shift.
+            ///
+            typedef struct
+            {
+                uint16_t offset;
+                uint16_t gain;
+                curve_t  curve;
+                bool     subtract;
+            } scaler_t;
+
+            enum class fsrState_t : uint8_t
+            {
+                released,
+                strike,
+                pressed
+            };
+
+            ///
+            /// \brief Holds current state of FSR component.
+            ///
+            typedef struct
+            {
+                fsrState_t state;
+                uint8_t    timer;         ///< Lower 8 bits of run time in milliseconds when the state or aftertouch has last changed.
+                uint8_t    aftertouch;    ///< Last sent aftertouch value.
+                uint16_t   peak;          ///< Highest pressure registered during the strike.
+            } fsr_t;
+
+            enum class piezoState_t : uint8_t
+            {
+                idle,
+                scan,
+                masked
+            };
+
+            ///
+            /// \brief Holds current state of piezo component.
+            ///
+            typedef struct
+            {
+                piezoState_t state;
+                uint8_t      timer;    ///< Lower 8 bits of run time in milliseconds when the state has last changed.
+                uint8_t      peak;     ///< Highest 7-bit level registered during the strike.
+            } piezo_t;
+
+            ///
+            /// \brief Holds data specific to the type of analog component.
+            ///
+            typedef union
+            {
+                scaler_t scaler;
+                fsr_t    fsr;
+                piezo_t  piezo;
+            } componentState_t;
+
             uint16_t getHysteresisValue(uint8_t analogID, int16_t value);
             void     checkPotentiometerValue(type_t analogType, uint8_t analogID, uint32_t value);
-            void     checkFSRvalue(uint8_t analogID, uint16_t pressure);
+            uint16_t adcToMIDI(uint32_t value, uint16_t maxValue);
+            void     compileScaler(uint8_t analogID, bool use14bit);
+            uint16_t scaleValue(uint8_t analogID, uint16_t value, bool use14bit);
+            uint16_t applyCurve(curve_t curve, uint16_t value, bool use14bit);
+            uint16_t curvePoint(curve_t curve, uint8_t index);
+            bool     checkFSRvalue(uint8_t analogID, uint16_t pressure);
+            void     sendAftertouch(uint8_t analogID, uint8_t value);
+            bool     checkPiezoValue(uint8_t analogID, uint16_t value);
+            bool     isCrosstalk(uint8_t analogID, uint8_t level);
+            void     processComponent(uint8_t analogID);
+            void     sendNote(uint8_t analogID, bool state, uint8_t velocity);
             bool     fsrPressureStable(uint8_t analogID);
-            bool     getFsrPressed(uint8_t fsrID);
-            void     setFsrPressed(uint8_t fsrID, bool state);
             bool     getFsrDebounceTimerStarted(uint8_t fsrID);
             void     setFsrDebounceTimerStarted(uint8_t fsrID, bool state);
             uint32_t calibratePressure(uint32_t value, pressureType_t type);
 
-            Database& database;
-            MIDI&     midi;
+            Database&   database;
+            MIDIOutput& midi;
 #ifdef LEDS_SUPPORTED
             Interface::digital::output::LEDs& leds;
 #endif
@@ -124,10 +223,15 @@ namespace Interface
             ComponentInfo& cInfo;
 
             void (*buttonHandler)(uint8_t adcIndex, uint16_t adcValue) = nullptr;
-            uint16_t       lastAnalogueValue[MAX_NUMBER_OF_ANALOG]     = {};
-            uint8_t        fsrPressed[MAX_NUMBER_OF_ANALOG]            = {};
-            potDirection_t lastDirection[MAX_NUMBER_OF_ANALOG]         = {};
-            bool           expFilterUsed                               = true;
+            uint16_t         lastAnalogueValue[MAX_NUMBER_OF_ANALOG]   = {};
+            potDirection_t   lastDirection[MAX_NUMBER_OF_ANALOG]       = {};
+            bool             expFilterUsed                             = true;
+            componentState_t componentState[MAX_NUMBER_OF_ANALOG]      = {};
+            uint8_t          userCurve[ANALOG_CURVE_POINTS]            = {};
+            uint8_t          lastStrikeID                              = 0;
+            uint8_t          lastStrikeLevel                           = 0;
+            uint32_t         lastStrikeTime                            = 0;
+            uint8_t          pending[ANALOG_GROUPS]                    = {};    ///< Bitmask of components to check on next readout even if their ADC value hasn't changed.
         };
 
         /// @}
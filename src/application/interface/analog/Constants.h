@@ -0,0 +1,76 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+///
+/// \brief Number of segments into which response curves are divided, expressed as a power of two.
+///
+#define ANALOG_CURVE_SEGMENT_BITS 4
+
+///
+/// \brief Number of segments into which response curves are divided.
+///
+#define ANALOG_CURVE_SEGMENTS (1 << ANALOG_CURVE_SEGMENT_BITS)
+
+///
+/// \brief Total number of points used to describe single response curve.
+///
+#define ANALOG_CURVE_POINTS (ANALOG_CURVE_SEGMENTS + 1)
+
+///
+/// \brief Number of bits used for the fractional part of the gain in precomputed analog scaling.
+///
+#define ANALOG_SCALE_SHIFT 14
+
+///
+/// \brief Number of 8-component groups used to track analog components which need processing.
+///
+#define ANALOG_GROUPS ((MAX_NUMBER_OF_ANALOG + 7) / 8)
+
+///
+/// \brief Minimum time in milliseconds between two aftertouch messages sent from the same FSR component.
+///
+#define FSR_AFTERTOUCH_INTERVAL 10
+
+///
+/// \brief Minimum difference between two aftertouch values needed to send new aftertouch message.
+///
+#define FSR_AFTERTOUCH_MIN_DIFF 2
+
+///
+/// \brief Maximum time in milliseconds during which FSR strike peak is searched for.
+///
+#define FSR_PEAK_WINDOW_MAX 100
+
+///
+/// \brief Maximum time in milliseconds during which piezo component ignores new strikes after the last one.
+///
+#define PIEZO_MASK_TIME_MAX 250
+
+///
+/// \brief Default time in milliseconds during which piezo component ignores new strikes after the last one.
+///
+#define PIEZO_MASK_TIME_DEFAULT 30
+
+///
+/// \brief Number of bits used for the fractional part of piezo crosstalk ratio.
+/// Strike is considered to be crosstalk if its level is lower than the level of the
+/// last strike on another piezo component multiplied with crosstalk ratio.
+///
+#define PIEZO_CROSSTALK_SHIFT 7
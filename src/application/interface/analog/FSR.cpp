@@ -19,6 +19,7 @@ limitations under the License.
 #include "Analog.h"
 #include "board/Board.h"
 #include "core/src/general/Helpers.h"
+#include "core/src/general/Timing.h"
 
 using namespace Interface::analog;
 
@@ -39,58 +40,137 @@ uint32_t Analog::calibratePressure(uint32_t value, pressureType_t type)
     }
 }
 
-bool Analog::getFsrPressed(uint8_t fsrID)
+///
+/// \brief Handles FSR state changes.
+/// Note on is sent once the pressure peak is found or once configured peak window has expired.
+/// While FSR is pressed, aftertouch is sent if configured.
+/// \returns True if the component needs to be checked again even if its value doesn't change.
+///
+bool Analog::checkFSRvalue(uint8_t analogID, uint16_t pressure)
 {
-    return fsrPressed[fsrID];
-}
+    auto&   fsr      = componentState[analogID].fsr;
+    auto    velocity = calibratePressure(pressure, pressureType_t::velocity);
+    uint8_t now      = core::timing::currentRunTimeMs();
+    bool    recheck  = false;
 
-void Analog::setFsrPressed(uint8_t fsrID, bool state)
-{
-    fsrPressed[fsrID] = state;
-}
+    //update values
+    lastAnalogueValue[analogID] = pressure;
 
-void Analog::checkFSRvalue(uint8_t analogID, uint16_t pressure)
-{
-    auto calibratedPressure = calibratePressure(pressure, pressureType_t::velocity);
+    switch (fsr.state)
+    {
+    case fsrState_t::released:
+    {
+        if (velocity)
+        {
+            fsr.state = fsrState_t::strike;
+            fsr.peak  = pressure;
+            fsr.timer = now;
+        }
+    }
+    break;
 
-    if (calibratedPressure > 0)
+    case fsrState_t::strike:
     {
-        if (!getFsrPressed(analogID))
+        if (pressure > fsr.peak)
+            fsr.peak = pressure;
+    }
+    break;
+
+    case fsrState_t::pressed:
+    {
+        if (!velocity)
         {
-            //sensor is really pressed
-            setFsrPressed(analogID, true);
-            uint8_t note    = database.read(Database::Section::analog_t::midiID, analogID);
-            uint8_t channel = database.read(Database::Section::analog_t::midiChannel, analogID);
-            midi.sendNoteOn(note, calibratedPressure, channel);
-#ifdef DISPLAY_SUPPORTED
-            display.displayMIDIevent(Display::eventType_t::out, Display::event_t::noteOn, note, calibratedPressure, channel + 1);
-#endif
-#ifdef LEDS_SUPPORTED
-            leds.midiToState(MIDI::messageType_t::noteOn, note, calibratedPressure, channel, true);
-#endif
+            //reset aftertouch before releasing the note
+            if (fsr.aftertouch)
+            {
+                sendAftertouch(analogID, 0);
+                fsr.aftertouch = 0;
+            }
+
+            sendNote(analogID, false, 0);
+            fsr.state = fsrState_t::released;
+            return false;
+        }
+
+        auto aftertouchType = static_cast<aftertouchType_t>(database.read(Database::Section::analog_t::aftertouchType, analogID));
 
-            cInfo.send(Database::block_t::analog, analogID);
+        if (aftertouchType == aftertouchType_t::none)
+            return false;
+
+        uint8_t aftertouch = calibratePressure(pressure, pressureType_t::aftertouch);
+
+        if (abs(aftertouch - fsr.aftertouch) < FSR_AFTERTOUCH_MIN_DIFF)
+        {
+            //make sure the value settles on the edges
+            if ((aftertouch == fsr.aftertouch) || ((aftertouch != 0) && (aftertouch != MIDI_7_BIT_VALUE_MAX)))
+                return false;
         }
+
+        if (static_cast<uint8_t>(now - fsr.timer) < FSR_AFTERTOUCH_INTERVAL)
+            return true;    //rate limited - try again on next readout
+
+        sendAftertouch(analogID, aftertouch);
+        fsr.aftertouch = aftertouch;
+        fsr.timer      = now;
+        return false;
     }
-    else
+
+    default:
+        return false;
+    }
+
+    //strike is in progress - note on is sent once the pressure starts dropping
+    //or once the peak window expires
+    bool peakFound = (pressure < fsr.peak) || !velocity;
+    bool expired   = static_cast<uint8_t>(now - fsr.timer) >= database.read(Database::Section::analog_t::peakWindow, analogID);
+
+    if (peakFound || expired)
     {
-        if (getFsrPressed(analogID))
+        sendNote(analogID, true, calibratePressure(fsr.peak, pressureType_t::velocity));
+        fsr.state      = fsrState_t::pressed;
+        fsr.aftertouch = 0;
+        fsr.timer      = now;
+
+        if (!velocity)
         {
-            setFsrPressed(analogID, false);
-            uint8_t note    = database.read(Database::Section::analog_t::midiID, analogID);
-            uint8_t channel = database.read(Database::Section::analog_t::midiChannel, analogID);
-            midi.sendNoteOff(note, 0, channel);
+            //released before the strike was processed
+            sendNote(analogID, false, 0);
+            fsr.state = fsrState_t::released;
+        }
+    }
+    else
+    {
+        recheck = true;
+    }
+
+    return recheck;
+}
+
+///
+/// \brief Sends aftertouch of configured type for specified FSR component.
+///
+void Analog::sendAftertouch(uint8_t analogID, uint8_t value)
+{
+    uint8_t note    = database.read(Database::Section::analog_t::midiID, analogID);
+    uint8_t channel = database.read(Database::Section::analog_t::midiChannel, analogID);
+
+    switch (static_cast<aftertouchType_t>(database.read(Database::Section::analog_t::aftertouchType, analogID)))
+    {
+    case aftertouchType_t::channel:
+        midi.send(MIDIOutput::message_t::afterTouchChannel, channel, 0, value);
 #ifdef DISPLAY_SUPPORTED
-            display.displayMIDIevent(Display::eventType_t::out, Display::event_t::noteOff, note, calibratedPressure, channel + 1);
+        display.displayMIDIevent(Display::eventType_t::out, Display::event_t::afterTouchChannel, 0, value, channel + 1);
 #endif
-#ifdef LEDS_SUPPORTED
-            leds.midiToState(MIDI::messageType_t::noteOff, note, 0, channel, true);
+        break;
+
+    case aftertouchType_t::poly:
+        midi.send(MIDIOutput::message_t::afterTouchPoly, channel, note, value);
+#ifdef DISPLAY_SUPPORTED
+        display.displayMIDIevent(Display::eventType_t::out, Display::event_t::afterTouchPoly, note, value, channel + 1);
 #endif
+        break;
 
-            cInfo.send(Database::block_t::analog, analogID);
-        }
+    default:
+        break;
     }
-
-    //update values
-    lastAnalogueValue[analogID] = pressure;
-}
\ No newline at end of file
+}
@@ -0,0 +1,143 @@
+/*
+
+Copyright 2015-2020 Igor Petrovic
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include "Analog.h"
+#include "board/Board.h"
+#include "core/src/general/Helpers.h"
+#include "core/src/general/Timing.h"
+
+using namespace Interface::analog;
+
+//piezo inputs should be protected with 1M resistor between signal and ground
+//and with zener diode limiting the voltage to the ADC reference
+
+///
+/// \brief Handles piezo state changes.
+/// Strike starts once the level exceeds the lower limit. Note on is sent with the highest level
+/// registered during the configured peak window. Further strikes are ignored until the mask
+/// time expires and the level drops below the lower limit, after which note off is sent.
+/// \returns True if the component needs to be checked again even if its value doesn't change.
+///
+bool Analog::checkPiezoValue(uint8_t analogID, uint16_t value)
+{
+    auto&                piezo = componentState[analogID].piezo;
+    uint8_t              level = adcToMIDI(value, MIDI_7_BIT_VALUE_MAX);
+    uint8_t              now   = core::timing::currentRunTimeMs();
+    MIDI::encDec_14bit_t encDec_14bit;
+
+    //use 7-bit lower limit as trigger threshold
+    encDec_14bit.value = database.read(Database::Section::analog_t::lowerLimit, analogID);
+    encDec_14bit.split14bit();
+    uint8_t threshold = encDec_14bit.low;
+
+    //update values
+    lastAnalogueValue[analogID] = value;
+
+    switch (piezo.state)
+    {
+    case piezoState_t::idle:
+    {
+        if (level <= threshold)
+            return false;
+
+        piezo.state = piezoState_t::scan;
+        piezo.peak  = level;
+        piezo.timer = now;
+    }
+    break;
+
+    case piezoState_t::scan:
+    {
+        if (level > piezo.peak)
+            piezo.peak = level;
+    }
+    break;
+
+    case piezoState_t::masked:
+    {
+        if (static_cast<uint8_t>(now - piezo.timer) < database.read(Database::Section::analog_t::piezoSetting, static_cast<size_t>(piezoSetting_t::maskTime)))
+            return true;
+
+        //piezo is still ringing - new strike is possible only once the level drops
+        if (level > threshold)
+            return false;
+
+        //peak is cleared if the strike was ignored
+        if (piezo.peak)
+            sendNote(analogID, false, 0);
+
+        piezo.state = piezoState_t::idle;
+        return false;
+    }
+
+    default:
+        return false;
+    }
+
+    if (static_cast<uint8_t>(now - piezo.timer) < database.read(Database::Section::analog_t::peakWindow, analogID))
+        return true;
+
+    if (isCrosstalk(analogID, piezo.peak))
+    {
+        piezo.peak = 0;
+    }
+    else
+    {
+        auto    curve    = static_cast<curve_t>(database.read(Database::Section::analog_t::curve, analogID));
+        uint8_t velocity = (curve == curve_t::linear) ? piezo.peak : applyCurve(curve, piezo.peak, false);
+
+        //velocity 0 would be interpreted as note off
+        sendNote(analogID, true, velocity ? velocity : 1);
+    }
+
+    piezo.state = piezoState_t::masked;
+    piezo.timer = now;
+
+    return true;
+}
+
+///
+/// \brief Checks if the strike on specified piezo component is caused by the last strike on another piezo.
+/// Strike is considered to be crosstalk if it happens within the mask time of the last strike on
+/// another piezo component and if its level is lower than the last strike level multiplied with
+/// crosstalk ratio. Strikes which aren't crosstalk are remembered if they're stronger than the last one.
+/// @param [in] analogID    Index of piezo component.
+/// @param [in] level       7-bit strike level.
+/// \returns True if the strike should be ignored.
+///
+bool Analog::isCrosstalk(uint8_t analogID, uint8_t level)
+{
+    uint32_t now    = core::timing::currentRunTimeMs();
+    uint8_t  ratio  = database.read(Database::Section::analog_t::piezoSetting, static_cast<size_t>(piezoSetting_t::crosstalk));
+    bool     active = (now - lastStrikeTime) < database.read(Database::Section::analog_t::piezoSetting, static_cast<size_t>(piezoSetting_t::maskTime));
+
+    if (active && ratio && (lastStrikeID != analogID))
+    {
+        if (level <= ((lastStrikeLevel * ratio) >> PIEZO_CROSSTALK_SHIFT))
+            return true;
+    }
+
+    if (!active || (level >= lastStrikeLevel))
+    {
+        lastStrikeID    = analogID;
+        lastStrikeLevel = level;
+        lastStrikeTime  = now;
+    }
+
+    return false;
+}
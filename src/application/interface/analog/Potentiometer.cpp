@@ -22,6 +22,8 @@ limitations under the License.
 
 using namespace Interface::analog;
 
+static_assert(ADC_MAX_VALUE == ((1 << ADC_RESOLUTION) - 1), "ADC_MAX_VALUE and ADC_RESOLUTION don't match");
+
 void Analog::checkPotentiometerValue(type_t analogType, uint8_t analogID, uint32_t value)
 {
     uint16_t maxLimit;
@@ -60,46 +62,32 @@ void Analog::checkPotentiometerValue(type_t analogType, uint8_t analogID, uint32
             return;
     }
 
-    auto midiValue    = core::misc::mapRange(value, static_cast<uint32_t>(ADC_MIN_VALUE), static_cast<uint32_t>(ADC_MAX_VALUE), static_cast<uint32_t>(0), static_cast<uint32_t>(maxLimit));
-    auto oldMIDIvalue = core::misc::mapRange(static_cast<uint32_t>(lastAnalogueValue[analogID]), static_cast<uint32_t>(ADC_MIN_VALUE), static_cast<uint32_t>(ADC_MAX_VALUE), static_cast<uint32_t>(0), static_cast<uint32_t>(maxLimit));
+    auto midiValue    = adcToMIDI(value, maxLimit);
+    auto oldMIDIvalue = adcToMIDI(lastAnalogueValue[analogID], maxLimit);
 
     //this will allow value 0 as the first sent value
     if ((midiValue == oldMIDIvalue) && (lastDirection[analogID] != potDirection_t::initial))
         return;
 
+    //limits, inversion and curve are read from database only on first readout after reset
+    if (lastDirection[analogID] == potDirection_t::initial)
+        compileScaler(analogID, use14bit);
+
     lastDirection[analogID] = direction;
 
-    uint16_t             lowerLimit = database.read(Database::Section::analog_t::lowerLimit, analogID);
-    uint16_t             upperLimit = database.read(Database::Section::analog_t::upperLimit, analogID);
-    uint16_t             midiID     = database.read(Database::Section::analog_t::midiID, analogID);
-    uint8_t              channel    = database.read(Database::Section::analog_t::midiChannel, analogID);
+    uint16_t             midiID  = database.read(Database::Section::analog_t::midiID, analogID);
+    uint8_t              channel = database.read(Database::Section::analog_t::midiChannel, analogID);
     MIDI::encDec_14bit_t encDec_14bit;
 
     if (!use14bit)
     {
-        //use 7-bit MIDI ID and limits
+        //use 7-bit MIDI ID
         encDec_14bit.value = midiID;
         encDec_14bit.split14bit();
         midiID = encDec_14bit.low;
-
-        encDec_14bit.value = lowerLimit;
-        encDec_14bit.split14bit();
-        lowerLimit = encDec_14bit.low;
-
-        encDec_14bit.value = upperLimit;
-        encDec_14bit.split14bit();
-        upperLimit = encDec_14bit.low;
     }
-    // else
-    // {
-    //     //14-bit values are already read
-    // }
 
-    auto scaledMIDIvalue = core::misc::mapRange(midiValue, static_cast<uint32_t>(0), static_cast<uint32_t>(maxLimit), static_cast<uint32_t>(lowerLimit), static_cast<uint32_t>(upperLimit));
-
-    //invert MIDI data if configured
-    if (database.read(Database::Section::analog_t::invert, analogID))
-        scaledMIDIvalue = maxLimit - scaledMIDIvalue;
+    auto scaledMIDIvalue = scaleValue(analogID, midiValue, use14bit);
 
     switch (analogType)
     {
@@ -107,7 +95,7 @@ void Analog::checkPotentiometerValue(type_t analogType, uint8_t analogID, uint32
     case type_t::potentiometerNote:
         if (analogType == type_t::potentiometerControlChange)
         {
-            midi.sendControlChange(midiID, scaledMIDIvalue, channel);
+            midi.send(MIDIOutput::message_t::controlChange, channel, midiID, scaledMIDIvalue);
 #ifdef DISPLAY_SUPPORTED
             display.displayMIDIevent(Display::eventType_t::out, Display::event_t::controlChange, midiID, scaledMIDIvalue, channel + 1);
 #endif
@@ -123,54 +111,29 @@ void Analog::checkPotentiometerValue(type_t analogType, uint8_t analogID, uint32
 
     case type_t::nrpn7b:
     case type_t::nrpn14b:
-    case type_t::cc14bit:
-        //when nrpn/cc14bit is used, MIDI ID is split into two messages
-        //first message contains higher byte
+        midi.send((analogType == type_t::nrpn7b) ? MIDIOutput::message_t::nrpn7bit : MIDIOutput::message_t::nrpn14bit, channel, midiID, scaledMIDIvalue);
+#ifdef DISPLAY_SUPPORTED
+        display.displayMIDIevent(Display::eventType_t::out, Display::event_t::nrpn, midiID & 0x7F, scaledMIDIvalue, channel + 1);
+#endif
+        break;
 
+    case type_t::cc14bit:
+        //use 7-bit MIDI ID
         encDec_14bit.value = midiID;
         encDec_14bit.split14bit();
+        midiID = encDec_14bit.low;
 
-        if (analogType != type_t::cc14bit)
-        {
-            midi.sendControlChange(99, encDec_14bit.high, channel);
-            midi.sendControlChange(98, encDec_14bit.low, channel);
-        }
-
-        if (analogType == type_t::nrpn7b)
-        {
-            midi.sendControlChange(6, scaledMIDIvalue, channel);
-        }
-        else
-        {
-            midiID = encDec_14bit.low;
-
-            //send 14-bit value in another two messages
-            //first message contains higher byte
-            encDec_14bit.value = scaledMIDIvalue;
-            encDec_14bit.split14bit();
-
-            if (analogType == type_t::cc14bit)
-            {
-                if (midiID >= 96)
-                    break;    //not allowed
-
-                midi.sendControlChange(midiID, encDec_14bit.high, channel);
-                midi.sendControlChange(midiID + 32, encDec_14bit.low, channel);
-            }
-            else
-            {
-                midi.sendControlChange(6, encDec_14bit.high, channel);
-                midi.sendControlChange(38, encDec_14bit.low, channel);
-            }
-        }
+        if (midiID >= 96)
+            break;    //not allowed
 
+        midi.send(MIDIOutput::message_t::controlChange14bit, channel, midiID, scaledMIDIvalue);
 #ifdef DISPLAY_SUPPORTED
-        display.displayMIDIevent(Display::eventType_t::out, (analogType == type_t::cc14bit) ? Display::event_t::controlChange : Display::event_t::nrpn, midiID, scaledMIDIvalue, channel + 1);
+        display.displayMIDIevent(Display::eventType_t::out, Display::event_t::controlChange, midiID, scaledMIDIvalue, channel + 1);
 #endif
         break;
 
     case type_t::pitchBend:
-        midi.sendPitchBend(scaledMIDIvalue, channel);
+        midi.send(MIDIOutput::message_t::pitchBend, channel, 0, scaledMIDIvalue);
 #ifdef DISPLAY_SUPPORTED
         display.displayMIDIevent(Display::eventType_t::out, Display::event_t::pitchBend, midiID, scaledMIDIvalue, channel + 1);
 #endif
@@ -185,3 +148,101 @@ void Analog::checkPotentiometerValue(type_t analogType, uint8_t analogID, uint32
     //update values
     lastAnalogueValue[analogID] = value;
 }
+
+///
+/// \brief Converts raw ADC value to MIDI value in range 0 - maxValue.
+/// Equivalent to value * maxValue / ADC_MAX_VALUE. Since ADC_MAX_VALUE is 2^n - 1,
+/// division is replaced with a sum of shifted products which gives exactly the same result.
+///
+uint16_t Analog::adcToMIDI(uint32_t value, uint16_t maxValue)
+{
+    uint32_t product = value * maxValue;
+    return (product + (product >> ADC_RESOLUTION) + (product >> (2 * ADC_RESOLUTION)) + 1) >> ADC_RESOLUTION;
+}
+
+///
+/// \brief Reads limits, inversion and curve for specified analog component from database and
+/// precomputes the values used to scale MIDI value.
+/// @param [in] analogID    Index of analog component.
+/// @param [in] use14bit    Set to true if the component sends 14-bit MIDI values.
+///
+void Analog::compileScaler(uint8_t analogID, bool use14bit)
+{
+    uint16_t             maxLimit   = use14bit ? MIDI_14_BIT_VALUE_MAX : MIDI_7_BIT_VALUE_MAX;
+    uint16_t             lowerLimit = database.read(Database::Section::analog_t::lowerLimit, analogID);
+    uint16_t             upperLimit = database.read(Database::Section::analog_t::upperLimit, analogID);
+    bool                 invert     = database.read(Database::Section::analog_t::invert, analogID);
+    MIDI::encDec_14bit_t encDec_14bit;
+
+    if (!use14bit)
+    {
+        //use 7-bit limits
+        encDec_14bit.value = lowerLimit;
+        encDec_14bit.split14bit();
+        lowerLimit = encDec_14bit.low;
+
+        encDec_14bit.value = upperLimit;
+        encDec_14bit.split14bit();
+        upperLimit = encDec_14bit.low;
+    }
+
+    auto&    scaler     = componentState[analogID].scaler;
+    bool     descending = upperLimit < lowerLimit;
+    uint16_t range      = descending ? lowerLimit - upperLimit : upperLimit - lowerLimit;
+
+    //gain is rounded up so that maximum value always results in upper limit
+    scaler.gain     = ((static_cast<uint32_t>(range) << ANALOG_SCALE_SHIFT) + maxLimit - 1) / maxLimit;
+    scaler.offset   = invert ? maxLimit - lowerLimit : lowerLimit;
+    scaler.subtract = invert != descending;
+    scaler.curve    = static_cast<curve_t>(database.read(Database::Section::analog_t::curve, analogID));
+
+    if (scaler.curve == curve_t::custom)
+    {
+        for (int i = 0; i < ANALOG_CURVE_POINTS; i++)
+            userCurve[i] = database.read(Database::Section::analog_t::userCurve, i);
+    }
+}
+
+///
+/// \brief Applies response curve, limits and inversion to full-range MIDI value.
+/// @param [in] analogID    Index of analog component.
+/// @param [in] value       MIDI value in range 0 - 127 or 0 - 16383.
+/// @param [in] use14bit    Set to true if the value is 14-bit.
+/// \returns Value which should be sent.
+///
+uint16_t Analog::scaleValue(uint8_t analogID, uint16_t value, bool use14bit)
+{
+    auto& scaler = componentState[analogID].scaler;
+
+    if (scaler.curve != curve_t::linear)
+        value = applyCurve(scaler.curve, value, use14bit);
+
+    uint16_t scaled = (static_cast<uint32_t>(value) * scaler.gain) >> ANALOG_SCALE_SHIFT;
+
+    return scaler.subtract ? scaler.offset - scaled : scaler.offset + scaled;
+}
+
+///
+/// \brief Maps MIDI value over specified response curve using linear interpolation between curve points.
+/// @param [in] curve       Response curve to use.
+/// @param [in] value       MIDI value in range 0 - 127 or 0 - 16383.
+/// @param [in] use14bit    Set to true if the value is 14-bit.
+/// \returns Value in the same range as the input value.
+///
+uint16_t Analog::applyCurve(curve_t curve, uint16_t value, bool use14bit)
+{
+    uint8_t bits         = use14bit ? 14 : 7;
+    uint8_t segmentShift = bits - ANALOG_CURVE_SEGMENT_BITS;
+
+    //stretch the range from 0 - (2^bits - 1) to 0 - 2^bits so that
+    //segment index and position inside the segment are obtained by shifting only
+    uint16_t position = value + (value >> (bits - 1));
+    uint8_t  segment  = position >> segmentShift;
+    uint16_t fraction = position & ((1 << segmentShift) - 1);
+    int32_t  start    = curvePoint(curve, segment);
+
+    if (segment < ANALOG_CURVE_SEGMENTS)
+        start += ((static_cast<int32_t>(curvePoint(curve, segment + 1)) - start) * fraction) >> segmentShift;
+
+    return start >> (14 - bits);
+}
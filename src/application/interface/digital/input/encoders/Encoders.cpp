@@ -103,8 +103,6 @@ void Encoders::update()
             uint8_t  steps        = (encoderSpeed[i] > 0) ? encoderSpeed[i] : 1;
             bool     use14bit     = false;
 
-            MIDI::encDec_14bit_t encDec_14bit;
-
             switch (type)
             {
             case type_t::t7Fh01h:
@@ -171,59 +169,46 @@ void Encoders::update()
             {
                 if (type == type_t::tProgramChange)
                 {
-                    midi.sendProgramChange(encoderValue, channel);
+                    midi.send(MIDIOutput::message_t::programChange, channel, 0, encoderValue);
 #ifdef DISPLAY_SUPPORTED
                     display.displayMIDIevent(Display::eventType_t::out, Display::event_t::programChange, midiID & 0x7F, encoderValue, channel + 1);
 #endif
                 }
                 else if (type == type_t::tPitchBend)
                 {
-                    midi.sendPitchBend(encoderValue, channel);
+                    midi.send(MIDIOutput::message_t::pitchBend, channel, 0, encoderValue);
 #ifdef DISPLAY_SUPPORTED
                     display.displayMIDIevent(Display::eventType_t::out, Display::event_t::pitchBend, midiID & 0x7F, encoderValue, channel + 1);
 #endif
                 }
-                else if ((type == type_t::tNRPN7bit) || (type == type_t::tNRPN14bit) || (type == type_t::tControlChange14bit))
+                else if ((type == type_t::tNRPN7bit) || (type == type_t::tNRPN14bit))
+                {
+                    midi.send((type == type_t::tNRPN7bit) ? MIDIOutput::message_t::nrpn7bit : MIDIOutput::message_t::nrpn14bit, channel, midiID, encoderValue);
+#ifdef DISPLAY_SUPPORTED
+                    display.displayMIDIevent(Display::eventType_t::out, Display::event_t::nrpn, midiID & 0x7F, encoderValue, channel + 1);
+#endif
+                }
+                else if (type == type_t::tControlChange14bit)
                 {
-                    encDec_14bit.value = midiID;
-                    encDec_14bit.split14bit();
-
-                    midi.sendControlChange(99, encDec_14bit.high, channel);
-                    midi.sendControlChange(98, encDec_14bit.low, channel);
-
-                    if (type == type_t::tNRPN7bit)
-                    {
-                        midi.sendControlChange(6, encoderValue, channel);
-                    }
-                    else
-                    {
-                        midiID = encDec_14bit.low;
-
-                        encDec_14bit.value = encoderValue;
-                        encDec_14bit.split14bit();
-
-                        if (type == type_t::tControlChange14bit)
-                        {
-                            if (midiID >= 96)
-                                break;    //not allowed
-
-                            midi.sendControlChange(midiID, encDec_14bit.high, channel);
-                            midi.sendControlChange(midiID + 32, encDec_14bit.low, channel);
-                        }
-                        else
-                        {
-                            midi.sendControlChange(6, encDec_14bit.high, channel);
-                            midi.sendControlChange(38, encDec_14bit.low, channel);
-                        }
-                    }
+                    if ((midiID & 0x7F) >= 96)
+                        break;    //not allowed
 
+                    midi.send(MIDIOutput::message_t::controlChange14bit, channel, midiID & 0x7F, encoderValue);
 #ifdef DISPLAY_SUPPORTED
-                    display.displayMIDIevent(Display::eventType_t::out, (type == type_t::tControlChange14bit) ? Display::event_t::controlChange : Display::event_t::nrpn, midiID, encoderValue, channel + 1);
+                    display.displayMIDIevent(Display::eventType_t::out, Display::event_t::controlChange, midiID & 0x7F, encoderValue, channel + 1);
+#endif
+                }
+                else if ((type == type_t::t7Fh01h) || (type == type_t::t3Fh41h))
+                {
+                    //each message is a single step - don't coalesce them
+                    midi.sendControlChangeRelative(midiID, encoderValue, channel);
+#ifdef DISPLAY_SUPPORTED
+                    display.displayMIDIevent(Display::eventType_t::out, Display::event_t::controlChange, midiID & 0x7F, encoderValue, channel + 1);
 #endif
                 }
                 else if (type != type_t::tPresetChange)
                 {
-                    midi.sendControlChange(midiID, encoderValue, channel);
+                    midi.send(MIDIOutput::message_t::controlChange, channel, midiID, encoderValue);
 #ifdef DISPLAY_SUPPORTED
                     display.displayMIDIevent(Display::eventType_t::out, Display::event_t::controlChange, midiID & 0x7F, encoderValue, channel + 1);
 #endif
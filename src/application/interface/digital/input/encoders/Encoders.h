@@ -29,6 +29,7 @@ limitations under the License.
 #include "Constants.h"
 #include "interface/digital/input/Common.h"
 #include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
 
 namespace Interface
 {
@@ -46,10 +47,10 @@ namespace Interface
             {
                 public:
 #ifdef DISPLAY_SUPPORTED
-                Encoders(Database& database, MIDI& midi, Display& display, ComponentInfo& cInfo)
+                Encoders(Database& database, MIDIOutput& midi, Display& display, ComponentInfo& cInfo)
                     :
 #else
-                Encoders(Database& database, MIDI& midi, ComponentInfo& cInfo)
+                Encoders(Database& database, MIDIOutput& midi, ComponentInfo& cInfo)
                     :
 #endif
                     database(database)
@@ -88,8 +89,8 @@ namespace Interface
                 position_t read(uint8_t encoderID, uint8_t pairState);
 
                 private:
-                Database& database;
-                MIDI&     midi;
+                Database&   database;
+                MIDIOutput& midi;
 #ifdef DISPLAY_SUPPORTED
                 Display& display;
 #endif
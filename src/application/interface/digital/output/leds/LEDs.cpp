@@ -79,16 +79,21 @@ void LEDs::checkBlinking(bool forceChange)
         blinkState[i]   = !blinkState[i];
         blinkCounter[i] = 0;
 
+        //leds which don't blink aren't kept in any group
+        if (i == static_cast<uint8_t>(blinkSpeed_t::noBlink))
+            continue;
+
         //assign changed state to all leds which have this speed
-        for (int j = 0; j < MAX_NUMBER_OF_LEDS; j++)
+        for (int j = 0; j < LED_BIT_ARRAY_SIZE; j++)
         {
-            if (!getState(j, ledBit_t::blinkOn))
-                continue;
-
-            if (blinkTimer[j] != i)
-                continue;
+            //groups of eight leds which don't blink with this speed are skipped at once
+            uint8_t group = blinkGroup[i - 1][j];
 
-            updateState(j, ledBit_t::state, blinkState[i]);
+            for (int bit = 0; group; bit++, group >>= 1)
+            {
+                if (group & 0x01)
+                    updateState(j * 8 + bit, ledBit_t::state, blinkState[i]);
+            }
         }
     }
 }
@@ -159,8 +164,9 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
         if (database.read(Database::Section::leds_t::midiChannel, i) != channel)
             continue;
 
-        bool setState = false;
-        bool setBlink = false;
+        bool setState      = false;
+        bool setBlink      = false;
+        bool setBrightness = false;
 
         auto controlType = static_cast<controlType_t>(database.read(Database::Section::leds_t::controlType, i));
 
@@ -203,6 +209,22 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
                 }
                 break;
 
+            case controlType_t::midiInNoteForStateAndBrightness:
+                if ((messageType == MIDI::messageType_t::noteOn) || (messageType == MIDI::messageType_t::noteOff))
+                {
+                    setState      = true;
+                    setBrightness = true;
+                }
+                break;
+
+            case controlType_t::midiInCCforStateAndBrightness:
+                if (messageType == MIDI::messageType_t::controlChange)
+                {
+                    setState      = true;
+                    setBrightness = true;
+                }
+                break;
+
             default:
                 break;
             }
@@ -241,6 +263,22 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
                 }
                 break;
 
+            case controlType_t::midiInNoteForStateAndBrightness:
+                if ((messageType == MIDI::messageType_t::noteOn) || (messageType == MIDI::messageType_t::noteOff))
+                {
+                    setState      = true;
+                    setBrightness = true;
+                }
+                break;
+
+            case controlType_t::midiInCCforStateAndBrightness:
+                if (messageType == MIDI::messageType_t::controlChange)
+                {
+                    setState      = true;
+                    setBrightness = true;
+                }
+                break;
+
             //set state for program change control type regardless of local/midi in setting
             case controlType_t::midiInPCforStateNoBlink:
             case controlType_t::localPCforStateNoBlink:
@@ -253,8 +291,9 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
             }
         }
 
-        auto color      = color_t::off;
-        bool rgbEnabled = database.read(Database::Section::leds_t::rgbEnable, Board::io::getRGBID(i));
+        auto    color      = color_t::off;
+        uint8_t brightness = 127;
+        bool    rgbEnabled = database.read(Database::Section::leds_t::rgbEnable, Board::io::getRGBID(i));
 
         if (setState)
         {
@@ -271,6 +310,15 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
                     else
                         color = color_t::red;    //any color is fine on single-color led
                 }
+                else if (setBrightness)
+                {
+                    //data2 value (note velocity / cc value) sets the brightness, 0 turns the led off
+                    //rgb led uses all of its components
+                    if (data2)
+                        color = rgbEnabled ? color_t::white : color_t::red;
+
+                    brightness = data2;
+                }
                 else
                 {
                     //use data2 value (note velocity / cc value) to set led color
@@ -282,7 +330,7 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
                         color = (database.read(Database::Section::leds_t::activationValue, i) == data2) ? color_t::red : color_t::off;
                 }
 
-                setColor(i, color);
+                setColor(i, color, brightness);
             }
             else if (messageType == MIDI::messageType_t::programChange)
             {
@@ -327,6 +375,33 @@ void LEDs::midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t d
     }
 }
 
+void LEDs::setStates(size_t startID, const uint8_t* states, size_t size)
+{
+    /*
+        State byte:
+        bits 0-2    color
+        bits 3-6    blink speed index (0 = no blink)
+    */
+
+    for (size_t i = 0; i < size; i++)
+    {
+        size_t ledID = startID + i;
+
+        if (ledID >= MAX_NUMBER_OF_LEDS)
+            break;
+
+        auto    color      = static_cast<color_t>(states[i] & 0x07);
+        uint8_t blinkSpeed = (states[i] >> 3) & 0x0F;
+
+        //invalid speed and turned off led disable blinking
+        if ((blinkSpeed >= static_cast<uint8_t>(blinkSpeed_t::AMOUNT)) || !static_cast<bool>(color))
+            blinkSpeed = static_cast<uint8_t>(blinkSpeed_t::noBlink);
+
+        setColor(ledID, color);
+        setBlinkState(ledID, static_cast<blinkSpeed_t>(blinkSpeed));
+    }
+}
+
 void LEDs::setBlinkState(uint8_t ledID, blinkSpeed_t state)
 {
     uint8_t ledArray[3], leds = 0;
@@ -363,7 +438,7 @@ void LEDs::setBlinkState(uint8_t ledID, blinkSpeed_t state)
             updateState(ledArray[i], ledBit_t::state, getState(ledArray[i], ledBit_t::active));
         }
 
-        blinkTimer[ledID] = static_cast<uint8_t>(state);
+        setBlinkGroup(ledArray[i], state);
     }
 }
 
@@ -381,7 +456,7 @@ void LEDs::setAllOff()
         resetState(i);
 }
 
-void LEDs::setColor(uint8_t ledID, color_t color)
+void LEDs::setColor(uint8_t ledID, color_t color, uint8_t brightness)
 {
     uint8_t rgbIndex = Board::io::getRGBID(ledID);
 
@@ -393,12 +468,17 @@ void LEDs::setColor(uint8_t ledID, color_t color)
         uint8_t gLED = Board::io::getRGBaddress(rgbIndex, rgbIndex_t::g);
         uint8_t bLED = Board::io::getRGBaddress(rgbIndex, rgbIndex_t::b);
 
+        Board::io::setLEDbrightness(rLED, brightness);
+        Board::io::setLEDbrightness(gLED, brightness);
+        Board::io::setLEDbrightness(bLED, brightness);
+
         handleLED(rLED, BIT_READ(static_cast<bool>(color), static_cast<uint8_t>(rgbIndex_t::r)), true, rgbIndex_t::r);
         handleLED(gLED, BIT_READ(static_cast<bool>(color), static_cast<uint8_t>(rgbIndex_t::g)), true, rgbIndex_t::g);
         handleLED(bLED, BIT_READ(static_cast<bool>(color), static_cast<uint8_t>(rgbIndex_t::b)), true, rgbIndex_t::b);
     }
     else
     {
+        Board::io::setLEDbrightness(ledID, brightness);
         handleLED(ledID, (bool)color, false);
     }
 }
@@ -529,6 +609,16 @@ void LEDs::updateState(uint8_t index, ledBit_t bit, bool state, bool setOnBoard)
         Board::io::writeLEDstate(index, LED_ON(ledState[index]));
 }
 
+void LEDs::setBlinkGroup(uint8_t index, blinkSpeed_t speed)
+{
+    //led blinks with single speed only
+    for (int i = 0; i < static_cast<uint8_t>(blinkSpeed_t::AMOUNT) - 1; i++)
+        BIT_CLEAR(blinkGroup[i][index / 8], index % 8);
+
+    if (speed != blinkSpeed_t::noBlink)
+        BIT_SET(blinkGroup[static_cast<uint8_t>(speed) - 1][index / 8], index % 8);
+}
+
 bool LEDs::getState(uint8_t index, ledBit_t bit)
 {
     return BIT_READ(ledState[index], static_cast<uint8_t>(bit));
@@ -537,6 +627,8 @@ bool LEDs::getState(uint8_t index, ledBit_t bit)
 void LEDs::resetState(uint8_t index)
 {
     ledState[index] = 0;
+    setBlinkGroup(index, blinkSpeed_t::noBlink);
+
     //we have just cleared all the bits - the state to write is off
     Board::io::writeLEDstate(index, false);
 }
@@ -21,6 +21,11 @@ limitations under the License.
 #include "database/Database.h"
 #include "midi/src/MIDI.h"
 
+///
+/// \brief Size of array holding one bit for each LED.
+///
+#define LED_BIT_ARRAY_SIZE ((MAX_NUMBER_OF_LEDS + 7) / 8)
+
 namespace Interface
 {
     namespace digital
@@ -80,6 +85,8 @@ namespace Interface
                     localNoteForStateAndBlink,
                     midiInCCforStateAndBlink,
                     localCCforStateAndBlink,
+                    midiInNoteForStateAndBrightness,
+                    midiInCCforStateAndBrightness,
                     AMOUNT
                 };
 
@@ -109,12 +116,13 @@ namespace Interface
                 void        checkBlinking(bool forceChange = false);
                 void        setAllOn();
                 void        setAllOff();
-                void        setColor(uint8_t ledID, color_t color);
+                void        setColor(uint8_t ledID, color_t color, uint8_t brightness = 127);
                 color_t     getColor(uint8_t ledID);
                 void        setBlinkState(uint8_t ledID, blinkSpeed_t value);
                 bool        getBlinkState(uint8_t ledID);
                 bool        setFadeTime(uint8_t transitionSpeed);
                 void        midiToState(MIDI::messageType_t messageType, uint8_t data1, uint8_t data2, uint8_t channel, bool local);
+                void        setStates(size_t startID, const uint8_t* states, size_t size);
                 void        setBlinkType(blinkType_t blinkType);
                 blinkType_t getBlinkType();
                 void        resetBlinking();
@@ -132,6 +140,7 @@ namespace Interface
                 };
 
                 void         updateState(uint8_t index, ledBit_t bit, bool state, bool setOnBoard = true);
+                void         setBlinkGroup(uint8_t index, blinkSpeed_t speed);
                 bool         getState(uint8_t index, ledBit_t bit);
                 void         resetState(uint8_t index);
                 color_t      valueToColor(uint8_t receivedVelocity);
@@ -147,9 +156,11 @@ namespace Interface
                 uint8_t ledState[MAX_NUMBER_OF_LEDS];
 
                 ///
-                /// \brief Array holding time after which LEDs should blink.
+                /// \brief Array holding LEDs which blink with specific speed, one bit per LED.
+                /// Used so that only the LEDs with blink speed which changes state are updated.
+                /// There is no group for noBlink speed, so the group for each speed is at index speed - 1.
                 ///
-                uint8_t blinkTimer[MAX_NUMBER_OF_LEDS] = {};
+                uint8_t blinkGroup[static_cast<uint8_t>(blinkSpeed_t::AMOUNT) - 1][LED_BIT_ARRAY_SIZE] = {};
 
                 ///
                 /// \brief Holds currently active LED blink type.
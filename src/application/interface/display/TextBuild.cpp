@@ -189,6 +189,16 @@ void Display::displayMIDIevent(eventType_t type, event_t event, uint16_t byte1,
         break;
 
     case event_t::sysRealTimeClock:
+        //byte1 holds the tempo of received clock if it's known
+        if (byte1)
+            stringBuilder.overwrite("%d BPM", byte1);
+        else
+            stringBuilder.overwrite("");
+
+        stringBuilder.fillUntil(U8X8::getColumns() - strlen(stringBuilder.string()));
+        updateText(startRow + 1, lcdTextType_t::still, 0);
+        break;
+
     case event_t::sysRealTimeStart:
     case event_t::sysRealTimeContinue:
     case event_t::sysRealTimeStop:
@@ -63,6 +63,14 @@ namespace Board
     ///
     void reboot(rebootType_t type);
 
+    ///
+    /// \brief Returns the time elapsed since the board has been started in microseconds.
+    /// Unlike core::timing::currentRunTimeMs, the counter of main timer is read as well, so the
+    /// returned value can be used to measure the intervals shorter than a millisecond.
+    /// Value overflows approximately every 71 minutes.
+    ///
+    uint32_t runTimeUs();
+
     ///
     /// \brief Checks if firmware has been updated.
     /// Firmware file has written CRC in last two flash addresses. Application stores last read CRC in EEPROM.
@@ -80,12 +88,58 @@ namespace Board
         ///
         bool readMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket);
 
+        ///
+        /// \brief Used to access received USB MIDI packets without copying them.
+        /// Packets stay available until they are released using releaseMIDI.
+        /// @param [in,out] packets  Reference to pointer which is set to first available packet.
+        /// \returns Number of packets which can be read in one go, 0 if no packets are available.
+        ///
+        size_t peekMIDI(MIDI::USBMIDIpacket_t*& packets);
+
+        ///
+        /// \brief Marks specified number of packets retrieved using peekMIDI as processed.
+        /// @param [in] count   Number of processed packets.
+        ///
+        void releaseMIDI(size_t count);
+
         ///
         /// \brief Used to write MIDI data to USB interface.
         /// @param [in] USBMIDIpacket   Pointer to structure holding MIDI data to write.
         /// \returns True if data is available, false otherwise.
         ///
         bool writeMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket);
+
+        ///
+        /// \brief Sends all the MIDI data written using writeMIDI which hasn't been sent yet.
+        /// Written data is sent to host once the endpoint buffer is full or once this function is called,
+        /// so it should be called after each pass through the main loop.
+        ///
+        void flushMIDI();
+
+        ///
+        /// \brief Checks if the device is connected to host and configured.
+        /// \returns True if the device is ready for MIDI communication, false otherwise.
+        ///
+        bool isConfigured();
+
+#ifdef USB_UMP_SUPPORTED
+        ///
+        /// \brief Checks if the host has selected USB MIDI 2.0 alternate setting.
+        /// In that case, data is exchanged using Universal MIDI Packets (UMP) instead of USB MIDI packets.
+        /// Incoming UMP words can be read using readMIDI - each packet then holds single 32-bit word.
+        /// \returns True if UMP is used, false otherwise.
+        ///
+        bool isUMPenabled();
+
+        ///
+        /// \brief Used to write single Universal MIDI Packet to USB interface.
+        /// Message is either written as a whole or not at all.
+        /// @param [in] words   Pointer to array holding all the 32-bit words of the message.
+        /// @param [in] count   Number of words in the message.
+        /// \returns True if the message has been written, false otherwise.
+        ///
+        bool writeUMP(const uint32_t* words, uint8_t count);
+#endif
     }    // namespace USB
 
     namespace UART
@@ -134,6 +188,36 @@ namespace Board
         /// \returns True if there is no more data to transmit, false otherwise.
         ///
         bool isTxEmpty(uint8_t channel);
+
+        ///
+        /// \brief Checks how many bytes can be written to specified UART channel without waiting.
+        /// @param [in] channel UART channel on MCU.
+        /// \returns Number of free bytes in TX buffer.
+        ///
+        size_t txSpace(uint8_t channel);
+
+        ///
+        /// \brief Checks how many bytes are waiting to be sent on specified UART channel.
+        /// @param [in] channel UART channel on MCU.
+        /// \returns Number of bytes in TX buffer.
+        ///
+        size_t txPending(uint8_t channel);
+
+        ///
+        /// \brief Checks how many received bytes are waiting to be read on specified UART channel.
+        /// @param [in] channel UART channel on MCU.
+        /// \returns Number of bytes in RX buffer.
+        ///
+        size_t rxPending(uint8_t channel);
+
+        ///
+        /// \brief Checks how many received bytes have been dropped on specified UART channel because RX buffer was full.
+        /// Bytes lost by the UART peripheral or by DMA reception on boards which use it are counted as well.
+        /// Counter is cleared after each call.
+        /// @param [in] channel UART channel on MCU.
+        /// \returns Number of dropped bytes since the last call.
+        ///
+        size_t rxDropped(uint8_t channel);
     }    // namespace UART
 
     namespace io
@@ -204,6 +288,14 @@ namespace Board
         ///             See board/common/constants/IO.h for range.
         ///
         bool setLEDfadeSpeed(uint8_t transitionSpeed);
+
+        ///
+        /// \brief Sets the brightness of LED while it's on.
+        /// Has effect only on boards which define LED_BRIGHTNESS_BITS, on other boards LEDs are always fully lit.
+        /// @param [in] ledID       LED for which to change brightness.
+        /// @param [in] brightness  Brightness in range 0-127, where 127 is full brightness.
+        ///
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness);
 #endif
 
         ///
@@ -224,6 +316,46 @@ namespace Board
         ///
         int16_t getAnalogValue(uint8_t analogID);
 
+        ///
+        /// \brief Checks which analog indexes have changed their value since the last call.
+        /// Should be called only once analog data is available.
+        /// @param[in] group    Group of eight analog indexes, ie. group 1 covers indexes 8-15.
+        /// \returns Bitmask in which each set bit represents changed analog index within the group.
+        ///
+        uint8_t getAnalogChangeMask(uint8_t group);
+
+        ///
+        /// \brief Places analog index in or out of fast lane.
+        /// Analog indexes in fast lane are sampled ANALOG_FAST_LANE_VISITS times during
+        /// single scan and the highest sampled value is stored. Changes are applied once
+        /// the current scan is done.
+        /// @param[in] analogID     Analog index.
+        /// @param[in] state        True to place the index in fast lane, false otherwise.
+        /// \returns False if fast lane is already full, true otherwise.
+        ///
+        bool setAnalogFastLane(uint8_t analogID, bool state);
+
+        ///
+        /// \brief Sets the minimum difference between sampled and stored value needed
+        /// to mark analog index as changed.
+        /// Used to ignore ADC noise on inputs which aren't moving. Values at either end
+        /// of ADC range are always stored.
+        /// @param[in] analogID     Analog index.
+        /// @param[in] threshold    Minimum difference. Values 0 and 1 mark index as changed on any difference.
+        ///
+        void setAnalogChangeThreshold(uint8_t analogID, uint8_t threshold);
+
+        ///
+        /// \brief Enables or disables burst capture on specified analog index.
+        /// Once the sampled value on analog index with burst capture enabled reaches
+        /// ANALOG_BURST_THRESHOLD, the same input is sampled ANALOG_BURST_SAMPLES times
+        /// in a row and the highest sampled value is stored. Burst capture is started
+        /// again only after the value drops below the threshold.
+        /// @param[in] analogID     Analog index.
+        /// @param[in] state        True to enable burst capture, false otherwise.
+        ///
+        void setAnalogBurst(uint8_t analogID, bool state);
+
         ///
         /// \brief Resets the analog sampling procedure.
         ///
@@ -136,6 +136,14 @@ namespace Board
             ///
             void storeIncomingData(uint8_t channel, uint8_t data);
 
+            ///
+            /// \brief Used to indicate that received data has been lost before reaching the RX buffer.
+            /// Lost data is counted together with the data which didn't fit in RX buffer.
+            /// @param [in] channel UART channel on MCU.
+            /// @param [in] count   Number of lost bytes.
+            ///
+            void indicateRxDropped(uint8_t channel, size_t count);
+
             ///
             /// \brief Retrieves the next byte from the outgoing ring buffer.
             /// @param [in] channel UART channel on MCU.
@@ -143,6 +151,15 @@ namespace Board
             ///
             bool getNextByteToSend(uint8_t channel, uint8_t& data);
 
+            ///
+            /// \brief Retrieves as many bytes from the outgoing ring buffer as will fit into provided buffer.
+            /// @param [in] channel UART channel on MCU.
+            /// @param [in] buffer  Buffer in which retrieved data is stored.
+            /// @param [in] maxSize Size of provided buffer.
+            /// \returns Number of retrieved bytes.
+            ///
+            size_t getNextBlockToSend(uint8_t channel, uint8_t* buffer, size_t maxSize);
+
             ///
             /// \brief Used to indicate that the transmission is complete.
             /// @param [in] channel UART channel on MCU.
@@ -193,6 +210,26 @@ namespace Board
             ///
             USART_TypeDef* uartInterface(uint8_t channel);
 
+#ifdef UART_DMA_SUPPORTED
+            ///
+            /// \brief Structure holding DMA streams and channels used by single UART channel.
+            ///
+            typedef struct
+            {
+                DMA_Stream_TypeDef* rxStream;
+                uint32_t            rxChannel;
+                IRQn_Type           rxIRQn;
+                DMA_Stream_TypeDef* txStream;
+                uint32_t            txChannel;
+                IRQn_Type           txIRQn;
+            } uartDMA_t;
+
+            ///
+            /// \brief Used to retrieve DMA streams used for a given UART channel index.
+            ///
+            const uartDMA_t& uartDMA(uint8_t channel);
+#endif
+
             ///
             /// \brief Used to retrieve timer instance used for main timer interrupt.
             ///
@@ -254,6 +291,14 @@ namespace Board
             ///
             void uart(uint8_t channel);
 
+#ifdef UART_DMA_SUPPORTED
+            ///
+            /// \brief Global ISR handler for DMA events on streams used by UART.
+            /// @param [in] channel UART channel on MCU.
+            ///
+            void uartDMA(uint8_t channel);
+#endif
+
             ///
             /// \brief Called in ADC ISR once the conversion is done.
             /// @param [in] adcValue    Retrieved ADC value.
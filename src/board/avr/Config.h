@@ -42,6 +42,13 @@ limitations under the License.
 ///
 #define ANALOG_STEP_MIN_DIFF_14_BIT 1
 
+///
+/// \brief Minimum difference between two raw ADC readings needed to mark analog input as changed.
+/// Used on inputs which produce 7-bit MIDI values so that ADC noise on inputs which aren't
+/// moving doesn't cause their processing on each scan.
+///
+#define ANALOG_CHANGE_THRESHOLD 3
+
 ///
 /// \brief Minimum raw ADC reading for FSR sensors.
 ///
@@ -67,11 +74,30 @@ limitations under the License.
 ///
 #define ADC_MAX_VALUE 1023
 
+///
+/// \brief ADC resolution in bits.
+/// Maximum raw ADC value must be equal to (1 << ADC_RESOLUTION) - 1 since the
+/// conversion from raw ADC value to MIDI value relies on it.
+///
+#define ADC_RESOLUTION 10
+
 ///
 /// \brief Defines how many analog samples from the same input will be thrown away before storing the read value.
 ///
 #define ADC_IGNORED_SAMPLES_COUNT 3
 
+///
+/// \brief Number of samples taken from single analog input during burst capture.
+/// Burst capture is started on analog inputs with burst capture enabled once the sampled
+/// value reaches ANALOG_BURST_THRESHOLD.
+///
+#define ANALOG_BURST_SAMPLES 16
+
+///
+/// \brief Minimum raw ADC value which starts burst capture.
+///
+#define ANALOG_BURST_THRESHOLD 32
+
 ///
 /// \brief Location at which reboot type is written in EEPROM when initiating software reset.
 /// See Reboot.h
@@ -92,4 +118,16 @@ limitations under the License.
 ///
 /// \brief Location at which reboot type is written in EEPROM when initiating software reset.
 ///
-#define REBOOT_VALUE_EEPROM_LOCATION (EEPROM_SIZE - 1)
\ No newline at end of file
+#define REBOOT_VALUE_EEPROM_LOCATION (EEPROM_SIZE - 1)
+
+///
+/// \brief Number of USB MIDI packets which can wait for space in outgoing USB buffers.
+/// Only the packets which can't be dropped wait here, ie. note and system exclusive messages.
+///
+#define MIDI_SCHEDULER_USB_RETRY_SIZE 8
+
+///
+/// \brief Number of bytes which can wait for space in outgoing DIN MIDI buffer.
+/// Only the messages which can't be dropped wait here, ie. note, real-time and system exclusive messages.
+///
+#define MIDI_SCHEDULER_DIN_RETRY_SIZE 16
\ No newline at end of file
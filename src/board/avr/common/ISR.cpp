@@ -19,6 +19,15 @@ limitations under the License.
 #include "board/Board.h"
 #include "board/Internal.h"
 #include "core/src/general/Timing.h"
+#include "core/src/general/Atomic.h"
+
+namespace
+{
+    ///
+    /// \brief Toggled on each main timer interrupt. Set to true once the current millisecond is complete.
+    ///
+    volatile bool _1ms = true;
+}    // namespace
 
 #ifdef FW_APP
 #ifdef ADC
@@ -38,8 +47,6 @@ ISR(ADC_vect)
 ///
 ISR(TIMER0_COMPA_vect)
 {
-    static bool _1ms = true;
-
     _1ms = !_1ms;
 
     if (_1ms)
@@ -48,7 +55,7 @@ ISR(TIMER0_COMPA_vect)
 
 #ifdef FW_APP
 #ifndef USB_LINK_MCU
-#ifdef LEDS_SUPPORTED
+#if defined(LEDS_SUPPORTED) && !defined(LED_BRIGHTNESS_BITS)
         Board::detail::io::checkDigitalOutputs();
 #endif
 #endif
@@ -60,7 +67,35 @@ ISR(TIMER0_COMPA_vect)
 
 #ifdef FW_APP
 #ifndef USB_LINK_MCU
+#ifdef LED_BRIGHTNESS_BITS
+    //binary code modulation uses shortest possible time slices to avoid visible flicker
+    Board::detail::io::checkDigitalOutputs();
+#endif
     Board::detail::io::checkDigitalInputs();
 #endif
 #endif
 }
+
+uint32_t Board::runTimeUs()
+{
+    uint32_t ms;
+    uint16_t ticks;
+    bool     secondHalf;
+
+    ATOMIC_SECTION
+    {
+        ms         = core::timing::detail::rTime_ms;
+        ticks      = TCNT0;
+        secondHalf = !_1ms;
+
+        //counter has already been cleared but the interrupt hasn't been handled yet
+        if ((TIFR0 & (1 << OCF0A)) && (ticks < OCR0A))
+            ticks += OCR0A + 1;
+
+        if (secondHalf)
+            ticks += OCR0A + 1;
+    }
+
+    //main timer runs with prescaler 64
+    return (ms * 1000) + ((static_cast<uint32_t>(ticks) * 64) / (F_CPU / 1000000UL));
+}
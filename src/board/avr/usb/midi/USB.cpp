@@ -27,6 +27,40 @@ namespace
     /// \brief MIDI Class Device Mode Configuration and State Structure.
     ///
     USB_ClassInfo_MIDI_Device_t MIDI_Interface;
+
+    ///
+    /// \brief Holds packet read from the endpoint which hasn't been released yet.
+    /// Packets are read from the endpoint one by one so that no additional RAM is used.
+    ///
+    MIDI::USBMIDIpacket_t rxPacket;
+    bool                  rxPacketPending;
+
+    bool readPacket(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+    {
+        //device must be connected and configured for the task to run
+        if (USB_DeviceState != DEVICE_STATE_Configured)
+            return false;
+
+        //select the MIDI OUT stream
+        Endpoint_SelectEndpoint(MIDI_STREAM_OUT_EPADDR);
+
+        //check if a MIDI command has been received
+        if (Endpoint_IsOUTReceived())
+        {
+            //read the MIDI event packet from the endpoint
+            Endpoint_Read_Stream_LE(&USBMIDIpacket, sizeof(USBMIDIpacket), NULL);
+
+            //if the endpoint is now empty, clear the bank
+            if (!(Endpoint_BytesInEndpoint()))
+                Endpoint_ClearOUT();    //clear the endpoint ready for new packet
+
+            return true;
+        }
+        else
+        {
+            return false;
+        }
+    }
 }    // namespace
 
 ///
@@ -37,8 +71,8 @@ namespace
 extern "C" void EVENT_USB_Device_ConfigurationChanged(void)
 {
     /* Setup MIDI Data Endpoints */
-    Endpoint_ConfigureEndpoint(MIDI_STREAM_IN_EPADDR, EP_TYPE_BULK, MIDI_STREAM_EPSIZE, 1);
-    Endpoint_ConfigureEndpoint(MIDI_STREAM_OUT_EPADDR, EP_TYPE_BULK, MIDI_STREAM_EPSIZE, 1);
+    Endpoint_ConfigureEndpoint(MIDI_STREAM_IN_EPADDR, EP_TYPE_BULK, MIDI_STREAM_EPSIZE, USB_MIDI_ENDPOINT_BANKS);
+    Endpoint_ConfigureEndpoint(MIDI_STREAM_OUT_EPADDR, EP_TYPE_BULK, MIDI_STREAM_EPSIZE, USB_MIDI_ENDPOINT_BANKS);
 }
 
 /** This function is called by the library when in device mode, and must be overridden (see library "USB Descriptors"
@@ -97,11 +131,11 @@ namespace Board
 
                 MIDI_Interface.Config.DataINEndpoint.Address = MIDI_STREAM_IN_EPADDR;
                 MIDI_Interface.Config.DataINEndpoint.Size    = MIDI_STREAM_EPSIZE;
-                MIDI_Interface.Config.DataINEndpoint.Banks   = 1;
+                MIDI_Interface.Config.DataINEndpoint.Banks   = USB_MIDI_ENDPOINT_BANKS;
 
                 MIDI_Interface.Config.DataOUTEndpoint.Address = MIDI_STREAM_OUT_EPADDR;
                 MIDI_Interface.Config.DataOUTEndpoint.Size    = MIDI_STREAM_EPSIZE;
-                MIDI_Interface.Config.DataOUTEndpoint.Banks   = 1;
+                MIDI_Interface.Config.DataOUTEndpoint.Banks   = USB_MIDI_ENDPOINT_BANKS;
 
                 USB_Init();
             }
@@ -112,35 +146,38 @@ namespace Board
     {
         bool readMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
         {
-            //device must be connected and configured for the task to run
-            if (USB_DeviceState != DEVICE_STATE_Configured)
+            MIDI::USBMIDIpacket_t* packets;
+
+            if (!peekMIDI(packets))
                 return false;
 
-            //select the MIDI OUT stream
-            Endpoint_SelectEndpoint(MIDI_STREAM_OUT_EPADDR);
+            USBMIDIpacket = packets[0];
+            releaseMIDI(1);
 
-            //check if a MIDI command has been received
-            if (Endpoint_IsOUTReceived())
-            {
-                //read the MIDI event packet from the endpoint
-                Endpoint_Read_Stream_LE(&USBMIDIpacket, sizeof(USBMIDIpacket), NULL);
+            return true;
+        }
+
+        size_t peekMIDI(MIDI::USBMIDIpacket_t*& packets)
+        {
+            if (!rxPacketPending)
+                rxPacketPending = readPacket(rxPacket);
+
+            packets = &rxPacket;
+            return rxPacketPending;
+        }
 
-                //if the endpoint is now empty, clear the bank
-                if (!(Endpoint_BytesInEndpoint()))
-                    Endpoint_ClearOUT();    //clear the endpoint ready for new packet
+        void releaseMIDI(size_t count)
+        {
+            if (!count || !rxPacketPending)
+                return;
+
+            rxPacketPending = false;
 
 #ifdef FW_APP
 #ifdef LED_INDICATORS
-                Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::incoming);
+            Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::incoming);
 #endif
 #endif
-
-                return true;
-            }
-            else
-            {
-                return false;
-            }
         }
 
         bool writeMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
@@ -155,11 +192,11 @@ namespace Board
             if ((ErrorCode = Endpoint_Write_Stream_LE(&USBMIDIpacket, sizeof(MIDI::USBMIDIpacket_t), NULL)) != ENDPOINT_RWSTREAM_NoError)
                 return false;
 
+            //send the bank to host once it's full
+            //otherwise, packets are sent on next flush
             if (!(Endpoint_IsReadWriteAllowed()))
                 Endpoint_ClearIN();
 
-            MIDI_Device_Flush(&MIDI_Interface);
-
 #ifdef FW_APP
 #ifdef LED_INDICATORS
             Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::outgoing);
@@ -168,5 +205,18 @@ namespace Board
 
             return true;
         }
+
+        void flushMIDI()
+        {
+            if (USB_DeviceState != DEVICE_STATE_Configured)
+                return;
+
+            MIDI_Device_Flush(&MIDI_Interface);
+        }
+
+        bool isConfigured()
+        {
+            return USB_DeviceState == DEVICE_STATE_Configured;
+        }
     }    // namespace USB
 }    // namespace Board
\ No newline at end of file
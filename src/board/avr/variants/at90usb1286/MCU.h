@@ -29,6 +29,12 @@ limitations under the License.
 ///
 #define EEPROM_SIZE 4096
 
+///
+/// \brief Number of banks used for MIDI endpoints.
+/// Two banks allow filling one bank while the other one is being sent to host.
+///
+#define USB_MIDI_ENDPOINT_BANKS 2
+
 ///
 /// \brief Size of single flash page in bytes.
 /// Used in bootloader mode when updating firmware.
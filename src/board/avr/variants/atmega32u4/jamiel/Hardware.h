@@ -101,6 +101,17 @@ limitations under the License.
 ///
 #define LED_EXT_INVERT
 
+///
+/// \brief LED fading is supported.
+///
+#define LED_FADING
+
+///
+/// \brief Number of bits used for brightness of LEDs connected to output shift registers.
+/// Brightness is set using binary code modulation.
+///
+#define LED_BRIGHTNESS_BITS             4
+
 ///
 /// \brief Maximum number of RGB LEDs.
 /// One RGB LED requires three standard LED connections.
@@ -29,6 +29,12 @@ limitations under the License.
 ///
 #define EEPROM_SIZE 512
 
+///
+/// \brief Number of banks used for MIDI endpoints.
+/// USB endpoint memory is too small for double banking of MIDI endpoints.
+///
+#define USB_MIDI_ENDPOINT_BANKS 1
+
 ///
 /// \brief Size of single flash page in bytes.
 /// Used in bootloader mode when updating firmware.
@@ -73,6 +73,12 @@ namespace Board
 
         case rebootType_t::rebootBtldr:
             detail::bootloader::enableSWtrigger();
+#if defined(FW_APP) && !defined(USB_MIDI_SUPPORTED)
+            //bootloader communicates with usb link using default baud rate
+            OpenDeckMIDIformat::resetBaudRate(UART_USB_LINK_CHANNEL);
+            while (!Board::UART::isTxEmpty(UART_USB_LINK_CHANNEL))
+                ;
+#endif
             break;
         }
 
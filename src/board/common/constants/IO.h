@@ -32,6 +32,21 @@ limitations under the License.
 #define DIGITAL_IN_ARRAY_SIZE NUMBER_OF_BUTTON_COLUMNS
 #endif
 
+///
+/// \brief Size of array used to store the state of all LEDs.
+/// Values are stored in byte array - one bit represents single LED.
+/// When LED matrix is used, each byte holds the state of all LEDs in single column.
+///
+#ifndef NUMBER_OF_LED_COLUMNS
+#if ((MAX_NUMBER_OF_LEDS % 8) != 0)
+#define LED_STATE_ARRAY_SIZE ((MAX_NUMBER_OF_LEDS / 8) + 1)
+#else
+#define LED_STATE_ARRAY_SIZE (MAX_NUMBER_OF_LEDS / 8)
+#endif
+#else
+#define LED_STATE_ARRAY_SIZE NUMBER_OF_LED_COLUMNS
+#endif
+
 ///
 /// \brief Size of ring buffer used to store all digital input readings.
 /// Once digital input array is full (all inputs are read), index within ring buffer
@@ -39,6 +54,16 @@ limitations under the License.
 ///
 #define DIGITAL_IN_BUFFER_SIZE 5
 
+///
+/// \brief Number of times analog inputs in fast lane are sampled during single analog scan.
+///
+#define ANALOG_FAST_LANE_VISITS 4
+
+///
+/// \brief Maximum number of analog inputs which can be placed in fast lane.
+///
+#define ANALOG_FAST_LANE_MAX 8
+
 ///
 /// \brief Time in milliseconds during which MIDI event indicators on board are on when MIDI event happens.
 ///
@@ -18,19 +18,72 @@ limitations under the License.
 
 #include "core/src/general/ADC.h"
 #include "core/src/general/Helpers.h"
-#include "core/src/general/Atomic.h"
 #include "board/Board.h"
 #include "board/Internal.h"
+#include "board/common/io/Helpers.h"
 #include "Pins.h"
 
+///
+/// \brief Bit set in sampling schedule entry when analog index has already been sampled during current scan.
+///
+#define SCHEDULE_REPEAT_VISIT 0x80
+
+///
+/// \brief Total number of entries in sampling schedule.
+///
+#define SCHEDULE_SIZE (MAX_NUMBER_OF_ANALOG + (ANALOG_FAST_LANE_MAX * (ANALOG_FAST_LANE_VISITS - 1)))
+
+static_assert(MAX_NUMBER_OF_ANALOG <= SCHEDULE_REPEAT_VISIT, "Analog index doesn't fit into sampling schedule entry");
+
 namespace
 {
     uint8_t          ignoreCounter;
-    uint8_t          analogIndex;
+    uint8_t          scheduleIndex;
     volatile bool    analogSamplingDone;
     volatile int16_t analogBuffer[MAX_NUMBER_OF_ANALOG];
+
+    ///
+    /// \brief Holds one bit for each analog index.
+    /// Bit is set in ISR once the sampled value differs from the stored one.
+    ///
+    volatile uint8_t analogChanged[(MAX_NUMBER_OF_ANALOG + 7) / 8];
+
+    ///
+    /// \brief Minimum difference between sampled and stored value for each analog index
+    /// needed to mark the index as changed.
+    ///
+    uint8_t changeThreshold[MAX_NUMBER_OF_ANALOG];
+
+    ///
+    /// \brief Holds one bit for each analog index placed in fast lane.
+    ///
+    uint8_t fastLane[(MAX_NUMBER_OF_ANALOG + 7) / 8];
+    uint8_t fastLaneCount;
+    bool    scheduleUpdateNeeded;
+
+    ///
+    /// \brief Order in which analog indexes are sampled during single scan.
+    /// Used only if there are inputs in fast lane, otherwise all indexes are sampled in order.
+    ///
+    uint8_t schedule[SCHEDULE_SIZE];
+    uint8_t scheduleSize;
+
+    ///
+    /// \brief Holds one bit for each analog index with burst capture enabled.
+    ///
+    uint8_t burstEnabled[(MAX_NUMBER_OF_ANALOG + 7) / 8];
+
+    ///
+    /// \brief Holds one bit for each analog index on which burst capture can be started.
+    /// Bit is cleared once the burst capture is started and set again once the sampled
+    /// value drops below ANALOG_BURST_THRESHOLD so that single strike results in single burst.
+    ///
+    uint8_t burstArmed[(MAX_NUMBER_OF_ANALOG + 7) / 8];
+
+    uint8_t burstIndex;
+    uint8_t burstSamples;
+
 #ifdef NUMBER_OF_MUX
-    uint8_t activeMux;
     uint8_t activeMuxInput;
 
     ///
@@ -44,6 +97,83 @@ namespace
         BIT_READ(Board::detail::map::muxChannel(activeMuxInput), 3) ? CORE_IO_SET_HIGH(MUX_S3_PORT, MUX_S3_PIN) : CORE_IO_SET_LOW(MUX_S3_PORT, MUX_S3_PIN);
     }
 #endif
+
+    ///
+    /// \brief Configures ADC channel (and multiplexer input if used) for specified analog index.
+    ///
+    inline void selectAnalogInput(uint8_t analogIndex)
+    {
+#ifdef NUMBER_OF_MUX
+        activeMuxInput = analogIndex % NUMBER_OF_MUX_INPUTS;
+        core::adc::setChannel(Board::detail::map::adcChannel(analogIndex / NUMBER_OF_MUX_INPUTS));
+        setMuxInput();
+#else
+        core::adc::setChannel(Board::detail::map::adcChannel(analogIndex));
+#endif
+    }
+
+    ///
+    /// \brief Stores sampled value for specified analog index.
+    /// @param [in] analogIndex Analog index.
+    /// @param [in] adcValue    Sampled value.
+    /// @param [in] keepHighest If set to true, value is stored only if it's higher than the stored one.
+    ///                         Otherwise, value is stored if it differs from the stored one by at
+    ///                         least the change threshold set for the index.
+    ///
+    inline void storeSample(uint8_t analogIndex, uint16_t adcValue, bool keepHighest)
+    {
+        //store only the values which differ from the last ones so that the
+        //application can skip the indexes on which nothing has changed
+        bool store = keepHighest ? (static_cast<int16_t>(adcValue) > analogBuffer[analogIndex]) : Board::detail::io::isAnalogChange(analogBuffer[analogIndex], adcValue, changeThreshold[analogIndex]);
+
+        if (store)
+        {
+            analogBuffer[analogIndex] = adcValue;
+            BIT_SET(analogChanged[analogIndex >> 3], analogIndex & 0x07);
+        }
+    }
+
+    ///
+    /// \brief Retrieves schedule entry for specified position within the scan.
+    ///
+    inline uint8_t scheduleEntry(uint8_t position)
+    {
+        return scheduleSize ? schedule[position] : position;
+    }
+
+    ///
+    /// \brief Builds sampling schedule from analog indexes placed in fast lane.
+    /// Ordinary indexes are split into ANALOG_FAST_LANE_VISITS chunks and all fast lane
+    /// indexes are sampled after each chunk.
+    ///
+    void buildSchedule()
+    {
+        scheduleSize = 0;
+
+        if (!fastLaneCount)
+            return;
+
+        uint8_t chunkSize = (MAX_NUMBER_OF_ANALOG - fastLaneCount + ANALOG_FAST_LANE_VISITS - 1) / ANALOG_FAST_LANE_VISITS;
+        uint8_t nextIndex = 0;
+
+        for (int visit = 0; visit < ANALOG_FAST_LANE_VISITS; visit++)
+        {
+            for (int added = 0; (added < chunkSize) && (nextIndex < MAX_NUMBER_OF_ANALOG); nextIndex++)
+            {
+                if (BIT_READ(fastLane[nextIndex >> 3], nextIndex & 0x07))
+                    continue;
+
+                schedule[scheduleSize++] = nextIndex;
+                added++;
+            }
+
+            for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+            {
+                if (BIT_READ(fastLane[i >> 3], i & 0x07))
+                    schedule[scheduleSize++] = visit ? (i | SCHEDULE_REPEAT_VISIT) : i;
+            }
+        }
+    }
 }    // namespace
 
 namespace Board
@@ -52,15 +182,54 @@ namespace Board
     {
         int16_t getAnalogValue(uint8_t analogID)
         {
-            int16_t value;
+            //no need for atomic access here - ISR doesn't touch the buffer
+            //until continueAnalogReadout is called
+            return analogBuffer[analogID];
+        }
+
+        uint8_t getAnalogChangeMask(uint8_t group)
+        {
+            uint8_t mask         = analogChanged[group];
+            analogChanged[group] = 0;
+
+            return mask;
+        }
 
-            ATOMIC_SECTION
+        bool setAnalogFastLane(uint8_t analogID, bool state)
+        {
+            if (BIT_READ(fastLane[analogID >> 3], analogID & 0x07) == state)
+                return true;
+
+            if (state)
             {
-                value                  = analogBuffer[analogID];
-                analogBuffer[analogID] = 0;
+                if (fastLaneCount == ANALOG_FAST_LANE_MAX)
+                    return false;
+
+                fastLaneCount++;
+            }
+            else
+            {
+                fastLaneCount--;
             }
 
-            return value;
+            BIT_WRITE(fastLane[analogID >> 3], analogID & 0x07, state);
+
+            //schedule is used in ISR - rebuild it once the current scan is done
+            scheduleUpdateNeeded = true;
+            return true;
+        }
+
+        void setAnalogChangeThreshold(uint8_t analogID, uint8_t threshold)
+        {
+            changeThreshold[analogID] = threshold;
+        }
+
+        void setAnalogBurst(uint8_t analogID, bool state)
+        {
+            BIT_WRITE(burstEnabled[analogID >> 3], analogID & 0x07, state);
+
+            //burst is armed once the value below threshold is sampled
+            BIT_CLEAR(burstArmed[analogID >> 3], analogID & 0x07);
         }
 
         bool isAnalogDataAvailable()
@@ -70,8 +239,15 @@ namespace Board
 
         void continueAnalogReadout()
         {
+            if (scheduleUpdateNeeded)
+            {
+                scheduleUpdateNeeded = false;
+                buildSchedule();
+                selectAnalogInput(scheduleEntry(0));
+            }
+
             analogSamplingDone = false;
-            analogIndex        = 0;
+            scheduleIndex      = 0;
 
             core::adc::startConversion();
         }
@@ -83,53 +259,63 @@ namespace Board
         {
             void adc(uint16_t adcValue)
             {
-                if (ignoreCounter++ == ADC_IGNORED_SAMPLES_COUNT)
+                if (burstSamples)
+                {
+                    //same input is sampled continuously during burst capture
+                    //no need to throw away any samples
+                    storeSample(burstIndex, adcValue, true);
+
+                    if (--burstSamples)
+                    {
+                        core::adc::startConversion();
+                        return;
+                    }
+                }
+                else if (ignoreCounter++ == ADC_IGNORED_SAMPLES_COUNT)
                 {
                     ignoreCounter = 0;
 
-                    analogBuffer[analogIndex] += adcValue;
-                    analogIndex++;
-#ifdef NUMBER_OF_MUX
-                    activeMuxInput++;
+                    uint8_t entry       = scheduleEntry(scheduleIndex);
+                    uint8_t analogIndex = entry & ~SCHEDULE_REPEAT_VISIT;
 
-                    bool switchMux = (activeMuxInput == NUMBER_OF_MUX_INPUTS);
+                    //on repeated visits during the same scan keep the highest value
+                    storeSample(analogIndex, adcValue, entry & SCHEDULE_REPEAT_VISIT);
 
-                    if (switchMux)
-#else
-                    if (analogIndex == MAX_NUMBER_OF_ANALOG)
-#endif
+                    if (BIT_READ(burstEnabled[analogIndex >> 3], analogIndex & 0x07))
                     {
-#ifdef NUMBER_OF_MUX
-                        activeMuxInput = 0;
-                        activeMux++;
-
-                        if (activeMux == NUMBER_OF_MUX)
+                        if (adcValue < ANALOG_BURST_THRESHOLD)
                         {
-                            activeMux = 0;
-#endif
-                            analogIndex        = 0;
-                            analogSamplingDone = true;
-#ifdef NUMBER_OF_MUX
+                            BIT_SET(burstArmed[analogIndex >> 3], analogIndex & 0x07);
+                        }
+                        else if (BIT_READ(burstArmed[analogIndex >> 3], analogIndex & 0x07))
+                        {
+                            //stay on this input until the burst is done so that the peak isn't missed
+                            BIT_CLEAR(burstArmed[analogIndex >> 3], analogIndex & 0x07);
+                            burstIndex   = analogIndex;
+                            burstSamples = ANALOG_BURST_SAMPLES;
+                            core::adc::startConversion();
+                            return;
                         }
-#endif
-
-#ifdef NUMBER_OF_MUX
-                        //switch to next mux once all mux inputs are read
-                        core::adc::setChannel(Board::detail::map::adcChannel(activeMux));
-#endif
                     }
+                }
+                else
+                {
+                    core::adc::startConversion();
+                    return;
+                }
 
-//always switch to next read pin
-#ifdef NUMBER_OF_MUX
-                    setMuxInput();
-#else
-                    core::adc::setChannel(Board::detail::map::adcChannel(analogIndex));
-#endif
+                if (++scheduleIndex == (scheduleSize ? scheduleSize : MAX_NUMBER_OF_ANALOG))
+                {
+                    scheduleIndex      = 0;
+                    analogSamplingDone = true;
                 }
 
+                //always switch to next read pin
+                selectAnalogInput(scheduleEntry(scheduleIndex) & ~SCHEDULE_REPEAT_VISIT);
+
                 if (!analogSamplingDone)
                     core::adc::startConversion();
             }
         }    // namespace isrHandling
     }        // namespace detail
-}    // namespace Board
\ No newline at end of file
+}    // namespace Board
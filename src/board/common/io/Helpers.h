@@ -18,6 +18,8 @@ limitations under the License.
 
 #pragma once
 
+#include <inttypes.h>
+
 ///
 /// \brief Helper macros used for easier control of internal (on-board) and external LEDs.
 /// @{
@@ -38,4 +40,39 @@ limitations under the License.
 #define EXT_LED_OFF(port, pin) CORE_IO_SET_LOW(port, pin)
 #endif
 
-/// @}
\ No newline at end of file
+/// @}
+
+namespace Board
+{
+    namespace detail
+    {
+        namespace io
+        {
+            ///
+            /// \brief Checks whether newly sampled analog value should replace the stored one.
+            /// Value is replaced once it differs from the stored one by at least the threshold so that
+            /// the ADC noise on idle inputs doesn't mark them as changed on each scan. Values at either
+            /// end of ADC range are always accepted so that the ends can be reached.
+            /// @param [in] stored      Stored value.
+            /// @param [in] sampled     Newly sampled value.
+            /// @param [in] threshold   Minimum difference between the values. Values 0 and 1 accept any change.
+            /// \returns True if the sampled value should be stored.
+            ///
+            inline bool isAnalogChange(int16_t stored, int16_t sampled, uint8_t threshold)
+            {
+                int16_t diff = sampled - stored;
+
+                if (!diff)
+                    return false;
+
+                if ((sampled == ADC_MIN_VALUE) || (sampled == ADC_MAX_VALUE))
+                    return true;
+
+                if (diff < 0)
+                    diff = -diff;
+
+                return diff >= threshold;
+            }
+        }    // namespace io
+    }        // namespace detail
+}    // namespace Board
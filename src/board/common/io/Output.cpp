@@ -35,15 +35,21 @@ namespace
     /// Used only to avoid stack usage in interrupt.
     /// @{
 
-#if defined(NUMBER_OF_LED_COLUMNS) || defined(NUMBER_OF_OUT_SR)
-    uint8_t ledIndex;
-#endif
 #ifdef NUMBER_OF_LED_COLUMNS
-    bool ledStateSingle;
+    uint8_t ledIndex;
+    uint8_t ledStateSingle;
 #endif
     /// @}
 
-    uint8_t ledState[MAX_NUMBER_OF_LEDS];
+    ///
+    /// \brief Array holding the state of all LEDs, one bit per LED.
+    /// Bits are ordered in the same way in which they're written to outputs.
+    ///
+    uint8_t ledState[LED_STATE_ARRAY_SIZE];
+
+#ifdef NUMBER_OF_LED_COLUMNS
+    static_assert(NUMBER_OF_LED_ROWS <= 8, "State of all LEDs in single matrix column is stored in one byte");
+#endif
 
 #ifdef LED_FADING
     volatile uint8_t pwmSteps;
@@ -188,6 +194,121 @@ namespace
 #endif
     }
 #endif
+
+#if defined(NUMBER_OF_OUT_SR) && !defined(NUMBER_OF_LED_COLUMNS)
+    static_assert(NUMBER_OF_OUT_SR_INPUTS == 8, "LED state is written to shift registers one byte at a time");
+
+    ///
+    /// \brief Writes the state of all LEDs to output shift registers.
+    /// @param [in] state   Array holding the state of all LEDs, one bit per LED.
+    ///
+    inline void shiftOutLEDs(const uint8_t* state)
+    {
+        CORE_IO_SET_LOW(SR_OUT_LATCH_PORT, SR_OUT_LATCH_PIN);
+
+        for (int j = 0; j < NUMBER_OF_OUT_SR; j++)
+        {
+            uint8_t value = state[j];
+
+            for (int i = 0; i < NUMBER_OF_OUT_SR_INPUTS; i++)
+            {
+                (value & 0x01) ? EXT_LED_ON(SR_OUT_DATA_PORT, SR_OUT_DATA_PIN) : EXT_LED_OFF(SR_OUT_DATA_PORT, SR_OUT_DATA_PIN);
+                CORE_IO_SET_LOW(SR_OUT_CLK_PORT, SR_OUT_CLK_PIN);
+                _NOP();
+                _NOP();
+                CORE_IO_SET_HIGH(SR_OUT_CLK_PORT, SR_OUT_CLK_PIN);
+                value >>= 1;
+            }
+        }
+
+        CORE_IO_SET_HIGH(SR_OUT_LATCH_PORT, SR_OUT_LATCH_PIN);
+    }
+#endif
+
+#ifdef LED_BRIGHTNESS_BITS
+    ///
+    /// \brief Highest brightness level of LEDs driven using binary code modulation.
+    ///
+    constexpr uint8_t LED_BRIGHTNESS_MAX = (1 << LED_BRIGHTNESS_BITS) - 1;
+
+    ///
+    /// \brief Amount by which the brightness of each LED is lowered while the LED is on.
+    /// Stored as reduction from the highest brightness so that all LEDs are fully lit by default.
+    ///
+    uint8_t ledDimming[MAX_NUMBER_OF_LEDS];
+
+    ///
+    /// \brief Brightness of all LEDs used during current modulation cycle, split into bits.
+    /// Each array holds single brightness bit of all LEDs, ordered in the same way as ledState.
+    ///
+    uint8_t ledPlanes[LED_BRIGHTNESS_BITS][LED_STATE_ARRAY_SIZE];
+
+    ///
+    /// \brief Brightness bit which is currently written to outputs.
+    ///
+    uint8_t bitPlane = LED_BRIGHTNESS_BITS - 1;
+
+    ///
+    /// \brief Number of main timer ticks for which current brightness bit stays on outputs.
+    ///
+    uint8_t bitPlaneTicks;
+
+    ///
+    /// \brief Calculates brightness level of all LEDs for next modulation cycle.
+    /// Fading is performed here as well, once per cycle.
+    ///
+    inline void updateLEDlevels()
+    {
+        for (int i = 0; i < LED_STATE_ARRAY_SIZE; i++)
+        {
+            for (int plane = 0; plane < LED_BRIGHTNESS_BITS; plane++)
+                ledPlanes[plane][i] = 0;
+        }
+
+        for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+        {
+            uint8_t brightness = LED_BRIGHTNESS_MAX - ledDimming[i];
+            bool    state      = BIT_READ(ledState[i / 8], i % 8);
+            uint8_t level;
+
+#ifdef LED_FADING
+            int8_t target = state ? NUMBER_OF_LED_TRANSITIONS - 1 : 0;
+
+            if (!pwmSteps)
+            {
+                transitionCounter[i] = target;
+            }
+            else if (transitionCounter[i] < target)
+            {
+                //fade up
+                transitionCounter[i] += pwmSteps;
+
+                if (transitionCounter[i] > target)
+                    transitionCounter[i] = target;
+            }
+            else if (transitionCounter[i] > target)
+            {
+                //fade down
+                transitionCounter[i] -= pwmSteps;
+
+                if (transitionCounter[i] < target)
+                    transitionCounter[i] = target;
+            }
+
+            //scale the brightness using the same curve as pwm transitions
+            level = (ledTransitionScale[transitionCounter[i]] * (brightness + 1)) >> 8;
+#else
+            level = state ? brightness : 0;
+#endif
+
+            for (int plane = 0; plane < LED_BRIGHTNESS_BITS; plane++)
+            {
+                if (BIT_READ(level, plane))
+                    BIT_SET(ledPlanes[plane][i / 8], i % 8);
+            }
+        }
+    }
+#endif
 }    // namespace
 
 namespace Board
@@ -196,9 +317,17 @@ namespace Board
     {
         void writeLEDstate(uint8_t ledID, bool state)
         {
+#ifdef NUMBER_OF_LED_COLUMNS
+            uint8_t arrayIndex = ledID % NUMBER_OF_LED_COLUMNS;
+            uint8_t bit        = ledID / NUMBER_OF_LED_COLUMNS;
+#else
+            uint8_t arrayIndex = ledID / 8;
+            uint8_t bit        = ledID % 8;
+#endif
+
             ATOMIC_SECTION
             {
-                ledState[ledID] = state;
+                BIT_WRITE(ledState[arrayIndex], bit, state);
 #ifndef NUMBER_OF_LED_COLUMNS
                 updateOutputs = true;
 #endif
@@ -231,6 +360,29 @@ namespace Board
         }
 #endif
 
+#ifdef LED_BRIGHTNESS_BITS
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+            if (ledID >= MAX_NUMBER_OF_LEDS)
+                return;
+
+            if (brightness > 127)
+                brightness = 127;
+
+            uint8_t level = brightness >> (7 - LED_BRIGHTNESS_BITS);
+
+            //lowest brightness shouldn't turn the led off
+            if (brightness && !level)
+                level = 1;
+
+            ledDimming[ledID] = LED_BRIGHTNESS_MAX - level;
+        }
+#else
+        __attribute__((weak)) void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+#endif
+
         uint8_t getRGBaddress(uint8_t rgbID, Interface::digital::output::LEDs::rgbIndex_t index)
         {
 #ifdef NUMBER_OF_LED_COLUMNS
@@ -300,7 +452,7 @@ namespace Board
                 for (int i = 0; i < NUMBER_OF_LED_ROWS; i++)
                 {
                     ledIndex       = activeOutColumn + i * NUMBER_OF_LED_COLUMNS;
-                    ledStateSingle = ledState[ledIndex] * (NUMBER_OF_LED_TRANSITIONS - 1);
+                    ledStateSingle = BIT_READ(ledState[activeOutColumn], i) * (NUMBER_OF_LED_TRANSITIONS - 1);
 
                     //don't bother with pwm if it's disabled
                     if (!pwmSteps && ledStateSingle)
@@ -348,33 +500,45 @@ namespace Board
                     activeOutColumn = 0;
             }
 #elif defined(NUMBER_OF_OUT_SR)
+#ifdef LED_BRIGHTNESS_BITS
             ///
-            /// \brief Checks if any LED state has been changed and writes changed state to output shift registers.
+            /// \brief Writes single brightness bit of all LEDs to output shift registers.
+            /// Each bit is kept on outputs for the number of main timer ticks equal to its weight,
+            /// so that every LED is on for the time proportional to its brightness.
+            /// Called on each main timer tick.
             ///
             void checkDigitalOutputs()
             {
-                if (updateOutputs)
+                if (bitPlaneTicks)
                 {
-                    CORE_IO_SET_LOW(SR_OUT_LATCH_PORT, SR_OUT_LATCH_PIN);
+                    bitPlaneTicks--;
+                    return;
+                }
 
-                    for (int j = 0; j < NUMBER_OF_OUT_SR; j++)
-                    {
-                        for (int i = 0; i < NUMBER_OF_OUT_SR_INPUTS; i++)
-                        {
-                            ledIndex = i + j * NUMBER_OF_OUT_SR_INPUTS;
+                if (++bitPlane == LED_BRIGHTNESS_BITS)
+                {
+                    bitPlane = 0;
+                    updateLEDlevels();
+                }
 
-                            ledState[ledIndex] ? EXT_LED_ON(SR_OUT_DATA_PORT, SR_OUT_DATA_PIN) : EXT_LED_OFF(SR_OUT_DATA_PORT, SR_OUT_DATA_PIN);
-                            CORE_IO_SET_LOW(SR_OUT_CLK_PORT, SR_OUT_CLK_PIN);
-                            _NOP();
-                            _NOP();
-                            CORE_IO_SET_HIGH(SR_OUT_CLK_PORT, SR_OUT_CLK_PIN);
-                        }
-                    }
+                //current tick is the first one in which the bit is shown
+                bitPlaneTicks = (1 << bitPlane) - 1;
 
-                    CORE_IO_SET_HIGH(SR_OUT_LATCH_PORT, SR_OUT_LATCH_PIN);
+                shiftOutLEDs(ledPlanes[bitPlane]);
+            }
+#else
+            ///
+            /// \brief Checks if any LED state has been changed and writes changed state to output shift registers.
+            ///
+            void checkDigitalOutputs()
+            {
+                if (updateOutputs)
+                {
+                    shiftOutLEDs(ledState);
                     updateOutputs = false;
                 }
             }
+#endif
 #else
             void checkDigitalOutputs()
             {
@@ -384,7 +548,7 @@ namespace Board
                     {
                         pin = Board::detail::map::led(i);
 
-                        if (ledState[i])
+                        if (BIT_READ(ledState[i / 8], i % 8))
                             EXT_LED_ON(CORE_IO_MCU_PIN_PORT(pin), CORE_IO_MCU_PIN_INDEX(pin));
                         else
                             EXT_LED_OFF(CORE_IO_MCU_PIN_PORT(pin), CORE_IO_MCU_PIN_INDEX(pin));
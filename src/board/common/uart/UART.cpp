@@ -23,6 +23,7 @@ limitations under the License.
 #include "board/Internal.h"
 #include "core/src/general/RingBuffer.h"
 #include "core/src/general/Helpers.h"
+#include "core/src/general/Atomic.h"
 
 //generic UART driver, arch-independent
 
@@ -52,6 +53,11 @@ namespace
     ///
     core::RingBuffer<uint8_t, RX_BUFFER_SIZE> rxBuffer[UART_INTERFACES];
 
+    ///
+    /// \brief Number of incoming bytes which didn't fit in RX buffer or have been lost before reaching it.
+    ///
+    volatile size_t rxDroppedCount[UART_INTERFACES];
+
     ///
     /// \brief Starts the process of transmitting the data from UART TX buffer to UART interface.
     /// @param [in] channel     UART channel on MCU.
@@ -145,6 +151,46 @@ namespace Board
 
             return txDone[channel];
         }
+
+        size_t txSpace(uint8_t channel)
+        {
+            if (channel >= UART_INTERFACES)
+                return 0;
+
+            return TX_BUFFER_SIZE - txBuffer[channel].count();
+        }
+
+        size_t txPending(uint8_t channel)
+        {
+            if (channel >= UART_INTERFACES)
+                return 0;
+
+            return txBuffer[channel].count();
+        }
+
+        size_t rxPending(uint8_t channel)
+        {
+            if (channel >= UART_INTERFACES)
+                return 0;
+
+            return rxBuffer[channel].count();
+        }
+
+        size_t rxDropped(uint8_t channel)
+        {
+            if (channel >= UART_INTERFACES)
+                return 0;
+
+            size_t dropped;
+
+            ATOMIC_SECTION
+            {
+                dropped                 = rxDroppedCount[channel];
+                rxDroppedCount[channel] = 0;
+            }
+
+            return dropped;
+        }
     }    // namespace UART
 
     namespace detail
@@ -163,6 +209,10 @@ namespace Board
 #endif
 #endif
                     }
+                    else
+                    {
+                        rxDroppedCount[channel]++;
+                    }
                 }
                 else
                 {
@@ -180,6 +230,11 @@ namespace Board
                 }
             }
 
+            void indicateRxDropped(uint8_t channel, size_t count)
+            {
+                rxDroppedCount[channel] += count;
+            }
+
             bool getNextByteToSend(uint8_t channel, uint8_t& data)
             {
                 if (txBuffer[channel].remove(data))
@@ -198,6 +253,23 @@ namespace Board
                 }
             }
 
+            size_t getNextBlockToSend(uint8_t channel, uint8_t* buffer, size_t maxSize)
+            {
+                size_t size = 0;
+
+                while ((size < maxSize) && txBuffer[channel].remove(buffer[size]))
+                    size++;
+
+#ifdef FW_APP
+#ifdef LED_INDICATORS
+                if (size)
+                    Board::detail::io::indicateMIDItraffic(MIDI::interface_t::din, Board::detail::midiTrafficDirection_t::outgoing);
+#endif
+#endif
+
+                return size;
+            }
+
             void indicateTxComplete(uint8_t channel)
             {
                 txDone[channel] = true;
@@ -41,6 +41,10 @@ extern "C"
     const USB_Descriptor_UID_String_t* USBgetSerialIDString(uint16_t* size, uint8_t uid[]);
 #endif
 
+#if defined(FW_APP) && defined(USB_UMP_SUPPORTED)
+    const USB_Descriptor_GroupTerminalBlocks_t* USBgetGroupTerminalBlockDescriptor(uint16_t* size);
+#endif
+
 #ifdef FW_BOOT
     const USB_Descriptor_HIDReport_Datatype_t* USBgetHIDreport(uint16_t* size);
     const USB_HID_Descriptor_HID_t*            USBgetHIDdescriptor(uint16_t* size);
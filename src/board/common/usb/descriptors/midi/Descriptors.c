@@ -54,6 +54,36 @@ limitations under the License.
 #include "core/src/general/Helpers.h"
 #include "board/common/Common.h"
 
+/** Each cable uses four jacks: embedded and external IN jack and embedded and external OUT jack.
+ *  Data received from host on embedded IN jack is passed to external OUT jack, and data from
+ *  external IN jack is sent to host using embedded OUT jack.
+ */
+#define MIDI_JACK_ID_IN_EMB(cable)  (0x01 + ((cable) * 4))
+#define MIDI_JACK_ID_IN_EXT(cable)  (0x02 + ((cable) * 4))
+#define MIDI_JACK_ID_OUT_EMB(cable) (0x03 + ((cable) * 4))
+#define MIDI_JACK_ID_OUT_EXT(cable) (0x04 + ((cable) * 4))
+
+#define MIDI_IN_JACK(jackType, jackID)                                                                      \
+    {                                                                                                       \
+        .Header       = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = AUDIO_DTYPE_CSInterface}, \
+        .Subtype      = AUDIO_DSUBTYPE_CSInterface_InputTerminal,                                           \
+        .JackType     = jackType,                                                                           \
+        .JackID       = jackID,                                                                             \
+        .JackStrIndex = NO_DESCRIPTOR                                                                       \
+    }
+
+#define MIDI_OUT_JACK(jackType, jackID, sourceJackID)                                                        \
+    {                                                                                                        \
+        .Header       = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = AUDIO_DTYPE_CSInterface}, \
+        .Subtype      = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,                                           \
+        .JackType     = jackType,                                                                            \
+        .JackID       = jackID,                                                                              \
+        .NumberOfPins = 1,                                                                                   \
+        .SourceJackID = {sourceJackID},                                                                      \
+        .SourcePinID  = {0x01},                                                                              \
+        .JackStrIndex = NO_DESCRIPTOR                                                                        \
+    }
+
 /** Configuration descriptor structure. This descriptor, located in FLASH memory, describes the usage
  *  of the device in one of its supported configurations, including information about any device interfaces
  *  and endpoints. The descriptor is read out by the USB host during the enumeration process when selecting
@@ -127,60 +157,57 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 
         .AudioSpecification       = VERSION_BCD(1,0,0),
 
+#ifdef USB_UMP_SUPPORTED
+        .TotalLength              = (offsetof(USB_Descriptor_Configuration_t, Audio_StreamInterface_UMP) -
+                                        offsetof(USB_Descriptor_Configuration_t, Audio_StreamInterface_SPC))
+#else
         .TotalLength              = (sizeof(USB_Descriptor_Configuration_t) -
                                         offsetof(USB_Descriptor_Configuration_t, Audio_StreamInterface_SPC))
+#endif
     },
 
     .MIDI_In_Jack_Emb =
     {
-        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = AUDIO_DTYPE_CSInterface},
-        .Subtype                  = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
-
-        .JackType                 = MIDI_JACKTYPE_Embedded,
-        .JackID                   = 0x01,
-
-        .JackStrIndex             = NO_DESCRIPTOR
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(0)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(1)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(2)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(3)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(4)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(5)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_IN_EMB(6))
     },
 
     .MIDI_In_Jack_Ext =
     {
-        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_InputJack_t), .Type = AUDIO_DTYPE_CSInterface},
-        .Subtype                  = AUDIO_DSUBTYPE_CSInterface_InputTerminal,
-
-        .JackType                 = MIDI_JACKTYPE_External,
-        .JackID                   = 0x02,
-
-        .JackStrIndex             = NO_DESCRIPTOR
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(0)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(1)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(2)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(3)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(4)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(5)),
+        MIDI_IN_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_IN_EXT(6))
     },
 
     .MIDI_Out_Jack_Emb =
     {
-        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = AUDIO_DTYPE_CSInterface},
-        .Subtype                  = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
-
-        .JackType                 = MIDI_JACKTYPE_Embedded,
-        .JackID                   = 0x03,
-
-        .NumberOfPins             = 1,
-        .SourceJackID             = {0x02},
-        .SourcePinID              = {0x01},
-
-        .JackStrIndex             = NO_DESCRIPTOR
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(0), MIDI_JACK_ID_IN_EXT(0)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(1), MIDI_JACK_ID_IN_EXT(1)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(2), MIDI_JACK_ID_IN_EXT(2)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(3), MIDI_JACK_ID_IN_EXT(3)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(4), MIDI_JACK_ID_IN_EXT(4)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(5), MIDI_JACK_ID_IN_EXT(5)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_Embedded, MIDI_JACK_ID_OUT_EMB(6), MIDI_JACK_ID_IN_EXT(6))
     },
 
     .MIDI_Out_Jack_Ext =
     {
-        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_OutputJack_t), .Type = AUDIO_DTYPE_CSInterface},
-        .Subtype                  = AUDIO_DSUBTYPE_CSInterface_OutputTerminal,
-
-        .JackType                 = MIDI_JACKTYPE_External,
-        .JackID                   = 0x04,
-
-        .NumberOfPins             = 1,
-        .SourceJackID             = {0x01},
-        .SourcePinID              = {0x01},
-
-        .JackStrIndex             = NO_DESCRIPTOR
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(0), MIDI_JACK_ID_IN_EMB(0)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(1), MIDI_JACK_ID_IN_EMB(1)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(2), MIDI_JACK_ID_IN_EMB(2)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(3), MIDI_JACK_ID_IN_EMB(3)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(4), MIDI_JACK_ID_IN_EMB(4)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(5), MIDI_JACK_ID_IN_EMB(5)),
+        MIDI_OUT_JACK(MIDI_JACKTYPE_External, MIDI_JACK_ID_OUT_EXT(6), MIDI_JACK_ID_IN_EMB(6))
     },
 
     .MIDI_In_Jack_Endpoint =
@@ -201,11 +228,12 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 
     .MIDI_In_Jack_Endpoint_SPC =
     {
-        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t), .Type = AUDIO_DTYPE_CSEndpoint},
+        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_Cables_t), .Type = AUDIO_DTYPE_CSEndpoint},
         .Subtype                  = AUDIO_DSUBTYPE_CSEndpoint_General,
 
-        .TotalEmbeddedJacks       = 0x01,
-        .AssociatedJackID         = {0x01}
+        .TotalEmbeddedJacks       = USB_MIDI_CABLES,
+        .AssociatedJackID         = {MIDI_JACK_ID_IN_EMB(0), MIDI_JACK_ID_IN_EMB(1), MIDI_JACK_ID_IN_EMB(2), MIDI_JACK_ID_IN_EMB(3),
+                                     MIDI_JACK_ID_IN_EMB(4), MIDI_JACK_ID_IN_EMB(5), MIDI_JACK_ID_IN_EMB(6)}
     },
 
     .MIDI_Out_Jack_Endpoint =
@@ -226,13 +254,112 @@ const USB_Descriptor_Configuration_t PROGMEM ConfigurationDescriptor =
 
     .MIDI_Out_Jack_Endpoint_SPC =
     {
-        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_t), .Type = AUDIO_DTYPE_CSEndpoint},
+        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_Jack_Endpoint_Cables_t), .Type = AUDIO_DTYPE_CSEndpoint},
         .Subtype                  = AUDIO_DSUBTYPE_CSEndpoint_General,
 
-        .TotalEmbeddedJacks       = 0x01,
-        .AssociatedJackID         = {0x03}
+        .TotalEmbeddedJacks       = USB_MIDI_CABLES,
+        .AssociatedJackID         = {MIDI_JACK_ID_OUT_EMB(0), MIDI_JACK_ID_OUT_EMB(1), MIDI_JACK_ID_OUT_EMB(2), MIDI_JACK_ID_OUT_EMB(3),
+                                     MIDI_JACK_ID_OUT_EMB(4), MIDI_JACK_ID_OUT_EMB(5), MIDI_JACK_ID_OUT_EMB(6)}
+    },
+
+#ifdef USB_UMP_SUPPORTED
+    .Audio_StreamInterface_UMP =
+    {
+        .Header                   = {.Size = sizeof(USB_Descriptor_Interface_t), .Type = DTYPE_Interface},
+
+        .InterfaceNumber          = INTERFACE_ID_AudioStream,
+        .AlternateSetting         = MIDI_STREAM_ALT_UMP,
+
+        .TotalEndpoints           = 2,
+
+        .Class                    = AUDIO_CSCP_AudioClass,
+        .SubClass                 = AUDIO_CSCP_MIDIStreamingSubclass,
+        .Protocol                 = AUDIO_CSCP_StreamingProtocol,
+
+        .InterfaceStrIndex        = NO_DESCRIPTOR
+    },
+
+    .Audio_StreamInterface_UMP_SPC =
+    {
+        .Header                   = {.Size = sizeof(USB_MIDI_Descriptor_AudioInterface_AS_t), .Type = AUDIO_DTYPE_CSInterface},
+        .Subtype                  = AUDIO_DSUBTYPE_CSInterface_General,
+
+        .AudioSpecification       = VERSION_BCD(2,0,0),
+
+        //group terminal blocks are requested separately
+        .TotalLength              = sizeof(USB_MIDI_Descriptor_AudioInterface_AS_t)
+    },
+
+    .UMP_Out_Endpoint =
+    {
+        .Header                   = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+        .EndpointAddress          = MIDI_STREAM_OUT_EPADDR,
+        .Attributes               = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+        .EndpointSize             = MIDI_STREAM_EPSIZE,
+        .PollingIntervalMS        = 0
+    },
+
+    .UMP_Out_Endpoint_SPC =
+    {
+        .Header                         = {.Size = sizeof(USB_MIDI2_Descriptor_Endpoint_t), .Type = AUDIO_DTYPE_CSEndpoint},
+        .Subtype                        = MIDI_DSUBTYPE_CSEndpoint_General_2_0,
+
+        .TotalGroupTerminalBlocks       = 1,
+        .AssociatedGroupTerminalBlockID = {MIDI_GROUP_TERMINAL_BLOCK_ID}
+    },
+
+    .UMP_In_Endpoint =
+    {
+        .Header                   = {.Size = sizeof(USB_Descriptor_Endpoint_t), .Type = DTYPE_Endpoint},
+
+        .EndpointAddress          = MIDI_STREAM_IN_EPADDR,
+        .Attributes               = (EP_TYPE_BULK | ENDPOINT_ATTR_NO_SYNC | ENDPOINT_USAGE_DATA),
+        .EndpointSize             = MIDI_STREAM_EPSIZE,
+        .PollingIntervalMS        = 0
+    },
+
+    .UMP_In_Endpoint_SPC =
+    {
+        .Header                         = {.Size = sizeof(USB_MIDI2_Descriptor_Endpoint_t), .Type = AUDIO_DTYPE_CSEndpoint},
+        .Subtype                        = MIDI_DSUBTYPE_CSEndpoint_General_2_0,
+
+        .TotalGroupTerminalBlocks       = 1,
+        .AssociatedGroupTerminalBlockID = {MIDI_GROUP_TERMINAL_BLOCK_ID}
+    }
+#endif
+};
+
+#ifdef USB_UMP_SUPPORTED
+/** Group Terminal Block descriptors. Single bidirectional block is exposed, with one group for each
+ *  cable used in USB MIDI 1.0 mode. Messages sent to host use MIDI 2.0 protocol.
+ */
+const USB_Descriptor_GroupTerminalBlocks_t PROGMEM GroupTerminalBlockDescriptor =
+{
+    .Header =
+    {
+        .Header                   = {.Size = sizeof(USB_MIDI2_Descriptor_GroupTerminalBlock_Header_t), .Type = MIDI_DTYPE_GroupTerminalBlock},
+        .Subtype                  = MIDI_DSUBTYPE_GroupTerminalBlock_Header,
+
+        .TotalLength              = sizeof(USB_Descriptor_GroupTerminalBlocks_t)
+    },
+
+    .Block =
+    {
+        .Header                   = {.Size = sizeof(USB_MIDI2_Descriptor_GroupTerminalBlock_t), .Type = MIDI_DTYPE_GroupTerminalBlock},
+        .Subtype                  = MIDI_DSUBTYPE_GroupTerminalBlock,
+
+        .BlockID                  = MIDI_GROUP_TERMINAL_BLOCK_ID,
+        .BlockType                = 0x00,    //bidirectional
+        .FirstGroup               = 0,
+        .TotalGroups              = USB_MIDI_CABLES,
+        .BlockStrIndex            = NO_DESCRIPTOR,
+        .Protocol                 = 0x11,    //MIDI 2.0 protocol
+        .MaxInputBandwidth        = 0,       //unknown
+        .MaxOutputBandwidth       = 0
     }
 };
+#endif
 
 /** Device descriptor structure. This descriptor, located in FLASH memory, describes the overall
  *  device characteristics, including the supported USB version, control endpoint size and the
@@ -285,6 +412,14 @@ const USB_Descriptor_Configuration_t* USBgetCfgDescriptor(uint16_t* size)
     return &ConfigurationDescriptor;
 }
 
+#ifdef USB_UMP_SUPPORTED
+const USB_Descriptor_GroupTerminalBlocks_t* USBgetGroupTerminalBlockDescriptor(uint16_t* size)
+{
+    *size = sizeof(USB_Descriptor_GroupTerminalBlocks_t);
+    return &GroupTerminalBlockDescriptor;
+}
+#endif
+
 const USB_Descriptor_Device_t* USBgetDeviceDescriptor(uint16_t* size)
 {
     *size = sizeof(USB_Descriptor_Device_t);
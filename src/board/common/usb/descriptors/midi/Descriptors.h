@@ -41,6 +41,85 @@
 /** Endpoint size in bytes of the Audio isochronous streaming data IN and OUT endpoints. */
 #define MIDI_STREAM_EPSIZE 64
 
+/** Number of virtual MIDI cables exposed to the host. Each cable uses its own set of embedded and external
+    *  jacks. Cable number in USB MIDI event packet is the index of the jack within the endpoint descriptor.
+    */
+#define USB_MIDI_CABLES 7
+
+/** Audio class-specific Jack Endpoint Descriptor holding all the embedded jacks used by endpoint. */
+typedef struct
+{
+    USB_Descriptor_Header_t Header;
+    uint8_t                 Subtype;
+
+    uint8_t TotalEmbeddedJacks;
+    uint8_t AssociatedJackID[USB_MIDI_CABLES];
+} ATTR_PACKED USB_MIDI_Descriptor_Jack_Endpoint_Cables_t;
+
+#ifdef USB_UMP_SUPPORTED
+/** Alternate setting of the MIDI streaming interface in which data is exchanged using USB MIDI 2.0
+    *  Universal MIDI Packets. Alternate setting 0 uses USB MIDI 1.0 event packets.
+    */
+#define MIDI_STREAM_ALT_UMP 1
+
+/** Descriptor type of Group Terminal Block descriptors. These descriptors aren't part of the configuration
+    *  descriptor - host requests them separately from the MIDI streaming interface.
+    */
+#define MIDI_DTYPE_GroupTerminalBlock 0x26
+
+/** Subtype of MIDI 2.0 class-specific endpoint descriptor. */
+#define MIDI_DSUBTYPE_CSEndpoint_General_2_0 0x02
+
+/** Subtypes of Group Terminal Block descriptors. */
+#define MIDI_DSUBTYPE_GroupTerminalBlock_Header 0x01
+#define MIDI_DSUBTYPE_GroupTerminalBlock        0x02
+
+/** ID of the only Group Terminal Block exposed by the device. */
+#define MIDI_GROUP_TERMINAL_BLOCK_ID 1
+
+/** MIDI 2.0 class-specific endpoint descriptor listing all the Group Terminal Blocks used by endpoint. */
+typedef struct
+{
+    USB_Descriptor_Header_t Header;
+    uint8_t                 Subtype;
+
+    uint8_t TotalGroupTerminalBlocks;
+    uint8_t AssociatedGroupTerminalBlockID[1];
+} ATTR_PACKED USB_MIDI2_Descriptor_Endpoint_t;
+
+/** Header of Group Terminal Block descriptors. */
+typedef struct
+{
+    USB_Descriptor_Header_t Header;
+    uint8_t                 Subtype;
+
+    uint16_t TotalLength;
+} ATTR_PACKED USB_MIDI2_Descriptor_GroupTerminalBlock_Header_t;
+
+/** Group Terminal Block descriptor describing range of UMP groups used by the device. */
+typedef struct
+{
+    USB_Descriptor_Header_t Header;
+    uint8_t                 Subtype;
+
+    uint8_t  BlockID;
+    uint8_t  BlockType;
+    uint8_t  FirstGroup;
+    uint8_t  TotalGroups;
+    uint8_t  BlockStrIndex;
+    uint8_t  Protocol;
+    uint16_t MaxInputBandwidth;
+    uint16_t MaxOutputBandwidth;
+} ATTR_PACKED USB_MIDI2_Descriptor_GroupTerminalBlock_t;
+
+/** Complete set of Group Terminal Block descriptors returned to host. */
+typedef struct
+{
+    USB_MIDI2_Descriptor_GroupTerminalBlock_Header_t Header;
+    USB_MIDI2_Descriptor_GroupTerminalBlock_t        Block;
+} ATTR_PACKED USB_Descriptor_GroupTerminalBlocks_t;
+#endif
+
 /** Type define for the device configuration descriptor structure. This must be defined in the
     *  application code, as the configuration descriptor contains several sub-descriptors which
     *  vary between devices, and which describe the device's usage to the host.
@@ -54,16 +133,26 @@ typedef struct
     USB_Audio_Descriptor_Interface_AC_t Audio_ControlInterface_SPC;
 
     // MIDI Audio Streaming Interface
-    USB_Descriptor_Interface_t                Audio_StreamInterface;
-    USB_MIDI_Descriptor_AudioInterface_AS_t   Audio_StreamInterface_SPC;
-    USB_MIDI_Descriptor_InputJack_t           MIDI_In_Jack_Emb;
-    USB_MIDI_Descriptor_InputJack_t           MIDI_In_Jack_Ext;
-    USB_MIDI_Descriptor_OutputJack_t          MIDI_Out_Jack_Emb;
-    USB_MIDI_Descriptor_OutputJack_t          MIDI_Out_Jack_Ext;
-    USB_Audio_Descriptor_StreamEndpoint_Std_t MIDI_In_Jack_Endpoint;
-    USB_MIDI_Descriptor_Jack_Endpoint_t       MIDI_In_Jack_Endpoint_SPC;
-    USB_Audio_Descriptor_StreamEndpoint_Std_t MIDI_Out_Jack_Endpoint;
-    USB_MIDI_Descriptor_Jack_Endpoint_t       MIDI_Out_Jack_Endpoint_SPC;
+    USB_Descriptor_Interface_t                  Audio_StreamInterface;
+    USB_MIDI_Descriptor_AudioInterface_AS_t     Audio_StreamInterface_SPC;
+    USB_MIDI_Descriptor_InputJack_t             MIDI_In_Jack_Emb[USB_MIDI_CABLES];
+    USB_MIDI_Descriptor_InputJack_t             MIDI_In_Jack_Ext[USB_MIDI_CABLES];
+    USB_MIDI_Descriptor_OutputJack_t            MIDI_Out_Jack_Emb[USB_MIDI_CABLES];
+    USB_MIDI_Descriptor_OutputJack_t            MIDI_Out_Jack_Ext[USB_MIDI_CABLES];
+    USB_Audio_Descriptor_StreamEndpoint_Std_t   MIDI_In_Jack_Endpoint;
+    USB_MIDI_Descriptor_Jack_Endpoint_Cables_t  MIDI_In_Jack_Endpoint_SPC;
+    USB_Audio_Descriptor_StreamEndpoint_Std_t   MIDI_Out_Jack_Endpoint;
+    USB_MIDI_Descriptor_Jack_Endpoint_Cables_t  MIDI_Out_Jack_Endpoint_SPC;
+
+#ifdef USB_UMP_SUPPORTED
+    // MIDI 2.0 Audio Streaming Interface (alternate setting)
+    USB_Descriptor_Interface_t              Audio_StreamInterface_UMP;
+    USB_MIDI_Descriptor_AudioInterface_AS_t Audio_StreamInterface_UMP_SPC;
+    USB_Descriptor_Endpoint_t               UMP_Out_Endpoint;
+    USB_MIDI2_Descriptor_Endpoint_t         UMP_Out_Endpoint_SPC;
+    USB_Descriptor_Endpoint_t               UMP_In_Endpoint;
+    USB_MIDI2_Descriptor_Endpoint_t         UMP_In_Endpoint_SPC;
+#endif
 } USB_Descriptor_Configuration_t;
 
 /** Enum for the device interface descriptor IDs within the device. Each interface descriptor
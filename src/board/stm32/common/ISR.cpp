@@ -20,6 +20,15 @@ limitations under the License.
 #include "board/Internal.h"
 #include "stm32f4xx_hal.h"
 #include "core/src/general/Timing.h"
+#include "core/src/general/Atomic.h"
+
+namespace
+{
+    ///
+    /// \brief Toggled on each main timer interrupt. Set to true once the current millisecond is complete.
+    ///
+    volatile bool _1ms = true;
+}    // namespace
 
 extern PCD_HandleTypeDef hpcd_USB_OTG_FS;
 
@@ -96,8 +105,6 @@ namespace Board
         {
             void mainTimer()
             {
-                static bool _1ms = true;
-
                 _1ms = !_1ms;
 
                 if (_1ms)
@@ -105,7 +112,7 @@ namespace Board
                     core::timing::detail::rTime_ms++;
 
 #ifdef FW_APP
-#ifdef LEDS_SUPPORTED
+#if defined(LEDS_SUPPORTED) && !defined(LED_BRIGHTNESS_BITS)
                     Board::detail::io::checkDigitalOutputs();
 #endif
 #endif
@@ -115,9 +122,38 @@ namespace Board
 #endif
                 }
 #ifdef FW_APP
+#ifdef LED_BRIGHTNESS_BITS
+                //binary code modulation uses shortest possible time slices to avoid visible flicker
+                Board::detail::io::checkDigitalOutputs();
+#endif
                 Board::detail::io::checkDigitalInputs();
 #endif
             }
         }    // namespace isrHandling
     }        // namespace detail
-}    // namespace Board
\ No newline at end of file
+}    // namespace Board
+
+uint32_t Board::runTimeUs()
+{
+    auto*    timer = Board::detail::map::mainTimerInstance();
+    uint32_t ms;
+    uint32_t ticks;
+    bool     secondHalf;
+
+    ATOMIC_SECTION
+    {
+        ms         = core::timing::detail::rTime_ms;
+        ticks      = timer->CNT;
+        secondHalf = !_1ms;
+
+        //counter has already been cleared but the interrupt hasn't been handled yet
+        if ((timer->SR & TIM_SR_UIF) && (ticks < timer->ARR))
+            ticks += timer->ARR + 1;
+
+        if (secondHalf)
+            ticks += timer->ARR + 1;
+    }
+
+    //main timer interrupt occurs every 500us
+    return (ms * 1000) + ((ticks * 500) / (timer->ARR + 1));
+}
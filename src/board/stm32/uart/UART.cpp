@@ -23,10 +23,186 @@ limitations under the License.
 #include "board/Internal.h"
 #include "core/src/general/Atomic.h"
 
+#ifdef UART_DMA_SUPPORTED
+///
+/// \brief Size of circular buffer into which incoming data is received using DMA.
+///
+#define DMA_RX_BUFFER_SIZE 64
+
+///
+/// \brief Size of buffer from which outgoing data is transmitted using DMA.
+///
+#define DMA_TX_BUFFER_SIZE 32
+#endif
+
 namespace
 {
     UART_HandleTypeDef uartHandler[UART_INTERFACES];
-}
+
+#ifdef UART_DMA_SUPPORTED
+    DMA_HandleTypeDef dmaRxHandler[UART_INTERFACES];
+    DMA_HandleTypeDef dmaTxHandler[UART_INTERFACES];
+
+    ///
+    /// \brief Buffer into which incoming data is continuously received.
+    ///
+    uint8_t dmaRxBuffer[UART_INTERFACES][DMA_RX_BUFFER_SIZE];
+
+    ///
+    /// \brief Position in DMA RX buffer up to which received data has been processed.
+    ///
+    size_t dmaRxPosition[UART_INTERFACES];
+
+    ///
+    /// \brief Buffer holding the block of outgoing data which is currently being transmitted.
+    /// Data is copied here from UART TX buffer since the ring buffer doesn't expose its storage.
+    ///
+    uint8_t dmaTxBuffer[UART_INTERFACES][DMA_TX_BUFFER_SIZE];
+
+    ///
+    /// \brief Flag signaling that the DMA transfer of outgoing data is in progress.
+    ///
+    volatile bool dmaTxActive[UART_INTERFACES];
+
+    ///
+    /// \brief Passes all the data received since the last call to the generic UART driver.
+    /// Called once half or all of the RX buffer is filled or once the line becomes idle.
+    /// @param [in] channel     UART channel on MCU.
+    /// @param [in] overrun     If set to true, DMA has written over the data which hasn't been
+    ///                         processed yet. Since the number of overwritten bytes isn't known,
+    ///                         contents of the whole RX buffer are discarded and counted as dropped.
+    ///
+    void dmaProcessReceived(uint8_t channel, bool overrun = false)
+    {
+        size_t position = DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(&dmaRxHandler[channel]);
+
+        if (position == DMA_RX_BUFFER_SIZE)
+            position = 0;
+
+        if (overrun)
+        {
+            Board::detail::UART::indicateRxDropped(channel, DMA_RX_BUFFER_SIZE);
+            dmaRxPosition[channel] = position;
+            return;
+        }
+
+        while (dmaRxPosition[channel] != position)
+        {
+            Board::detail::UART::storeIncomingData(channel, dmaRxBuffer[channel][dmaRxPosition[channel]]);
+
+            if (++dmaRxPosition[channel] == DMA_RX_BUFFER_SIZE)
+                dmaRxPosition[channel] = 0;
+        }
+    }
+
+    ///
+    /// \brief Starts the DMA transfer of next block of data from UART TX buffer.
+    /// Must be called only when no transfer is in progress.
+    /// @param [in] channel     UART channel on MCU.
+    ///
+    void dmaTransmitNext(uint8_t channel)
+    {
+        auto&  handler = dmaTxHandler[channel];
+        size_t size    = Board::detail::UART::getNextBlockToSend(channel, dmaTxBuffer[channel], DMA_TX_BUFFER_SIZE);
+
+        if (!size)
+        {
+            dmaTxActive[channel] = false;
+            return;
+        }
+
+        dmaTxActive[channel] = true;
+
+        __HAL_DMA_CLEAR_FLAG(&handler, __HAL_DMA_GET_TC_FLAG_INDEX(&handler) | __HAL_DMA_GET_HT_FLAG_INDEX(&handler) | __HAL_DMA_GET_TE_FLAG_INDEX(&handler) | __HAL_DMA_GET_FE_FLAG_INDEX(&handler) | __HAL_DMA_GET_DME_FLAG_INDEX(&handler));
+
+        handler.Instance->M0AR = reinterpret_cast<uint32_t>(dmaTxBuffer[channel]);
+        handler.Instance->NDTR = size;
+
+        __HAL_DMA_ENABLE(&handler);
+    }
+
+    ///
+    /// \brief Configures DMA streams used for specified UART channel and starts the reception.
+    /// @param [in] channel     UART channel on MCU.
+    ///
+    void dmaInit(uint8_t channel)
+    {
+        auto& streams = Board::detail::map::uartDMA(channel);
+        auto& rx      = dmaRxHandler[channel];
+        auto& tx      = dmaTxHandler[channel];
+
+        __HAL_RCC_DMA1_CLK_ENABLE();
+        __HAL_RCC_DMA2_CLK_ENABLE();
+
+        rx.Instance                 = streams.rxStream;
+        rx.Init.Channel             = streams.rxChannel;
+        rx.Init.Direction           = DMA_PERIPH_TO_MEMORY;
+        rx.Init.PeriphInc           = DMA_PINC_DISABLE;
+        rx.Init.MemInc              = DMA_MINC_ENABLE;
+        rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        rx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+        rx.Init.Mode                = DMA_CIRCULAR;
+        rx.Init.Priority            = DMA_PRIORITY_HIGH;
+        rx.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+        HAL_DMA_Init(&rx);
+
+        tx.Instance                 = streams.txStream;
+        tx.Init.Channel             = streams.txChannel;
+        tx.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+        tx.Init.PeriphInc           = DMA_PINC_DISABLE;
+        tx.Init.MemInc              = DMA_MINC_ENABLE;
+        tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+        tx.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
+        tx.Init.Mode                = DMA_NORMAL;
+        tx.Init.Priority            = DMA_PRIORITY_MEDIUM;
+        tx.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
+        HAL_DMA_Init(&tx);
+
+        //streams are controlled directly from here on - HAL transfer API isn't used
+        rx.Instance->PAR  = reinterpret_cast<uint32_t>(&uartHandler[channel].Instance->DR);
+        rx.Instance->M0AR = reinterpret_cast<uint32_t>(dmaRxBuffer[channel]);
+        rx.Instance->NDTR = DMA_RX_BUFFER_SIZE;
+        tx.Instance->PAR  = reinterpret_cast<uint32_t>(&uartHandler[channel].Instance->DR);
+
+        __HAL_DMA_ENABLE_IT(&rx, DMA_IT_HT | DMA_IT_TC);
+        __HAL_DMA_ENABLE_IT(&tx, DMA_IT_TC);
+
+        HAL_NVIC_SetPriority(streams.rxIRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(streams.rxIRQn);
+        HAL_NVIC_SetPriority(streams.txIRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(streams.txIRQn);
+
+        dmaRxPosition[channel] = 0;
+        dmaTxActive[channel]   = false;
+
+        __HAL_DMA_ENABLE(&rx);
+        SET_BIT(uartHandler[channel].Instance->CR3, USART_CR3_DMAR | USART_CR3_DMAT);
+
+        //idle line signals the end of incoming block which hasn't filled half of the buffer
+        __HAL_UART_ENABLE_IT(&uartHandler[channel], UART_IT_IDLE);
+    }
+
+    ///
+    /// \brief Stops DMA streams used for specified UART channel.
+    /// @param [in] channel     UART channel on MCU.
+    ///
+    void dmaDeInit(uint8_t channel)
+    {
+        auto& streams = Board::detail::map::uartDMA(channel);
+
+        if (dmaRxHandler[channel].Instance == nullptr)
+            return;
+
+        HAL_NVIC_DisableIRQ(streams.rxIRQn);
+        HAL_NVIC_DisableIRQ(streams.txIRQn);
+
+        HAL_DMA_DeInit(&dmaRxHandler[channel]);
+        HAL_DMA_DeInit(&dmaTxHandler[channel]);
+
+        dmaTxActive[channel] = false;
+    }
+#endif
+}    // namespace
 
 namespace Board
 {
@@ -41,7 +217,16 @@ namespace Board
                     if (channel >= UART_INTERFACES)
                         return;
 
+#ifdef UART_DMA_SUPPORTED
+                    //if the transfer is in progress, new data is sent once it's done
+                    ATOMIC_SECTION
+                    {
+                        if (!dmaTxActive[channel])
+                            dmaTransmitNext(channel);
+                    }
+#else
                     __HAL_UART_ENABLE_IT(&uartHandler[channel], UART_IT_TXE);
+#endif
                 }
 
                 void disableDataEmptyInt(uint8_t channel)
@@ -49,7 +234,9 @@ namespace Board
                     if (channel >= UART_INTERFACES)
                         return;
 
+#ifndef UART_DMA_SUPPORTED
                     __HAL_UART_DISABLE_IT(&uartHandler[channel], UART_IT_TXE);
+#endif
                 }
 
                 void deInit(uint8_t channel)
@@ -57,6 +244,10 @@ namespace Board
                     if (channel >= UART_INTERFACES)
                         return;
 
+#ifdef UART_DMA_SUPPORTED
+                    dmaDeInit(channel);
+#endif
+
                     HAL_UART_DeInit(&uartHandler[channel]);
                 }
 
@@ -80,6 +271,10 @@ namespace Board
 
                     //enable transmission done interrupt
                     __HAL_UART_ENABLE_IT(&uartHandler[channel], UART_IT_TC);
+
+#ifdef UART_DMA_SUPPORTED
+                    dmaInit(channel);
+#endif
                 }
 
                 void directWrite(uint8_t channel, uint8_t data)
@@ -91,6 +286,57 @@ namespace Board
 
         namespace isrHandling
         {
+#ifdef UART_DMA_SUPPORTED
+            void uart(uint8_t channel)
+            {
+                uint32_t isrflags = READ_REG(uartHandler[channel].Instance->SR);
+                uint32_t cr1its   = READ_REG(uartHandler[channel].Instance->CR1);
+
+                if (((isrflags & USART_SR_IDLE) != RESET) && ((cr1its & USART_CR1_IDLEIE) != RESET))
+                {
+                    //byte received while the previous one was still waiting for DMA is lost
+                    if ((isrflags & USART_SR_ORE) != RESET)
+                        Board::detail::UART::indicateRxDropped(channel, 1);
+
+                    //clearing the idle flag also clears possible error flags
+                    __HAL_UART_CLEAR_IDLEFLAG(&uartHandler[channel]);
+                    dmaProcessReceived(channel);
+                }
+
+                if (((isrflags & USART_SR_TC) != RESET) && ((cr1its & USART_CR1_TCIE) != RESET))
+                {
+                    __HAL_UART_CLEAR_FLAG(&uartHandler[channel], UART_FLAG_TC);
+
+                    //line can also become idle between two DMA transfers
+                    if (!dmaTxActive[channel])
+                        Board::detail::UART::indicateTxComplete(channel);
+                }
+            }
+
+            void uartDMA(uint8_t channel)
+            {
+                auto& rx = dmaRxHandler[channel];
+                auto& tx = dmaTxHandler[channel];
+
+                bool halfFilled = __HAL_DMA_GET_FLAG(&rx, __HAL_DMA_GET_HT_FLAG_INDEX(&rx)) != RESET;
+                bool fullFilled = __HAL_DMA_GET_FLAG(&rx, __HAL_DMA_GET_TC_FLAG_INDEX(&rx)) != RESET;
+
+                if (halfFilled || fullFilled)
+                {
+                    __HAL_DMA_CLEAR_FLAG(&rx, __HAL_DMA_GET_HT_FLAG_INDEX(&rx) | __HAL_DMA_GET_TC_FLAG_INDEX(&rx));
+
+                    //both halves have been filled since the last interrupt was handled:
+                    //DMA has come around the buffer to the data which hasn't been processed yet
+                    dmaProcessReceived(channel, halfFilled && fullFilled);
+                }
+
+                if (__HAL_DMA_GET_FLAG(&tx, __HAL_DMA_GET_TC_FLAG_INDEX(&tx)) != RESET)
+                {
+                    __HAL_DMA_CLEAR_FLAG(&tx, __HAL_DMA_GET_TC_FLAG_INDEX(&tx));
+                    dmaTransmitNext(channel);
+                }
+            }
+#else
             void uart(uint8_t channel)
             {
                 uint32_t isrflags     = READ_REG(uartHandler[channel].Instance->SR);
@@ -134,6 +380,7 @@ namespace Board
                     }
                 }
             }
+#endif
         }    // namespace isrHandling
     }        // namespace detail
 }    // namespace Board
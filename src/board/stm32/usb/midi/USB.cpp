@@ -16,10 +16,10 @@ limitations under the License.
 
 */
 
+#include <string.h>
 #include "board/common/usb/descriptors/Descriptors.h"
 #include "usbd_core.h"
 #include "midi/src/MIDI.h"
-#include "core/src/general/RingBuffer.h"
 #include "core/src/general/Atomic.h"
 #include "core/src/general/Timing.h"
 #include "core/src/general/StringBuilder.h"
@@ -27,31 +27,77 @@ limitations under the License.
 #include "board/Internal.h"
 
 ///
-/// \brief Buffer size in bytes for incoming and outgoing MIDI messages (from device standpoint).
-/// @{
-
-#define RX_BUFFER_SIZE 128
-#define TX_BUFFER_SIZE 128
+/// \brief Number of endpoint-sized buffers used for incoming MIDI messages (from device standpoint).
+/// If all the buffers are full, host is not allowed to send more data until one of them is read.
+///
+#define RX_BUFFERS 4
 
-/// @}
+///
+/// \brief Buffer size in bytes for outgoing MIDI messages (from device standpoint).
+/// Single buffer holds as many USB MIDI event packets as it's possible to send in single transfer.
+///
+#define TX_BUFFER_SIZE MIDI_STREAM_EPSIZE
 
 namespace
 {
-    USBD_HandleTypeDef             hUsbDeviceFS;
-    volatile bool                  TxDone;
-    __ALIGN_BEGIN volatile uint8_t rxBuffer[RX_BUFFER_SIZE] __ALIGN_END;
+    USBD_HandleTypeDef hUsbDeviceFS;
+    volatile bool      txActive;
+
+    ///
+    /// \brief Queue of buffers for incoming packets.
+    /// Data is received directly into the buffer at rxHead and read in place from the buffer at rxTail.
+    ///
+    __ALIGN_BEGIN uint8_t rxBuffer[RX_BUFFERS][MIDI_STREAM_EPSIZE] __ALIGN_END;
+    volatile uint8_t      rxCount[RX_BUFFERS];
+    volatile uint8_t      rxFilled;
+    volatile bool         rxPaused;
+    uint8_t               rxHead;
+    uint8_t               rxTail;
+    uint8_t               rxPosition;
+
+    ///
+    /// \brief Buffers for outgoing packets.
+    /// While one buffer is being transmitted, new packets are added to the other one.
+    ///
+    __ALIGN_BEGIN uint8_t txBuffer[2][TX_BUFFER_SIZE] __ALIGN_END;
+    volatile uint8_t      txCount[2];
+    volatile uint8_t      txFillIndex;
+
+    ///
+    /// \brief Alternate setting of MIDI streaming interface selected by host.
+    ///
+    uint8_t altSetting;
+
+    ///
+    /// \brief Starts the transfer of all packets added to the currently filled buffer
+    /// and switches to the other buffer. Must be called only when no transfer is in progress.
+    ///
+    void startTransfer()
+    {
+        uint8_t index = txFillIndex;
+
+        txActive             = true;
+        txFillIndex          = !index;
+        txCount[txFillIndex] = 0;
 
-    //rxBuffer is overriden every time RxCallback is called
-    //save results in ring buffer and remove them as needed in readMIDI
-    //not really the most optimized way, however, we are not in AVR land anymore
-    core::RingBuffer<uint8_t, RX_BUFFER_SIZE> rxBufferRing;
+        USBD_LL_Transmit(&hUsbDeviceFS, MIDI_STREAM_IN_EPADDR, txBuffer[index], txCount[index]);
+    }
 
     uint8_t initCallback(USBD_HandleTypeDef* pdev, uint8_t cfgidx)
     {
-        USBD_LL_OpenEP(pdev, MIDI_STREAM_IN_EPADDR, USBD_EP_TYPE_BULK, TX_BUFFER_SIZE);
-        USBD_LL_OpenEP(pdev, MIDI_STREAM_OUT_EPADDR, USBD_EP_TYPE_BULK, RX_BUFFER_SIZE);
-        USBD_LL_PrepareReceive(pdev, MIDI_STREAM_OUT_EPADDR, (uint8_t*)(rxBuffer), RX_BUFFER_SIZE);
-        TxDone = true;
+        USBD_LL_OpenEP(pdev, MIDI_STREAM_IN_EPADDR, USBD_EP_TYPE_BULK, MIDI_STREAM_EPSIZE);
+        USBD_LL_OpenEP(pdev, MIDI_STREAM_OUT_EPADDR, USBD_EP_TYPE_BULK, MIDI_STREAM_EPSIZE);
+        rxFilled   = 0;
+        rxPaused   = false;
+        rxHead     = 0;
+        rxTail     = 0;
+        rxPosition = 0;
+        USBD_LL_PrepareReceive(pdev, MIDI_STREAM_OUT_EPADDR, rxBuffer[rxHead], MIDI_STREAM_EPSIZE);
+        txActive    = false;
+        txCount[0]  = 0;
+        txCount[1]  = 0;
+        txFillIndex = 0;
+        altSetting  = 0;
         return 0;
     }
 
@@ -62,20 +108,100 @@ namespace
         return 0;
     }
 
+    uint8_t setupCallback(USBD_HandleTypeDef* pdev, USBD_SetupReqTypedef* req)
+    {
+        //only standard interface requests are supported
+        if ((req->bmRequest & USB_REQ_TYPE_MASK) == USB_REQ_TYPE_STANDARD)
+        {
+            switch (req->bRequest)
+            {
+#ifdef USB_UMP_SUPPORTED
+            case USB_REQ_GET_DESCRIPTOR:
+            {
+                if (HIBYTE(req->wValue) == MIDI_DTYPE_GroupTerminalBlock)
+                {
+                    uint16_t                                    length;
+                    const USB_Descriptor_GroupTerminalBlocks_t* desc = USBgetGroupTerminalBlockDescriptor(&length);
+
+                    USBD_CtlSendData(pdev, (uint8_t*)desc, MIN(length, req->wLength));
+                    return USBD_OK;
+                }
+            }
+            break;
+#endif
+
+            case USB_REQ_GET_INTERFACE:
+            {
+                static uint8_t alt;
+
+                alt = (LOBYTE(req->wIndex) == INTERFACE_ID_AudioStream) ? altSetting : 0;
+                USBD_CtlSendData(pdev, &alt, 1);
+                return USBD_OK;
+            }
+
+            case USB_REQ_SET_INTERFACE:
+            {
+                uint8_t alt   = LOBYTE(req->wValue);
+                bool    valid = !alt;
+
+#ifdef USB_UMP_SUPPORTED
+                if ((LOBYTE(req->wIndex) == INTERFACE_ID_AudioStream) && (alt == MIDI_STREAM_ALT_UMP))
+                    valid = true;
+#endif
+
+                if (!valid)
+                    break;
+
+                if (LOBYTE(req->wIndex) == INTERFACE_ID_AudioStream)
+                {
+                    //packets written using the previous format shouldn't be sent anymore
+                    if ((alt != altSetting) && !txActive)
+                        txCount[txFillIndex] = 0;
+
+                    altSetting = alt;
+                }
+
+                return USBD_OK;
+            }
+
+            default:
+                break;
+            }
+        }
+
+        USBD_CtlError(pdev, req);
+        return USBD_FAIL;
+    }
+
     uint8_t TxCompleteCallback(USBD_HandleTypeDef* pdev, uint8_t epnum)
     {
-        TxDone = true;
+        txActive = false;
+
+        //send everything accumulated during the last transfer right away
+        if (txCount[txFillIndex])
+            startTransfer();
+
         return USBD_OK;
     }
 
     uint8_t RxCallback(USBD_HandleTypeDef* pdev, uint8_t epnum)
     {
-        uint32_t count = ((PCD_HandleTypeDef*)pdev->pData)->OUT_ep[epnum].xfer_count;
+        //ignore incomplete packets
+        uint32_t count = ((PCD_HandleTypeDef*)pdev->pData)->OUT_ep[epnum].xfer_count & ~0x03;
 
-        for (uint32_t i = 0; i < count; i++)
-            rxBufferRing.insert(rxBuffer[i]);
+        if (count)
+        {
+            rxCount[rxHead] = count;
+            rxHead          = (rxHead + 1) % RX_BUFFERS;
+            rxFilled++;
+        }
+
+        //if there are no free buffers left, host will get NAK until one is released
+        if (rxFilled < RX_BUFFERS)
+            USBD_LL_PrepareReceive(pdev, MIDI_STREAM_OUT_EPADDR, rxBuffer[rxHead], MIDI_STREAM_EPSIZE);
+        else
+            rxPaused = true;
 
-        USBD_LL_PrepareReceive(pdev, MIDI_STREAM_OUT_EPADDR, (uint8_t*)(rxBuffer), RX_BUFFER_SIZE);
         return 0;
     }
 
@@ -151,7 +277,7 @@ namespace
     USBD_ClassTypeDef USB_MIDI = {
         initCallback,
         deInitCallback,
-        NULL,
+        setupCallback,
         NULL,
         NULL,
         TxCompleteCallback,
@@ -185,41 +311,139 @@ namespace Board
     {
         bool readMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
         {
+            MIDI::USBMIDIpacket_t* packets;
+
+            if (!peekMIDI(packets))
+                return false;
+
+            USBMIDIpacket = packets[0];
+            releaseMIDI(1);
+
+            return true;
+        }
+
+        size_t peekMIDI(MIDI::USBMIDIpacket_t*& packets)
+        {
+            if (!rxFilled)
+                return 0;
+
+            packets = reinterpret_cast<MIDI::USBMIDIpacket_t*>(&rxBuffer[rxTail][rxPosition]);
+            return (rxCount[rxTail] - rxPosition) / sizeof(MIDI::USBMIDIpacket_t);
+        }
+
+        void releaseMIDI(size_t count)
+        {
+            if (!count)
+                return;
+
+            rxPosition += count * sizeof(MIDI::USBMIDIpacket_t);
+
+#ifdef FW_APP
+#ifdef LED_INDICATORS
+            Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::incoming);
+#endif
+#endif
+
+            if (rxPosition < rxCount[rxTail])
+                return;
+
+            //whole buffer is processed - make it available for reception again
+            rxPosition = 0;
+            rxTail     = (rxTail + 1) % RX_BUFFERS;
+
+            ATOMIC_SECTION
+            {
+                rxFilled--;
+
+                if (rxPaused)
+                {
+                    rxPaused = false;
+                    USBD_LL_PrepareReceive(&hUsbDeviceFS, MIDI_STREAM_OUT_EPADDR, rxBuffer[rxHead], MIDI_STREAM_EPSIZE);
+                }
+            }
+        }
+
+        bool writeMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            if (hUsbDeviceFS.dev_state != USBD_STATE_CONFIGURED)
+                return false;
+
             bool returnValue = false;
 
             ATOMIC_SECTION
             {
-                if (rxBufferRing.count() >= 4)
+                uint8_t index = txFillIndex;
+
+                //if both buffers are full, drop the packet instead of waiting for the transfer to finish
+                if (txCount[index] < TX_BUFFER_SIZE)
                 {
-                    rxBufferRing.remove(USBMIDIpacket.Event);
-                    rxBufferRing.remove(USBMIDIpacket.Data1);
-                    rxBufferRing.remove(USBMIDIpacket.Data2);
-                    rxBufferRing.remove(USBMIDIpacket.Data3);
+                    uint8_t* data = &txBuffer[index][txCount[index]];
 
+                    data[0] = USBMIDIpacket.Event;
+                    data[1] = USBMIDIpacket.Data1;
+                    data[2] = USBMIDIpacket.Data2;
+                    data[3] = USBMIDIpacket.Data3;
+
+                    txCount[index] += 4;
                     returnValue = true;
                 }
+
+                //if the transfer is in progress, packets are sent once it's done
+                if (!txActive)
+                    startTransfer();
             }
 
-            if (returnValue)
-            {
-#ifdef FW_APP
+            if (!returnValue)
+                return false;
+
 #ifdef LED_INDICATORS
-                Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::incoming);
-#endif
+            Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::outgoing);
 #endif
-            }
 
-            return returnValue;
+            return true;
         }
 
-        bool writeMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        void flushMIDI()
+        {
+            //packets are sent as soon as the endpoint is ready
+        }
+
+        bool isConfigured()
+        {
+            return hUsbDeviceFS.dev_state == USBD_STATE_CONFIGURED;
+        }
+
+#ifdef USB_UMP_SUPPORTED
+        bool isUMPenabled()
         {
-            while (!TxDone)
+            return isConfigured() && (altSetting == MIDI_STREAM_ALT_UMP);
+        }
+
+        bool writeUMP(const uint32_t* words, uint8_t count)
+        {
+            if (!isUMPenabled())
+                return false;
+
+            bool returnValue = false;
+
+            ATOMIC_SECTION
             {
+                uint8_t index = txFillIndex;
+
+                //words are sent in little-endian order, same as they're stored in memory
+                if ((txCount[index] + (count * sizeof(uint32_t))) <= TX_BUFFER_SIZE)
+                {
+                    memcpy(&txBuffer[index][txCount[index]], words, count * sizeof(uint32_t));
+                    txCount[index] += count * sizeof(uint32_t);
+                    returnValue = true;
+                }
+
+                if (!txActive)
+                    startTransfer();
             }
 
-            TxDone = false;
-            USBD_LL_Transmit(&hUsbDeviceFS, MIDI_STREAM_IN_EPADDR, (uint8_t*)&USBMIDIpacket, 4);
+            if (!returnValue)
+                return false;
 
 #ifdef LED_INDICATORS
             Board::detail::io::indicateMIDItraffic(MIDI::interface_t::usb, Board::detail::midiTrafficDirection_t::outgoing);
@@ -227,5 +451,6 @@ namespace Board
 
             return true;
         }
+#endif
     }    // namespace USB
 }    // namespace Board
\ No newline at end of file
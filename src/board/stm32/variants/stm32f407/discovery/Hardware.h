@@ -41,6 +41,12 @@ limitations under the License.
 ///
 #define USB_MIDI_SUPPORTED
 
+///
+/// \brief Indicates that the board exposes USB MIDI 2.0 alternate setting
+/// in which data is exchanged using Universal MIDI Packets.
+///
+#define USB_UMP_SUPPORTED
+
 ///
 /// \brief Defines total number of available UART interfaces on board.
 ///
@@ -56,6 +62,11 @@ limitations under the License.
 ///
 #define UART_MIDI_CHANNEL               0
 
+///
+/// \brief Indicates that the UART data is transferred using DMA instead of per-byte interrupts.
+///
+#define UART_DMA_SUPPORTED
+
 ///
 /// \brief Constant used to debounce button readings.
 ///
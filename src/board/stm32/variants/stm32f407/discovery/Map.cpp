@@ -218,6 +218,20 @@ namespace Board
                     }
                 };
 
+#ifdef UART_DMA_SUPPORTED
+                const uartDMA_t uartDMAstreams[UART_INTERFACES] = {
+                    //USART3
+                    {
+                        .rxStream  = DMA1_Stream1,
+                        .rxChannel = DMA_CHANNEL_4,
+                        .rxIRQn    = DMA1_Stream1_IRQn,
+                        .txStream  = DMA1_Stream3,
+                        .txChannel = DMA_CHANNEL_4,
+                        .txIRQn    = DMA1_Stream3_IRQn,
+                    }
+                };
+#endif
+
                 EmuEEPROM::pageDescriptor_t flashPage1 = {
                     .startAddress = EEPROM_PAGE1_START_ADDRESS,
                     .sector       = EEPROM_PAGE1_SECTOR
@@ -260,6 +274,13 @@ namespace Board
                 }
             }
 
+#ifdef UART_DMA_SUPPORTED
+            const uartDMA_t& uartDMA(uint8_t channel)
+            {
+                return uartDMAstreams[channel];
+            }
+#endif
+
             TIM_TypeDef* mainTimerInstance()
             {
                 return TIM7;
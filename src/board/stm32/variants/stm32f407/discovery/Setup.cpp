@@ -74,6 +74,20 @@ extern "C" void USART3_IRQHandler(void)
     Board::detail::isrHandling::uart(0);
 }
 
+#ifdef UART_DMA_SUPPORTED
+//USART3 RX
+extern "C" void DMA1_Stream1_IRQHandler(void)
+{
+    Board::detail::isrHandling::uartDMA(0);
+}
+
+//USART3 TX
+extern "C" void DMA1_Stream3_IRQHandler(void)
+{
+    Board::detail::isrHandling::uartDMA(0);
+}
+#endif
+
 extern "C" void ADC_IRQHandler(void)
 {
     Board::detail::isrHandling::adc(hadc1.Instance->DR);
@@ -21,13 +21,14 @@ limitations under the License.
 
 #include "OpenDeckMIDIformat.h"
 #include "board/Board.h"
+#include "core/src/general/Timing.h"
 
 namespace OpenDeckMIDIformat
 {
     namespace
     {
         ///
-        /// \brief List of all bytes contained within OpenDeck packet.
+        /// \brief List of all bytes contained within single packet frame.
         ///
         enum class packet_t : uint8_t
         {
@@ -36,154 +37,946 @@ namespace OpenDeckMIDIformat
             data1,
             data2,
             data3,
-            dataXor
+            crc,
+            AMOUNT
         };
 
-        uint8_t incomingBytesCount = 0;
-        uint8_t readBytes[6]       = {};
-        uint8_t tempArray[5];
+        ///
+        /// \brief List of header bytes of batch frame.
+        /// Header is followed by packets (four bytes each) and checksum.
+        ///
+        enum class batch_t : uint8_t
+        {
+            marker,
+            packetType,
+            count,
+            AMOUNT
+        };
 
         ///
-        /// \brief Appends read byte into internal storage.
-        /// If the buffer is full and valid packet still hasn't been
-        /// found, this function will shift all stored bytes by one
-        /// position to the left and write current byte to the
-        /// last position.
+        /// \brief Size of the buffer holding incoming frame bytes.
+        /// Must be a power of two large enough to hold the largest frame.
         ///
-        void appendIncoming(uint8_t byte)
+        constexpr uint8_t PARSER_BUFFER_SIZE = 32;
+
+        static_assert((static_cast<uint8_t>(batch_t::AMOUNT) + (OPENDECK_MIDI_FORMAT_BATCH_SIZE * 4) + 1) <= PARSER_BUFFER_SIZE, "Batch frame doesn't fit in parser buffer");
+
+        ///
+        /// \brief Returned by frameSize if the frame is invalid.
+        ///
+        constexpr uint8_t FRAME_INVALID = 0xFF;
+
+        ///
+        /// \brief State of frame parser for single UART channel.
+        /// Received bytes are stored in ring buffer so that parsing can be resumed from
+        /// any stored byte without moving the data around.
+        ///
+        typedef struct
         {
-            if (incomingBytesCount >= 6)
-            {
-                //shift data
-                for (int i = 0; i < 5; i++)
-                    tempArray[i] = readBytes[i + 1];
+            uint8_t bytes[PARSER_BUFFER_SIZE];
+            uint8_t start;
+            uint8_t count;
+            uint8_t frameSize;    ///< Size of the decoded frame which is still being reported.
+            uint8_t reported;     ///< Number of packets from decoded batch frame which have been reported.
 
-                for (int i = 0; i < 5; i++)
-                    readBytes[i] = tempArray[i];
+            uint8_t at(uint8_t index) const
+            {
+                return bytes[(start + index) & (PARSER_BUFFER_SIZE - 1)];
+            }
 
-                readBytes[5] = byte;
+            void consume(uint8_t size)
+            {
+                start = (start + size) & (PARSER_BUFFER_SIZE - 1);
+                count -= size;
             }
-            else
+        } parser_t;
+
+        parser_t parser[UART_INTERFACES];
+
+        ///
+        /// \brief MIDI packets collected for single UART channel which haven't been sent yet.
+        ///
+        typedef struct
+        {
+            packetType_t          packetType;
+            uint8_t               count;
+            MIDI::USBMIDIpacket_t packets[OPENDECK_MIDI_FORMAT_BATCH_SIZE];
+        } pending_t;
+
+        pending_t pending[UART_INTERFACES];
+
+        ///
+        /// \brief Baud rates which can be negotiated, from the lowest to the highest one.
+        /// Negotiation always starts from the first one.
+        ///
+        const uint32_t baudRates[] = {
+            UART_BAUDRATE_MIDI_OD,
+            250000,
+            500000,
+            1000000
+        };
+
+        constexpr uint8_t BAUD_RATES = sizeof(baudRates) / sizeof(baudRates[0]);
+
+        ///
+        /// \brief Bytes sent in Data1, Data2 and Data3 of baudRateVerify command.
+        ///
+        constexpr uint8_t VERIFY_PATTERN[3] = { 0x55, 0xAA, 0x33 };
+
+        ///
+        /// \brief List of steps through which the board which started the baud rate negotiation goes.
+        /// Each step is completed once the sent command is returned to the board.
+        ///
+        enum class negotiation_t : uint8_t
+        {
+            none,
+            reset,
+            request,
+            switching,
+            verify
+        };
+
+        ///
+        /// \brief State of baud rate negotiation for single UART channel.
+        ///
+        typedef struct
+        {
+            bool          initiator;        ///< True if negotiation on this channel is started by this board.
+            bool          linked;           ///< True if the request has been returned to initiating board.
+            negotiation_t step;             ///< Current negotiation step on initiating board.
+            bool          verifyPending;    ///< True if the rate has been switched on other boards and test pattern hasn't been received yet.
+            bool          switchPending;    ///< True if the rate has to be switched once everything written so far is sent.
+            bool          patternSent;      ///< True if the test pattern has been sent using the new rate.
+            uint8_t       index;            ///< Index of currently used baud rate.
+            uint8_t       next;             ///< Index of baud rate used once pending switch is done.
+            uint8_t       target;           ///< Index of baud rate which is being switched to.
+            uint8_t       maxIndex;         ///< Highest index requested by initiating board.
+            uint8_t       attempts;         ///< Number of baud rate requests sent.
+            uint8_t       address;          ///< Address assigned to this board, 0 if not assigned.
+            uint8_t       nodes;            ///< Number of other boards found by initiating board.
+            uint8_t       errors;           ///< Number of invalid frames received since the last valid one.
+            uint32_t      stepTime;         ///< Time in milliseconds at which current step has been started.
+            uint32_t      lastValid;        ///< Time in milliseconds at which the last valid frame has been received.
+        } baudRateState_t;
+
+        baudRateState_t baudRateState[UART_INTERFACES];
+
+        ///
+        /// \brief State of round-trip time measurement for single UART channel.
+        ///
+        typedef struct
+        {
+            bool     pending;       ///< True if the last sent ping hasn't returned yet.
+            uint8_t  sequence;      ///< Sequence number of the last sent ping.
+            uint32_t sendTime;      ///< Time in milliseconds at which the last ping has been sent.
+            uint32_t sendTimeUs;    ///< Time in microseconds at which the last ping has been sent.
+        } pingState_t;
+
+        pingState_t pingState[UART_INTERFACES];
+
+        stats_t linkStats[UART_INTERFACES];
+
+        bool isStartMarker(uint8_t byte)
+        {
+            switch (static_cast<packetType_t>(byte))
             {
-                readBytes[incomingBytesCount++] = byte;
+            case packetType_t::midi:
+            case packetType_t::internalCommand:
+            case packetType_t::midiDaisyChain:
+            case packetType_t::batch:
+                return true;
+
+            default:
+                return false;
             }
         }
 
+        bool isBatchable(packetType_t packetType)
+        {
+            return (packetType == packetType_t::midi) || (packetType == packetType_t::midiDaisyChain);
+        }
+
+        uint8_t crcUpdate(uint8_t crc, uint8_t data)
+        {
+            crc ^= data;
+
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+
+            return crc;
+        }
+
         ///
-        /// \brief Clears the entire incoming buffer.
-        /// Should be called when valid packet has been processed.
+        /// \brief Determines the size of the frame stored at the start of the parser buffer.
+        /// \returns Frame size in bytes, 0 if the size isn't known yet or FRAME_INVALID if
+        /// the frame header is invalid.
         ///
-        void clearIncomingCount()
+        uint8_t frameSize(const parser_t& state)
         {
-            incomingBytesCount = 0;
+            if (static_cast<packetType_t>(state.at(0)) != packetType_t::batch)
+                return static_cast<uint8_t>(packet_t::AMOUNT);
+
+            if (state.count < static_cast<uint8_t>(batch_t::AMOUNT))
+                return 0;
 
-            for (int i = 0; i < 6; i++)
-                readBytes[i] = 0;
+            uint8_t count = state.at(static_cast<uint8_t>(batch_t::count));
+
+            if (!isBatchable(static_cast<packetType_t>(state.at(static_cast<uint8_t>(batch_t::packetType)))) || !count || (count > OPENDECK_MIDI_FORMAT_BATCH_SIZE))
+                return FRAME_INVALID;
+
+            return static_cast<uint8_t>(batch_t::AMOUNT) + (count * 4) + 1;
         }
-    }    // namespace
 
-    bool write(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t packetType)
-    {
-        if (channel >= UART_INTERFACES)
-            return false;
+        ///
+        /// \brief Searches the stored bytes for complete and valid frame.
+        /// If the frame is invalid, parsing continues from the next start marker found within
+        /// the stored bytes, so that the frames following the corrupted one aren't lost.
+        /// \returns True if valid frame is stored at the start of the parser buffer, false otherwise.
+        ///
+        bool findFrame(uint8_t channel)
+        {
+            auto& state = parser[channel];
+            auto& stats = linkStats[channel];
+            auto& link  = baudRateState[channel];
 
-        Board::UART::write(channel, static_cast<uint8_t>(packetType));
-        Board::UART::write(channel, USBMIDIpacket.Event);
-        Board::UART::write(channel, USBMIDIpacket.Data1);
-        Board::UART::write(channel, USBMIDIpacket.Data2);
-        Board::UART::write(channel, USBMIDIpacket.Data3);
-        Board::UART::write(channel, USBMIDIpacket.Event ^ USBMIDIpacket.Data1 ^ USBMIDIpacket.Data2 ^ USBMIDIpacket.Data3);
+            while (state.count)
+            {
+                uint8_t size = frameSize(state);
 
-        return true;
-    }
+                if (size != FRAME_INVALID)
+                {
+                    if (!size || (state.count < size))
+                        return false;
+
+                    uint8_t crc = 0;
+
+                    for (int i = 0; i < (size - 1); i++)
+                        crc = crcUpdate(crc, state.at(i));
+
+                    if (crc == state.at(size - 1))
+                    {
+                        state.frameSize = size;
+                        state.reported  = 0;
+                        stats.framesReceived++;
+                        link.errors    = 0;
+                        link.lastValid = core::timing::currentRunTimeMs();
+                        return true;
+                    }
+
+                    stats.crcErrors++;
+                }
+
+                stats.resyncs++;
+
+                if (link.errors < 0xFF)
+                    link.errors++;
+
+                //resync: drop the start marker of invalid frame and continue from the next one
+                do
+                {
+                    state.consume(1);
+                } while (state.count && !isStartMarker(state.at(0)));
+            }
 
-    bool read(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t& packetType)
-    {
-        if (channel >= UART_INTERFACES)
             return false;
+        }
 
-        for (int i = 0; i < 6; i++)
+        ///
+        /// \brief Reports next packet from the decoded frame.
+        /// Frame is removed from the parser buffer once all of its packets are reported.
+        ///
+        void reportPacket(parser_t& state, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t& packetType)
         {
-            uint8_t value;
+            uint8_t offset    = static_cast<uint8_t>(packet_t::event);
+            uint8_t remaining = 1;
 
-            if (!Board::UART::read(channel, value))
-                break;
+            if (static_cast<packetType_t>(state.at(0)) == packetType_t::batch)
+            {
+                packetType = static_cast<packetType_t>(state.at(static_cast<uint8_t>(batch_t::packetType)));
+                offset     = static_cast<uint8_t>(batch_t::AMOUNT) + (state.reported * 4);
+                remaining  = state.at(static_cast<uint8_t>(batch_t::count)) - state.reported;
+            }
             else
-                appendIncoming(value);
+            {
+                packetType = static_cast<packetType_t>(state.at(0));
+            }
 
-            if (incomingBytesCount == 6)
-                break;
+            USBMIDIpacket.Event = state.at(offset);
+            USBMIDIpacket.Data1 = state.at(offset + 1);
+            USBMIDIpacket.Data2 = state.at(offset + 2);
+            USBMIDIpacket.Data3 = state.at(offset + 3);
+
+            state.reported++;
+
+            if (remaining == 1)
+            {
+                state.consume(state.frameSize);
+                state.frameSize = 0;
+            }
         }
 
-        if (incomingBytesCount != 6)
-            return false;
+        void writeFrameByte(uint8_t channel, uint8_t& crc, uint8_t data)
+        {
+            crc = crcUpdate(crc, data);
+            Board::UART::write(channel, data);
+        }
+
+        void writePacket(uint8_t channel, uint8_t& crc, const MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            writeFrameByte(channel, crc, USBMIDIpacket.Event);
+            writeFrameByte(channel, crc, USBMIDIpacket.Data1);
+            writeFrameByte(channel, crc, USBMIDIpacket.Data2);
+            writeFrameByte(channel, crc, USBMIDIpacket.Data3);
+        }
+
+        ///
+        /// \brief Sends all the collected packets on specified channel.
+        /// Single packet is sent in its own frame since it's smaller than batch frame.
+        ///
+        void sendPending(uint8_t channel)
+        {
+            auto&   batch = pending[channel];
+            uint8_t crc   = 0;
+
+            if (!batch.count)
+                return;
+
+            if (batch.count == 1)
+            {
+                writeFrameByte(channel, crc, static_cast<uint8_t>(batch.packetType));
+            }
+            else
+            {
+                writeFrameByte(channel, crc, static_cast<uint8_t>(packetType_t::batch));
+                writeFrameByte(channel, crc, static_cast<uint8_t>(batch.packetType));
+                writeFrameByte(channel, crc, batch.count);
+            }
+
+            for (int i = 0; i < batch.count; i++)
+                writePacket(channel, crc, batch.packets[i]);
+
+            Board::UART::write(channel, crc);
+            batch.count = 0;
+            linkStats[channel].framesSent++;
+        }
+
+        ///
+        /// \brief Returns the index of the highest baud rate supported by this board.
+        ///
+        uint8_t maxBaudRateIndex()
+        {
+            uint8_t index = 0;
+
+            for (int i = 1; i < BAUD_RATES; i++)
+            {
+                if (baudRates[i] <= UART_BAUDRATE_MIDI_OD_MAX)
+                    index = i;
+            }
+
+            return index;
+        }
+
+        void sendCommand(uint8_t channel, command_t command, uint8_t data1 = 0, uint8_t data2 = 0, uint8_t data3 = 0)
+        {
+            MIDI::USBMIDIpacket_t USBMIDIpacket;
+
+            USBMIDIpacket.Event = static_cast<uint8_t>(command);
+            USBMIDIpacket.Data1 = data1;
+            USBMIDIpacket.Data2 = data2;
+            USBMIDIpacket.Data3 = data3;
+
+            write(channel, USBMIDIpacket, packetType_t::internalCommand);
+        }
+
+        ///
+        /// \brief Performs the switch requested with setBaudRate if everything written using the old rate has been sent.
+        /// Incomplete frame received using old rate is discarded.
+        /// \returns True if the switch is done or if there is no pending switch, false otherwise.
+        ///
+        bool applyBaudRate(uint8_t channel)
+        {
+            auto& state = baudRateState[channel];
+
+            if (!state.switchPending)
+                return true;
+
+            if (!Board::UART::isTxEmpty(channel))
+                return false;
+
+            Board::UART::init(channel, baudRates[state.next]);
+
+            parser[channel].start     = 0;
+            parser[channel].count     = 0;
+            parser[channel].frameSize = 0;
+
+            state.switchPending = false;
+            state.index         = state.next;
+            state.errors        = 0;
+            state.lastValid     = core::timing::currentRunTimeMs();
+
+            return true;
+        }
 
-        bool packetTypeValid = true;
+        ///
+        /// \brief Switches UART channel to specified baud rate once everything has been sent.
+        /// Until then, nothing else can be written to the channel.
+        ///
+        void setBaudRate(uint8_t channel, uint8_t index)
+        {
+            baudRateState[channel].next          = index;
+            baudRateState[channel].switchPending = true;
 
-        if ((readBytes[static_cast<uint8_t>(packet_t::packetType)] == static_cast<uint8_t>(packetType_t::midi)) || (readBytes[static_cast<uint8_t>(packet_t::packetType)] == static_cast<uint8_t>(packetType_t::midiDaisyChain)))
-            packetType = static_cast<packetType_t>(readBytes[static_cast<uint8_t>(packet_t::packetType)]);
-        else if (readBytes[static_cast<uint8_t>(packet_t::packetType)] == static_cast<uint8_t>(packetType_t::internalCommand))
-            packetType = packetType_t::internalCommand;
-        else
-            packetTypeValid = false;
+            applyBaudRate(channel);
+        }
 
-        if (packetTypeValid)
+        void requestBaudRate(uint8_t channel)
         {
-            //read the rest of the packet
-            for (int i = 0; i < 5; i++)
+            auto& state = baudRateState[channel];
+
+            state.step     = negotiation_t::request;
+            state.stepTime = core::timing::currentRunTimeMs();
+            state.attempts++;
+
+            //first board which receives the request gets address 1
+            sendCommand(channel, command_t::baudRateRequest, state.maxIndex, 1);
+        }
+
+        ///
+        /// \brief Sends the commands of initiating board which have to wait for the rate switch.
+        /// Reset commands are sent using each rate above the default one, from the highest one, and are
+        /// followed by the request. Test pattern is sent once the new rate is used.
+        ///
+        void sendDeferred(uint8_t channel)
+        {
+            auto& state = baudRateState[channel];
+
+            while (applyBaudRate(channel))
             {
-                switch (i)
+                if (state.step == negotiation_t::reset)
                 {
-                case 0:
-                    USBMIDIpacket.Event = readBytes[static_cast<uint8_t>(packet_t::event)];
-                    break;
+                    if (!state.index)
+                    {
+                        requestBaudRate(channel);
+                        return;
+                    }
 
-                case 1:
-                    USBMIDIpacket.Data1 = readBytes[static_cast<uint8_t>(packet_t::data1)];
-                    break;
+                    sendCommand(channel, command_t::baudRateReset);
+                    setBaudRate(channel, state.index - 1);
+                }
+                else
+                {
+                    if ((state.step == negotiation_t::verify) && !state.patternSent)
+                    {
+                        state.patternSent = true;
+                        state.stepTime    = core::timing::currentRunTimeMs();
+                        sendCommand(channel, command_t::baudRateVerify, VERIFY_PATTERN[0], VERIFY_PATTERN[1], VERIFY_PATTERN[2]);
+                    }
 
-                case 2:
-                    USBMIDIpacket.Data2 = readBytes[static_cast<uint8_t>(packet_t::data2)];
-                    break;
+                    return;
+                }
+            }
+        }
 
-                case 3:
-                    USBMIDIpacket.Data3 = readBytes[static_cast<uint8_t>(packet_t::data3)];
-                    break;
+        ///
+        /// \brief Returns to the default rate after the check of the new rate has failed.
+        /// Initiating board retries with the next lower rate.
+        ///
+        void baudRateFailed(uint8_t channel)
+        {
+            auto& state = baudRateState[channel];
+
+            state.verifyPending = false;
+            setBaudRate(channel, 0);
+
+            if (!state.initiator)
+                return;
+
+            state.maxIndex = state.target - 1;
+            state.attempts = 0;
+
+            //addresses have already been assigned
+            //request is sent once the default rate is used
+            state.step = state.maxIndex ? negotiation_t::reset : negotiation_t::none;
+        }
+
+        ///
+        /// \brief Checks whether the current step of baud rate negotiation has timed out.
+        ///
+        void checkBaudRate(uint8_t channel)
+        {
+            auto& state = baudRateState[channel];
+
+            if (((state.step == negotiation_t::none) && !state.verifyPending) || (state.step == negotiation_t::reset))
+                return;
+
+            if ((core::timing::currentRunTimeMs() - state.stepTime) < OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT)
+                return;
+
+            if (state.step == negotiation_t::request)
+            {
+                //other boards might not be ready yet
+                if (state.attempts < OPENDECK_MIDI_FORMAT_BAUD_RATE_ATTEMPTS)
+                    requestBaudRate(channel);
+                else
+                    state.step = negotiation_t::none;
+            }
+            else
+            {
+                //boards which have switched to new rate return to the default one on their own
+                baudRateFailed(channel);
+            }
+        }
+
+        ///
+        /// \brief Returns to the default rate if the link stops working while higher rate is used,
+        /// for instance once the board on the other side is restarted and uses the default rate again.
+        /// Initiating board starts the negotiation again.
+        ///
+        void checkLink(uint8_t channel)
+        {
+            auto& state = baudRateState[channel];
+
+            if (!state.index || state.switchPending || state.verifyPending || (state.step != negotiation_t::none))
+                return;
+
+            if ((state.errors < OPENDECK_MIDI_FORMAT_FALLBACK_ERRORS) && ((core::timing::currentRunTimeMs() - state.lastValid) < OPENDECK_MIDI_FORMAT_LINK_TIMEOUT))
+                return;
+
+            if (state.initiator)
+                negotiateBaudRate(channel);
+            else
+                setBaudRate(channel, 0);
+        }
+
+        ///
+        /// \brief Sends the next ping once the previous one has returned or has been lost.
+        /// Only the board which has started the baud rate negotiation pings the other boards,
+        /// and only if its request has been returned.
+        ///
+        void checkPing(uint8_t channel)
+        {
+            auto& state = pingState[channel];
+            auto  now   = core::timing::currentRunTimeMs();
+
+            if (!baudRateState[channel].linked || baudRateState[channel].switchPending || (baudRateState[channel].step != negotiation_t::none))
+                return;
+
+            if ((now - state.sendTime) < OPENDECK_MIDI_FORMAT_PING_INTERVAL)
+                return;
+
+            if (state.pending)
+                linkStats[channel].pingsLost++;
 
-                case 4:
-                    //xor byte - do nothing
+            state.pending  = true;
+            state.sequence = (state.sequence + 1) & 0x7F;
+            state.sendTime   = now;
+            state.sendTimeUs = Board::runTimeUs();
+
+            sendCommand(channel, command_t::ping, state.sequence, 0);
+        }
+
+        void handlePing(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            auto& state = pingState[channel];
+
+            //pings are never passed on by the board which sends them, even the lost ones
+            if (!baudRateState[channel].initiator)
+            {
+                sendCommand(channel, command_t::ping, USBMIDIpacket.Data1, (USBMIDIpacket.Data2 + 1) & 0x7F);
+                return;
+            }
+
+            if (!state.pending || (USBMIDIpacket.Data1 != state.sequence))
+                return;
+
+            state.pending               = false;
+            linkStats[channel].pingTime = Board::runTimeUs() - state.sendTimeUs;
+            linkStats[channel].pingHops = USBMIDIpacket.Data2;
+            linkStats[channel].hopTime  = linkStats[channel].pingTime / (USBMIDIpacket.Data2 + 1);
+        }
+
+        void handleBaudRateCommand(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            auto& state = baudRateState[channel];
+            auto  now   = core::timing::currentRunTimeMs();
+
+            bool patternValid = (USBMIDIpacket.Data1 == VERIFY_PATTERN[0]) &&
+                                (USBMIDIpacket.Data2 == VERIFY_PATTERN[1]) &&
+                                (USBMIDIpacket.Data3 == VERIFY_PATTERN[2]);
+
+            //commands returned to initiating board complete the current step
+            //all other boards pass the commands on to the next one
+            switch (static_cast<command_t>(USBMIDIpacket.Event))
+            {
+            case command_t::baudRateReset:
+            {
+                if (state.initiator)
                     break;
-                }
+
+                sendCommand(channel, command_t::baudRateReset);
+                state.verifyPending = false;
+                setBaudRate(channel, 0);
             }
+            break;
 
-            if (readBytes[static_cast<uint8_t>(packet_t::dataXor)] == (USBMIDIpacket.Event ^ USBMIDIpacket.Data1 ^ USBMIDIpacket.Data2 ^ USBMIDIpacket.Data3))
+            case command_t::baudRateRequest:
             {
-                clearIncomingCount();
+                uint8_t index   = USBMIDIpacket.Data1;
+                uint8_t address = USBMIDIpacket.Data2;
 
-                if (packetType == packetType_t::internalCommand)
+                if (state.initiator)
                 {
-                    switch (static_cast<command_t>(USBMIDIpacket.Event))
-                    {
-                    case command_t::fwUpdated:
-                        Board::io::ledFlashStartup(true);
+                    if (state.step != negotiation_t::request)
                         break;
 
-                    case command_t::fwNotUpdated:
-                        Board::io::ledFlashStartup(false);
-                        break;
+                    //request is returned with address which would be assigned to the next board
+                    state.nodes  = address ? address - 1 : 0;
+                    state.linked = true;
 
-                    case command_t::btldrReboot:
-                        Board::reboot(Board::rebootType_t::rebootBtldr);
+                    state.target = index < state.maxIndex ? index : state.maxIndex;
+
+                    if (!state.target)
+                    {
+                        state.step = negotiation_t::none;
                         break;
+                    }
 
-                    case command_t::appReboot:
-                        Board::reboot(Board::rebootType_t::rebootApp);
+                    state.step     = negotiation_t::switching;
+                    state.stepTime = now;
+                    sendCommand(channel, command_t::baudRateSwitch, state.target);
+                }
+                else
+                {
+                    uint8_t maxIndex = maxBaudRateIndex();
+
+                    //boards beyond the addressable range stay without address
+                    state.address = address <= OPENDECK_MIDI_FORMAT_MAX_NODES ? address : 0;
+
+                    if (address <= OPENDECK_MIDI_FORMAT_MAX_NODES)
+                        address++;
+
+                    sendCommand(channel, command_t::baudRateRequest, index < maxIndex ? index : maxIndex, address);
+                }
+            }
+            break;
+
+            case command_t::baudRateSwitch:
+            {
+                uint8_t index = USBMIDIpacket.Data1;
+
+                if (state.initiator)
+                {
+                    if ((state.step != negotiation_t::switching) || (index != state.target))
                         break;
 
-                    default:
+                    setBaudRate(channel, index);
+                    state.step        = negotiation_t::verify;
+                    state.stepTime    = now;
+                    state.patternSent = false;
+                    sendDeferred(channel);
+                }
+                else
+                {
+                    //rate which isn't supported is never requested - ignore the command
+                    //initiating board will return to default rate after the timeout
+                    if (index > maxBaudRateIndex())
                         break;
+
+                    sendCommand(channel, command_t::baudRateSwitch, index);
+                    setBaudRate(channel, index);
+                    state.target        = index;
+                    state.verifyPending = true;
+                    state.stepTime      = now;
+                }
+            }
+            break;
+
+            case command_t::baudRateVerify:
+            {
+                if (state.initiator)
+                {
+                    if ((state.step == negotiation_t::verify) && patternValid)
+                        state.step = negotiation_t::none;
+                }
+                else if (state.verifyPending)
+                {
+                    if (patternValid)
+                    {
+                        sendCommand(channel, command_t::baudRateVerify, VERIFY_PATTERN[0], VERIFY_PATTERN[1], VERIFY_PATTERN[2]);
+                        state.verifyPending = false;
+                    }
+                    else
+                    {
+                        //don't pass the pattern on so that initiating board times out as well
+                        baudRateFailed(channel);
                     }
                 }
+            }
+            break;
+
+            default:
+                break;
+            }
+        }
+
+        void handleInternalCommand(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            switch (static_cast<command_t>(USBMIDIpacket.Event))
+            {
+            case command_t::fwUpdated:
+                Board::io::ledFlashStartup(true);
+                break;
+
+            case command_t::fwNotUpdated:
+                Board::io::ledFlashStartup(false);
+                break;
+
+            case command_t::btldrReboot:
+                Board::reboot(Board::rebootType_t::rebootBtldr);
+                break;
+
+            case command_t::appReboot:
+                Board::reboot(Board::rebootType_t::rebootApp);
+                break;
+
+            case command_t::ping:
+                handlePing(channel, USBMIDIpacket);
+                break;
+
+            default:
+                handleBaudRateCommand(channel, USBMIDIpacket);
+                break;
+            }
+        }
+    }    // namespace
+
+    uint8_t crc8(const uint8_t* data, uint8_t size)
+    {
+        uint8_t crc = 0;
+
+        for (int i = 0; i < size; i++)
+            crc = crcUpdate(crc, data[i]);
+
+        return crc;
+    }
+
+    bool write(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t packetType)
+    {
+        if (channel >= UART_INTERFACES)
+            return false;
+
+        //nothing is written until the rate is switched
+        if (baudRateState[channel].switchPending)
+            return false;
+
+        //the other side might already be using different rate
+        switch (baudRateState[channel].step)
+        {
+        case negotiation_t::reset:
+        case negotiation_t::switching:
+        {
+            if (packetType != packetType_t::internalCommand)
+                return false;
+        }
+        break;
+
+        default:
+            break;
+        }
+
+        auto& batch = pending[channel];
+
+        //packets have to be sent in the same order in which they're written
+        if (batch.count && (batch.packetType != packetType))
+            sendPending(channel);
+
+        if (!isBatchable(packetType))
+        {
+            uint8_t crc = 0;
+
+            writeFrameByte(channel, crc, static_cast<uint8_t>(packetType));
+            writePacket(channel, crc, USBMIDIpacket);
+            Board::UART::write(channel, crc);
+            linkStats[channel].framesSent++;
+
+            return true;
+        }
+
+        batch.packetType              = packetType;
+        batch.packets[batch.count++] = USBMIDIpacket;
+
+        if (batch.count == OPENDECK_MIDI_FORMAT_BATCH_SIZE)
+            sendPending(channel);
+
+        return true;
+    }
+
+    void flush(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return;
+
+        //while the data is being sent, keep collecting packets
+        //packets are also kept until the pending rate switch is done
+        if (Board::UART::isTxEmpty(channel) && !baudRateState[channel].switchPending)
+            sendPending(channel);
+    }
+
+    size_t pendingBytes(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return 0;
+
+        switch (pending[channel].count)
+        {
+        case 0:
+            return 0;
+
+        case 1:
+            return OPENDECK_MIDI_FORMAT_PACKET_SIZE;
+
+        default:
+            return static_cast<uint8_t>(batch_t::AMOUNT) + (pending[channel].count * 4) + 1;
+        }
+    }
+
+    void negotiateBaudRate(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return;
+
+        auto& state = baudRateState[channel];
+
+        state.initiator     = true;
+        state.linked        = false;
+        state.verifyPending = false;
+        state.maxIndex      = maxBaudRateIndex();
+        state.attempts      = 0;
+
+        //pings are sent again once the negotiation is done
+        pingState[channel].pending = false;
+
+        //the other side could still be using the rate negotiated before this board has been restarted
+        //reset command is sent using each higher rate first, followed by the request
+        //request is sent even if the default rate is the only one supported since it assigns the addresses
+        state.address = 0;
+        state.nodes   = 0;
+        state.step    = negotiation_t::reset;
+        setBaudRate(channel, state.maxIndex);
+        sendDeferred(channel);
+    }
+
+    void resetBaudRate(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return;
+
+        auto& state = baudRateState[channel];
+
+        state.initiator     = false;
+        state.linked        = false;
+        state.step          = negotiation_t::none;
+        state.verifyPending = false;
+        state.switchPending = false;
+
+        if (!state.index)
+            return;
+
+        sendCommand(channel, command_t::baudRateReset);
+        setBaudRate(channel, 0);
+    }
+
+    uint8_t address(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return 0;
+
+        return baudRateState[channel].address;
+    }
+
+    uint8_t nodes(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return 0;
+
+        return baudRateState[channel].nodes;
+    }
+
+    uint32_t baudRate(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return 0;
+
+        return baudRates[baudRateState[channel].index];
+    }
+
+    bool stats(uint8_t channel, stats_t& stats)
+    {
+        if (channel >= UART_INTERFACES)
+            return false;
+
+        linkStats[channel].rxOverflows += Board::UART::rxDropped(channel);
+        stats = linkStats[channel];
+
+        return true;
+    }
+
+    void resetStats(uint8_t channel)
+    {
+        if (channel >= UART_INTERFACES)
+            return;
+
+        auto& stats = linkStats[channel];
+
+        //drop the overflows counted so far as well
+        Board::UART::rxDropped(channel);
+
+        stats.framesSent     = 0;
+        stats.framesReceived = 0;
+        stats.crcErrors      = 0;
+        stats.resyncs        = 0;
+        stats.rxOverflows    = 0;
+        stats.pingsLost      = 0;
+    }
+
+    bool read(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t& packetType)
+    {
+        if (channel >= UART_INTERFACES)
+            return false;
+
+        auto& state = parser[channel];
+
+        checkBaudRate(channel);
+        checkLink(channel);
+        sendDeferred(channel);
+        checkPing(channel);
+
+        //report the rest of the already decoded frame or any frame left in the buffer first
+        if (state.frameSize || findFrame(channel))
+        {
+            reportPacket(state, USBMIDIpacket, packetType);
+
+            if (packetType == packetType_t::internalCommand)
+                handleInternalCommand(channel, USBMIDIpacket);
+
+            return true;
+        }
+
+        uint8_t value;
+
+        while (Board::UART::read(channel, value))
+        {
+            if (!state.count && !isStartMarker(value))
+                continue;
+
+            state.bytes[(state.start + state.count++) & (PARSER_BUFFER_SIZE - 1)] = value;
+
+            if (findFrame(channel))
+            {
+                reportPacket(state, USBMIDIpacket, packetType);
+
+                if (packetType == packetType_t::internalCommand)
+                    handleInternalCommand(channel, USBMIDIpacket);
 
                 return true;
             }
@@ -191,6 +984,21 @@ namespace OpenDeckMIDIformat
 
         return false;
     }
+
+    size_t readAll(uint8_t channel, packetHandler_t handler)
+    {
+        MIDI::USBMIDIpacket_t USBMIDIpacket;
+        packetType_t          packetType;
+        size_t                count = 0;
+
+        while (read(channel, USBMIDIpacket, packetType))
+        {
+            handler(USBMIDIpacket, packetType);
+            count++;
+        }
+
+        return count;
+    }
 }    // namespace OpenDeckMIDIformat
 
 #endif
@@ -20,6 +20,58 @@ limitations under the License.
 
 #include "midi/src/MIDI.h"
 
+///
+/// \brief Largest number of USB MIDI packets sent in single batch frame.
+/// Largest frame (header, packets and checksum) must fit in 32 bytes.
+///
+#define OPENDECK_MIDI_FORMAT_BATCH_SIZE 7
+
+///
+/// \brief Size in bytes of the frame holding single packet.
+///
+#define OPENDECK_MIDI_FORMAT_PACKET_SIZE 6
+
+#ifndef UART_BAUDRATE_MIDI_OD_MAX
+///
+/// \brief Highest baud rate which can be negotiated on UART channels using OpenDeck format.
+/// Can be lowered in board Hardware.h, for instance when longer cables are used between the boards.
+///
+#define UART_BAUDRATE_MIDI_OD_MAX 1000000
+#endif
+
+///
+/// \brief Time in milliseconds after which single step of baud rate negotiation is considered failed.
+///
+#define OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT 100
+
+///
+/// \brief Number of times baud rate request is sent before the negotiation is abandoned.
+///
+#define OPENDECK_MIDI_FORMAT_BAUD_RATE_ATTEMPTS 10
+
+///
+/// \brief Highest address which can be assigned to a board in daisy chain.
+/// Address is sent in the cable number of MIDI packets.
+///
+#define OPENDECK_MIDI_FORMAT_MAX_NODES 15
+
+///
+/// \brief Time in milliseconds between two pings sent by the board which has started the baud rate negotiation.
+/// Ping which doesn't return before the next one is sent is considered lost.
+///
+#define OPENDECK_MIDI_FORMAT_PING_INTERVAL 1000
+
+///
+/// \brief Number of consecutive invalid frames after which the board returns to UART_BAUDRATE_MIDI_OD.
+///
+#define OPENDECK_MIDI_FORMAT_FALLBACK_ERRORS 8
+
+///
+/// \brief Time in milliseconds without any valid frame after which the board returns to UART_BAUDRATE_MIDI_OD.
+/// Pings keep the link busy once the rate is negotiated, so the time passes only if the other side uses different rate.
+///
+#define OPENDECK_MIDI_FORMAT_LINK_TIMEOUT (3 * OPENDECK_MIDI_FORMAT_PING_INTERVAL)
+
 namespace OpenDeckMIDIformat
 {
     ///
@@ -30,7 +82,14 @@ namespace OpenDeckMIDIformat
         fwUpdated,       ///< Signal to USB link MCU that the firmware has been updated on main MCU.
         fwNotUpdated,    ///< Signal to USB link MCU that the firmware hasn't been updated on main MCU.
         btldrReboot,     ///< Signal to USB link MCU to reboot to bootloader mode.
-        appReboot        ///< Signal to USB link MCU to reboot to application mode.
+        appReboot,          ///< Signal to USB link MCU to reboot to application mode.
+        baudRateReset,      ///< Signal to the other side to return to UART_BAUDRATE_MIDI_OD.
+        baudRateRequest,    ///< Request for the highest baud rate supported by all the boards. Data1 holds baud rate index,
+                            ///< Data2 holds the address assigned to the board receiving the request.
+        baudRateSwitch,     ///< Signal to the other side to switch to baud rate specified in Data1.
+        baudRateVerify,     ///< Test pattern sent once the new baud rate is used.
+        ping                ///< Round-trip time measurement. Data1 holds sequence number, Data2 holds the number
+                            ///< of boards which have passed the ping on.
     };
 
     enum class packetType_t : uint8_t
@@ -39,14 +98,43 @@ namespace OpenDeckMIDIformat
                                    ///< Indicates start of MIDI data when OpenDeck MIDI format is used.
         internalCommand = 0xF2,    ///< Internal command used for target MCU <> USB link communication.
                                    ///< Indicates start of internal data when OpenDeck MIDI format is used.
-        midiDaisyChain = 0xF3      ///< MIDI packet sent from master to slaves in daisy chain configuration.
+        midiDaisyChain = 0xF3,     ///< MIDI packet sent from master to slaves in daisy chain configuration.
                                    ///< Indicates that origin of MIDI message is OpenDeck master in daisy-chain configuration.
                                    ///< Since all the messages are forwarded between slaves, avoid routing message from
                                    ///< last slave back to USB master (filter out).
+                                   ///< Cable number holds the address of the destination board, or 0 for all of them.
+                                   ///< In MIDI packets sent by slaves, cable number holds the address of originating board.
+        batch = 0xF4               ///< Several MIDI packets of the same type sent in single frame.
+                                   ///< Marker is followed by type of contained packets, number of packets,
+                                   ///< packets themselves and checksum. Never reported by read functions -
+                                   ///< contained packets are reported one by one using their own type.
     };
 
+    ///
+    /// \brief Structure holding statistics about traffic on single UART channel.
+    ///
+    typedef struct
+    {
+        uint32_t framesSent;        ///< Number of sent frames.
+        uint32_t framesReceived;    ///< Number of received frames with valid checksum.
+        uint32_t crcErrors;         ///< Number of received frames discarded because of checksum mismatch.
+        uint32_t resyncs;           ///< Number of times the parser had to search for the next start marker.
+        uint32_t rxOverflows;       ///< Number of received bytes dropped because RX buffer was full or lost by UART/DMA reception.
+        uint32_t pingsLost;         ///< Number of pings which haven't returned within OPENDECK_MIDI_FORMAT_PING_INTERVAL.
+        uint32_t pingTime;          ///< Round-trip time in microseconds of the last returned ping.
+        uint8_t  pingHops;          ///< Number of boards which have passed the last returned ping on.
+        uint32_t hopTime;           ///< Time in microseconds the last returned ping has needed on average to reach the next board.
+    } stats_t;
+
+    ///
+    /// \brief Handler called for each packet decoded using readAll.
+    ///
+    using packetHandler_t = void (*)(MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t packetType);
+
     ///
     /// \brief Used to read data using custom OpenDeck format from UART interface.
+    /// Incoming bytes are consumed until complete packet is decoded or until there are no more received bytes.
+    /// Incomplete packet is kept and completed once the rest of it is received.
     /// @param [in] channel         UART channel on MCU.
     /// @param [in] USBMIDIpacket   Pointer to structure holding MIDI data being read.
     /// @param [in] packetType      Pointer to variable in which read packet type is being stored.
@@ -54,12 +142,111 @@ namespace OpenDeckMIDIformat
     ///
     bool read(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t& packetType);
 
+    ///
+    /// \brief Decodes all the complete packets currently received on UART interface.
+    /// @param [in] channel     UART channel on MCU.
+    /// @param [in] handler     Handler called for each decoded packet.
+    /// \returns Number of decoded packets.
+    ///
+    size_t readAll(uint8_t channel, packetHandler_t handler);
+
     ///
     /// \brief Used to write data using custom OpenDeck format to UART interface.
+    /// MIDI packets aren't sent right away: they're collected and sent together in single batch frame
+    /// once the frame is full, once the packet of different type is written or once flush is called
+    /// while UART interface is idle. Internal commands are always sent immediately.
     /// @param [in] channel         UART channel on MCU.
     /// @param [in] USBMIDIpacket   Pointer to structure holding MIDI data to write.
     /// @param [in] packetType      Type of OpenDeck packet to send.
     /// \returns True on success, false otherwise.
     ///
     bool write(uint8_t channel, MIDI::USBMIDIpacket_t& USBMIDIpacket, packetType_t packetType);
+
+    ///
+    /// \brief Sends all the collected MIDI packets if UART interface has nothing else to send.
+    /// Should be called after each pass through the main loop.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    void flush(uint8_t channel);
+
+    ///
+    /// \brief Returns the number of bytes needed to send all the collected MIDI packets.
+    /// Writing another packet increases this number by OPENDECK_MIDI_FORMAT_PACKET_SIZE at most.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    size_t pendingBytes(uint8_t channel);
+
+    ///
+    /// \brief Starts the negotiation of the highest baud rate supported on both sides of UART channel.
+    /// Channel must be initialized with UART_BAUDRATE_MIDI_OD baud rate before calling this function.
+    /// Negotiation is performed using internal commands which are forwarded by every board which receives
+    /// them, so the same sequence works for USB link and for boards in daisy chain. Rate is checked using
+    /// test pattern once both sides have switched to it - if the check fails, next lower rate is tried.
+    /// Request also assigns the addresses to the boards in the order in which they receive it.
+    /// Negotiation proceeds during subsequent calls to read functions. Rate is switched only once
+    /// everything written using the old rate has been sent, and nothing can be written until then.
+    /// If the link stops working while higher rate is used (OPENDECK_MIDI_FORMAT_FALLBACK_ERRORS invalid
+    /// frames in a row or no valid frame for OPENDECK_MIDI_FORMAT_LINK_TIMEOUT milliseconds), every board
+    /// returns to UART_BAUDRATE_MIDI_OD and the initiating board starts the negotiation again.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    void negotiateBaudRate(uint8_t channel);
+
+    ///
+    /// \brief Stops the negotiation on specified channel and returns to UART_BAUDRATE_MIDI_OD.
+    /// Other side is signaled to do the same if different rate has been negotiated. Afterwards,
+    /// the board only passes on the negotiation started by other boards.
+    /// Should be called before the board reboots into a firmware which doesn't negotiate the baud rate.
+    /// Reset command is sent using the current rate - caller has to wait until UART TX is empty before rebooting.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    void resetBaudRate(uint8_t channel);
+
+    ///
+    /// \brief Returns the address assigned to this board on specified UART channel.
+    /// @param [in] channel UART channel on MCU.
+    /// \returns Address in range 1 - OPENDECK_MIDI_FORMAT_MAX_NODES, or 0 if the address isn't assigned.
+    ///
+    uint8_t address(uint8_t channel);
+
+    ///
+    /// \brief Returns the number of other boards found on specified UART channel during negotiation.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    uint8_t nodes(uint8_t channel);
+
+    ///
+    /// \brief Returns the baud rate currently used on specified UART channel.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    uint32_t baudRate(uint8_t channel);
+
+    ///
+    /// \brief Retrieves the traffic statistics collected on specified UART channel.
+    /// Board which has started the baud rate negotiation on the channel also pings the other boards
+    /// every OPENDECK_MIDI_FORMAT_PING_INTERVAL milliseconds. Each board passes the ping on, so the
+    /// measured time covers all the hops to the last board and back. Since the ping travels over
+    /// one link more than there are boards passing it on, the latency of single board is reported
+    /// as the round-trip time divided by the number of links.
+    /// @param [in]     channel UART channel on MCU.
+    /// @param [in,out] stats   Structure in which statistics are stored.
+    /// \returns True on success, false if the channel is invalid.
+    ///
+    bool stats(uint8_t channel, stats_t& stats);
+
+    ///
+    /// \brief Clears the traffic counters collected on specified UART channel.
+    /// Result of the last ping is kept.
+    /// @param [in] channel UART channel on MCU.
+    ///
+    void resetStats(uint8_t channel);
+
+    ///
+    /// \brief Calculates CRC-8 (polynomial 0x07) used to verify OpenDeck packets.
+    /// Checksum covers all the preceding bytes of the frame, including the start marker.
+    /// @param [in] data    Pointer to data for which checksum is calculated.
+    /// @param [in] size    Number of bytes.
+    /// \returns Calculated checksum.
+    ///
+    uint8_t crc8(const uint8_t* data, uint8_t size);
 }    // namespace OpenDeckMIDIformat
\ No newline at end of file
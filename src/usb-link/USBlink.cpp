@@ -19,25 +19,30 @@ limitations under the License.
 #include "board/Board.h"
 #include "common/OpenDeckMIDIformat/OpenDeckMIDIformat.h"
 
-namespace
-{
-    MIDI::USBMIDIpacket_t            USBMIDIpacket;
-    OpenDeckMIDIformat::packetType_t packetType;
-}    // namespace
-
 int main(void)
 {
     Board::init();
 
     while (1)
     {
-        if (Board::USB::readMIDI(USBMIDIpacket))
-            OpenDeckMIDIformat::write(UART_USB_LINK_CHANNEL, USBMIDIpacket, OpenDeckMIDIformat::packetType_t::midi);
+        //forward all received packets at once
+        //packets which can't be written to UART are kept for the next pass
+        MIDI::USBMIDIpacket_t* packets;
+        size_t                 count   = Board::USB::peekMIDI(packets);
+        size_t                 written = 0;
+
+        while ((written < count) && OpenDeckMIDIformat::write(UART_USB_LINK_CHANNEL, packets[written], OpenDeckMIDIformat::packetType_t::midi))
+            written++;
 
-        if (OpenDeckMIDIformat::read(UART_USB_LINK_CHANNEL, USBMIDIpacket, packetType))
-        {
+        Board::USB::releaseMIDI(written);
+        OpenDeckMIDIformat::flush(UART_USB_LINK_CHANNEL);
+
+        //pass all packets received from main MCU to host
+        OpenDeckMIDIformat::readAll(UART_USB_LINK_CHANNEL, [](MIDI::USBMIDIpacket_t& USBMIDIpacket, OpenDeckMIDIformat::packetType_t packetType) {
             if (packetType != OpenDeckMIDIformat::packetType_t::internalCommand)
                 Board::USB::writeMIDI(USBMIDIpacket);
-        }
+        });
+
+        Board::USB::flushMIDI();
     }
 }
\ No newline at end of file
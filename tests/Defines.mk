@@ -1,7 +1,9 @@
 #slightly modified Defines.mk from src directory
 
 #common
-DEFINES :=
+DEFINES := \
+UART_BAUDRATE_MIDI_STD=31250 \
+UART_BAUDRATE_MIDI_OD=38400
 
 BOARD_DIR := $(subst fw_,,$(TARGETNAME))
 
@@ -0,0 +1,287 @@
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "interface/analog/Analog.h"
+#include "interface/digital/output/leds/LEDs.h"
+#include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
+#include "database/Database.h"
+#include "midi/src/MIDI.h"
+#include "core/src/general/Timing.h"
+#include "core/src/general/Helpers.h"
+#include "stubs/database/DB_ReadWrite.h"
+#include "board/Board.h"
+
+namespace
+{
+    uint32_t              messageCounter = 0;
+    MIDI::USBMIDIpacket_t midiPacket[MAX_NUMBER_OF_ANALOG];
+
+    void resetReceived()
+    {
+        for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+        {
+            midiPacket[i].Event = 0;
+            midiPacket[i].Data1 = 0;
+            midiPacket[i].Data2 = 0;
+            midiPacket[i].Data3 = 0;
+        }
+
+        messageCounter = 0;
+    }
+
+    bool midiDataHandler(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+    {
+        midiPacket[messageCounter].Event = USBMIDIpacket.Event;
+        midiPacket[messageCounter].Data1 = USBMIDIpacket.Data1;
+        midiPacket[messageCounter].Data2 = USBMIDIpacket.Data2;
+        midiPacket[messageCounter].Data3 = USBMIDIpacket.Data3;
+
+        messageCounter++;
+
+        return true;
+    }
+
+    Database              database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
+    MIDI                  midi;
+    Interface::MIDIOutput output(midi);
+    ComponentInfo         cInfo;
+
+#ifdef LEDS_SUPPORTED
+    Interface::digital::output::LEDs leds = Interface::digital::output::LEDs(database);
+#endif
+
+#ifdef DISPLAY_SUPPORTED
+    Interface::Display display(database);
+#endif
+
+#ifdef LEDS_SUPPORTED
+#ifndef DISPLAY_SUPPORTED
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, leds, cInfo);
+#else
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, leds, display, cInfo);
+#endif
+#else
+#ifdef DISPLAY_SUPPORTED
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, display, cInfo);
+#else
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, cInfo);
+#endif
+#endif
+}    // namespace
+
+namespace Board
+{
+    namespace detail
+    {
+        uint32_t adcReturnValue;
+    }
+
+    namespace io
+    {
+        int16_t getAnalogValue(uint8_t analogID)
+        {
+            return detail::adcReturnValue;
+        }
+
+        uint8_t getAnalogChangeMask(uint8_t group)
+        {
+            return 0xFF;
+        }
+
+        bool setAnalogFastLane(uint8_t analogID, bool state)
+        {
+            return true;
+        }
+
+        void setAnalogChangeThreshold(uint8_t analogID, uint8_t threshold)
+        {
+        }
+
+        void setAnalogBurst(uint8_t analogID, bool state)
+        {
+        }
+
+        void continueAnalogReadout()
+        {
+        }
+
+        bool isAnalogDataAvailable()
+        {
+            return true;
+        }
+
+        uint8_t getRGBID(uint8_t ledID)
+        {
+            return 0;
+        }
+
+        uint8_t getRGBaddress(uint8_t rgbID, Interface::digital::output::LEDs::rgbIndex_t index)
+        {
+            return 0;
+        }
+
+        bool setLEDfadeSpeed(uint8_t transitionSpeed)
+        {
+            return true;
+        }
+
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+
+        void writeLEDstate(uint8_t ledID, bool state)
+        {
+        }
+    }    // namespace io
+}    // namespace Board
+
+TEST_SETUP()
+{
+    //init checks - no point in running further tests if these conditions fail
+    TEST_ASSERT(database.init() == true);
+    TEST_ASSERT(database.isSignatureValid() == true);
+    TEST_ASSERT(database.factoryReset(LESSDB::factoryResetType_t::full) == true);
+    midi.handleUSBwrite(midiDataHandler);
+
+    analog.disableExpFiltering();
+
+    //use single fsr component
+    TEST_ASSERT(database.update(Database::Section::analog_t::enable, 0, 1) == true);
+    TEST_ASSERT(database.update(Database::Section::analog_t::type, 0, static_cast<int32_t>(Interface::analog::Analog::type_t::fsr)) == true);
+
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+        analog.debounceReset(i);
+
+    core::timing::detail::rTime_ms = 0;
+    Board::detail::adcReturnValue  = 0;
+    analog.update();
+    resetReceived();
+}
+
+namespace
+{
+    uint8_t velocity(uint32_t pressure)
+    {
+        return core::misc::mapRange(CONSTRAIN(pressure, static_cast<uint32_t>(FSR_MIN_VALUE), static_cast<uint32_t>(FSR_MAX_VALUE)), static_cast<uint32_t>(FSR_MIN_VALUE), static_cast<uint32_t>(FSR_MAX_VALUE), static_cast<uint32_t>(0), static_cast<uint32_t>(MIDI_7_BIT_VALUE_MAX));
+    }
+
+    uint8_t aftertouch(uint32_t pressure)
+    {
+        return core::misc::mapRange(CONSTRAIN(pressure, static_cast<uint32_t>(FSR_MIN_VALUE), static_cast<uint32_t>(AFTERTOUCH_MAX_VALUE)), static_cast<uint32_t>(FSR_MIN_VALUE), static_cast<uint32_t>(AFTERTOUCH_MAX_VALUE), static_cast<uint32_t>(0), static_cast<uint32_t>(MIDI_7_BIT_VALUE_MAX));
+    }
+
+    void readout(uint32_t pressure)
+    {
+        Board::detail::adcReturnValue = pressure;
+        analog.update();
+    }
+
+    bool isNoteOff(MIDI::USBMIDIpacket_t& packet)
+    {
+        uint8_t midiMessage = packet.Event << 4;
+
+        if (midiMessage == static_cast<uint8_t>(MIDI::messageType_t::noteOff))
+            return true;
+
+        return (midiMessage == static_cast<uint8_t>(MIDI::messageType_t::noteOn)) && (packet.Data3 == 0);
+    }
+}    // namespace
+
+TEST_CASE(ImmediateVelocity)
+{
+    //peak window is disabled by default - first pressure value should be used
+    readout(FSR_MIN_VALUE + 50);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT((midiPacket[0].Event << 4) == static_cast<uint8_t>(MIDI::messageType_t::noteOn));
+    TEST_ASSERT(midiPacket[0].Data3 == velocity(FSR_MIN_VALUE + 50));
+
+    //no new messages while pressure rises
+    resetReceived();
+    readout(FSR_MIN_VALUE + 100);
+    TEST_ASSERT(messageCounter == 0);
+
+    //release
+    readout(0);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(isNoteOff(midiPacket[0]));
+}
+
+TEST_CASE(PeakVelocity)
+{
+    TEST_ASSERT(database.update(Database::Section::analog_t::peakWindow, 0, 10) == true);
+
+    //rising pressure within the window shouldn't send anything
+    readout(FSR_MIN_VALUE + 20);
+    core::timing::detail::rTime_ms += 2;
+    readout(FSR_MIN_VALUE + 150);
+    core::timing::detail::rTime_ms += 2;
+    readout(FSR_MIN_VALUE + 200);
+    TEST_ASSERT(messageCounter == 0);
+
+    //once the pressure starts dropping, note on with peak velocity should be sent
+    core::timing::detail::rTime_ms += 1;
+    readout(FSR_MIN_VALUE + 180);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT((midiPacket[0].Event << 4) == static_cast<uint8_t>(MIDI::messageType_t::noteOn));
+    TEST_ASSERT(midiPacket[0].Data3 == velocity(FSR_MIN_VALUE + 200));
+
+    resetReceived();
+    readout(0);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(isNoteOff(midiPacket[0]));
+
+    //pressure which keeps rising should result in note on once the window expires
+    resetReceived();
+
+    for (int i = 0; i < 10; i++)
+    {
+        readout(FSR_MIN_VALUE + 10 + (i * 20));
+        TEST_ASSERT(messageCounter == 0);
+        core::timing::detail::rTime_ms++;
+    }
+
+    readout(FSR_MIN_VALUE + 250);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data3 == velocity(FSR_MIN_VALUE + 250));
+}
+
+TEST_CASE(Aftertouch)
+{
+    TEST_ASSERT(database.update(Database::Section::analog_t::aftertouchType, 0, static_cast<int32_t>(Interface::analog::Analog::aftertouchType_t::channel)) == true);
+
+    readout(FSR_MIN_VALUE + 100);
+    TEST_ASSERT(messageCounter == 1);
+
+    //first aftertouch message is sent once the pressure changes after the interval
+    resetReceived();
+    core::timing::detail::rTime_ms += FSR_AFTERTOUCH_INTERVAL;
+    readout(FSR_MIN_VALUE + 200);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT((midiPacket[0].Event << 4) == static_cast<uint8_t>(MIDI::messageType_t::afterTouchChannel));
+    TEST_ASSERT(midiPacket[0].Data2 == aftertouch(FSR_MIN_VALUE + 200));
+
+    //further changes are rate limited
+    resetReceived();
+    core::timing::detail::rTime_ms += 1;
+    readout(FSR_MIN_VALUE + 300);
+    TEST_ASSERT(messageCounter == 0);
+
+    //same value is sent once the interval expires even without new change
+    core::timing::detail::rTime_ms += FSR_AFTERTOUCH_INTERVAL;
+    analog.update();
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == aftertouch(FSR_MIN_VALUE + 300));
+
+    //changes smaller than threshold are ignored
+    resetReceived();
+    core::timing::detail::rTime_ms += FSR_AFTERTOUCH_INTERVAL;
+    readout(FSR_MIN_VALUE + 301);
+    TEST_ASSERT(messageCounter == 0);
+
+    //aftertouch is reset on release
+    readout(0);
+    TEST_ASSERT(messageCounter == 2);
+    TEST_ASSERT((midiPacket[0].Event << 4) == static_cast<uint8_t>(MIDI::messageType_t::afterTouchChannel));
+    TEST_ASSERT(midiPacket[0].Data2 == 0);
+    TEST_ASSERT(isNoteOff(midiPacket[1]));
+}
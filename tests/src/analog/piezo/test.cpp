@@ -0,0 +1,280 @@
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "interface/analog/Analog.h"
+#include "interface/digital/output/leds/LEDs.h"
+#include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
+#include "database/Database.h"
+#include "midi/src/MIDI.h"
+#include "core/src/general/Timing.h"
+#include "core/src/general/Helpers.h"
+#include "stubs/database/DB_ReadWrite.h"
+#include "board/Board.h"
+
+namespace
+{
+    uint32_t              messageCounter = 0;
+    MIDI::USBMIDIpacket_t midiPacket[MAX_NUMBER_OF_ANALOG];
+
+    void resetReceived()
+    {
+        for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+        {
+            midiPacket[i].Event = 0;
+            midiPacket[i].Data1 = 0;
+            midiPacket[i].Data2 = 0;
+            midiPacket[i].Data3 = 0;
+        }
+
+        messageCounter = 0;
+    }
+
+    bool midiDataHandler(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+    {
+        midiPacket[messageCounter].Event = USBMIDIpacket.Event;
+        midiPacket[messageCounter].Data1 = USBMIDIpacket.Data1;
+        midiPacket[messageCounter].Data2 = USBMIDIpacket.Data2;
+        midiPacket[messageCounter].Data3 = USBMIDIpacket.Data3;
+
+        messageCounter++;
+
+        return true;
+    }
+
+    Database              database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
+    MIDI                  midi;
+    Interface::MIDIOutput output(midi);
+    ComponentInfo         cInfo;
+
+#ifdef LEDS_SUPPORTED
+    Interface::digital::output::LEDs leds = Interface::digital::output::LEDs(database);
+#endif
+
+#ifdef DISPLAY_SUPPORTED
+    Interface::Display display(database);
+#endif
+
+#ifdef LEDS_SUPPORTED
+#ifndef DISPLAY_SUPPORTED
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, leds, cInfo);
+#else
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, leds, display, cInfo);
+#endif
+#else
+#ifdef DISPLAY_SUPPORTED
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, display, cInfo);
+#else
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, cInfo);
+#endif
+#endif
+}    // namespace
+
+namespace Board
+{
+    namespace detail
+    {
+        uint32_t adcReturnValue[MAX_NUMBER_OF_ANALOG];
+    }
+
+    namespace io
+    {
+        int16_t getAnalogValue(uint8_t analogID)
+        {
+            return detail::adcReturnValue[analogID];
+        }
+
+        uint8_t getAnalogChangeMask(uint8_t group)
+        {
+            return 0xFF;
+        }
+
+        bool setAnalogFastLane(uint8_t analogID, bool state)
+        {
+            return true;
+        }
+
+        void setAnalogChangeThreshold(uint8_t analogID, uint8_t threshold)
+        {
+        }
+
+        void setAnalogBurst(uint8_t analogID, bool state)
+        {
+        }
+
+        void continueAnalogReadout()
+        {
+        }
+
+        bool isAnalogDataAvailable()
+        {
+            return true;
+        }
+
+        uint8_t getRGBID(uint8_t ledID)
+        {
+            return 0;
+        }
+
+        uint8_t getRGBaddress(uint8_t rgbID, Interface::digital::output::LEDs::rgbIndex_t index)
+        {
+            return 0;
+        }
+
+        bool setLEDfadeSpeed(uint8_t transitionSpeed)
+        {
+            return true;
+        }
+
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+
+        void writeLEDstate(uint8_t ledID, bool state)
+        {
+        }
+    }    // namespace io
+}    // namespace Board
+
+TEST_SETUP()
+{
+    //init checks - no point in running further tests if these conditions fail
+    TEST_ASSERT(database.init() == true);
+    TEST_ASSERT(database.isSignatureValid() == true);
+    TEST_ASSERT(database.factoryReset(LESSDB::factoryResetType_t::full) == true);
+    midi.handleUSBwrite(midiDataHandler);
+
+    //use two piezo components
+    for (int i = 0; i < 2; i++)
+    {
+        TEST_ASSERT(database.update(Database::Section::analog_t::enable, i, 1) == true);
+        TEST_ASSERT(database.update(Database::Section::analog_t::type, i, static_cast<int32_t>(Interface::analog::Analog::type_t::piezo)) == true);
+        TEST_ASSERT(database.update(Database::Section::analog_t::midiID, i, i) == true);
+        TEST_ASSERT(database.update(Database::Section::analog_t::lowerLimit, i, 10) == true);
+    }
+
+    TEST_ASSERT(database.update(Database::Section::analog_t::piezoSetting, static_cast<size_t>(Interface::analog::Analog::piezoSetting_t::maskTime), 20) == true);
+
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    {
+        Board::detail::adcReturnValue[i] = 0;
+        analog.debounceReset(i);
+    }
+
+    core::timing::detail::rTime_ms = 0;
+    analog.update();
+    resetReceived();
+}
+
+namespace
+{
+    uint8_t level(uint32_t value)
+    {
+        return core::misc::mapRange(value, static_cast<uint32_t>(ADC_MIN_VALUE), static_cast<uint32_t>(ADC_MAX_VALUE), static_cast<uint32_t>(0), static_cast<uint32_t>(MIDI_7_BIT_VALUE_MAX));
+    }
+
+    void readout(uint8_t analogID, uint32_t value)
+    {
+        Board::detail::adcReturnValue[analogID] = value;
+        analog.update();
+    }
+
+    bool isNoteOff(MIDI::USBMIDIpacket_t& packet)
+    {
+        uint8_t midiMessage = packet.Event << 4;
+
+        if (midiMessage == static_cast<uint8_t>(MIDI::messageType_t::noteOff))
+            return true;
+
+        return (midiMessage == static_cast<uint8_t>(MIDI::messageType_t::noteOn)) && (packet.Data3 == 0);
+    }
+}    // namespace
+
+TEST_CASE(Strike)
+{
+    //value below threshold shouldn't trigger anything
+    readout(0, ADC_MAX_VALUE / 16);
+    TEST_ASSERT(messageCounter == 0);
+
+    //peak window is disabled by default - captured value is used immediately
+    readout(0, ADC_MAX_VALUE / 2);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT((midiPacket[0].Event << 4) == static_cast<uint8_t>(MIDI::messageType_t::noteOn));
+    TEST_ASSERT(midiPacket[0].Data2 == 0);
+    TEST_ASSERT(midiPacket[0].Data3 == level(ADC_MAX_VALUE / 2));
+
+    //new strike within mask time should be ignored
+    resetReceived();
+    readout(0, 0);
+    readout(0, ADC_MAX_VALUE);
+    TEST_ASSERT(messageCounter == 0);
+
+    //note off is sent once the mask time expires and the level drops
+    core::timing::detail::rTime_ms += 20;
+    analog.update();
+    TEST_ASSERT(messageCounter == 0);
+
+    readout(0, 0);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(isNoteOff(midiPacket[0]));
+
+    //new strike is accepted now
+    resetReceived();
+    readout(0, ADC_MAX_VALUE);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data3 == MIDI_7_BIT_VALUE_MAX);
+}
+
+TEST_CASE(PeakWindow)
+{
+    TEST_ASSERT(database.update(Database::Section::analog_t::peakWindow, 0, 3) == true);
+
+    readout(0, ADC_MAX_VALUE / 4);
+    core::timing::detail::rTime_ms++;
+    readout(0, ADC_MAX_VALUE / 2);
+    core::timing::detail::rTime_ms++;
+    readout(0, ADC_MAX_VALUE / 3);
+    TEST_ASSERT(messageCounter == 0);
+
+    //highest level within the window is used
+    core::timing::detail::rTime_ms++;
+    analog.update();
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data3 == level(ADC_MAX_VALUE / 2));
+}
+
+TEST_CASE(Crosstalk)
+{
+    //strikes lower than half of the last strike on another piezo are crosstalk
+    TEST_ASSERT(database.update(Database::Section::analog_t::piezoSetting, static_cast<size_t>(Interface::analog::Analog::piezoSetting_t::crosstalk), 64) == true);
+
+    readout(0, ADC_MAX_VALUE);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 0);
+
+    resetReceived();
+    readout(1, ADC_MAX_VALUE / 4);
+    TEST_ASSERT(messageCounter == 0);
+
+    //ignored strike shouldn't result in note off
+    core::timing::detail::rTime_ms += 20;
+    readout(1, 0);
+    TEST_ASSERT(messageCounter == 0);
+
+    //once the mask time of the last strike expires, the same level is accepted
+    readout(1, ADC_MAX_VALUE / 4);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 1);
+    TEST_ASSERT(midiPacket[0].Data3 == level(ADC_MAX_VALUE / 4));
+
+    //strong strike within the mask time isn't crosstalk
+    resetReceived();
+    core::timing::detail::rTime_ms += 20;
+    readout(1, 0);
+    resetReceived();
+    readout(0, 0);
+    readout(0, ADC_MAX_VALUE / 2);
+    resetReceived();
+    readout(1, ADC_MAX_VALUE / 2);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 1);
+}
@@ -3,12 +3,14 @@
 #include "interface/analog/Analog.h"
 #include "interface/digital/output/leds/LEDs.h"
 #include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
 #include "database/Database.h"
 #include "midi/src/MIDI.h"
 #include "core/src/general/Timing.h"
 #include "core/src/general/Helpers.h"
 #include "stubs/database/DB_ReadWrite.h"
 #include "board/Board.h"
+#include "board/common/io/Helpers.h"
 
 namespace
 {
@@ -40,9 +42,10 @@ namespace
         return true;
     }
 
-    Database      database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
-    MIDI          midi;
-    ComponentInfo cInfo;
+    Database              database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
+    MIDI                  midi;
+    Interface::MIDIOutput output(midi);
+    ComponentInfo         cInfo;
 
 #ifdef LEDS_SUPPORTED
     Interface::digital::output::LEDs leds = Interface::digital::output::LEDs(database);
@@ -54,15 +57,15 @@ namespace
 
 #ifdef LEDS_SUPPORTED
 #ifndef DISPLAY_SUPPORTED
-    Interface::analog::Analog analog = Interface::analog::Analog(database, midi, leds, cInfo);
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, leds, cInfo);
 #else
-    Interface::analog::Analog analog = Interface::analog::Analog(database, midi, leds, display, cInfo);
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, leds, display, cInfo);
 #endif
 #else
 #ifdef DISPLAY_SUPPORTED
-    Interface::analog::Analog analog = Interface::analog::Analog(database, midi, display, cInfo);
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, display, cInfo);
 #else
-    Interface::analog::Analog analog = Interface::analog::Analog(database, midi, cInfo);
+    Interface::analog::Analog analog = Interface::analog::Analog(database, output, cInfo);
 #endif
 #endif
 }    // namespace
@@ -72,6 +75,8 @@ namespace Board
     namespace detail
     {
         uint32_t adcReturnValue;
+        uint8_t  adcChangeMask = 0xFF;
+        uint8_t  adcChangeThreshold[MAX_NUMBER_OF_ANALOG];
     }
 
     namespace io
@@ -81,6 +86,25 @@ namespace Board
             return detail::adcReturnValue;
         }
 
+        uint8_t getAnalogChangeMask(uint8_t group)
+        {
+            return detail::adcChangeMask;
+        }
+
+        bool setAnalogFastLane(uint8_t analogID, bool state)
+        {
+            return true;
+        }
+
+        void setAnalogChangeThreshold(uint8_t analogID, uint8_t threshold)
+        {
+            detail::adcChangeThreshold[analogID] = threshold;
+        }
+
+        void setAnalogBurst(uint8_t analogID, bool state)
+        {
+        }
+
         void continueAnalogReadout()
         {
         }
@@ -105,6 +129,10 @@ namespace Board
             return true;
         }
 
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+
         void writeLEDstate(uint8_t ledID, bool state)
         {
         }
@@ -120,6 +148,7 @@ TEST_SETUP()
     midi.handleUSBwrite(midiDataHandler);
 
     analog.disableExpFiltering();
+    Board::detail::adcChangeMask = 0xFF;
 
     for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
         analog.debounceReset(i);
@@ -408,6 +437,187 @@ TEST_CASE(ScalingAndInversion)
     }
 }
 
+TEST_CASE(Curves)
+{
+    using namespace Interface::analog;
+
+    //set known state
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    {
+        //enable all analog components
+        TEST_ASSERT(database.update(Database::Section::analog_t::enable, i, 1) == true);
+
+        //disable invert state
+        TEST_ASSERT(database.update(Database::Section::analog_t::invert, i, 0) == true);
+
+        //configure all analog components as potentiometers with CC MIDI message
+        TEST_ASSERT(database.update(Database::Section::analog_t::type, i, static_cast<int32_t>(Analog::type_t::potentiometerControlChange)) == true);
+
+        //set all lower limits to 0
+        TEST_ASSERT(database.update(Database::Section::analog_t::lowerLimit, i, 0) == true);
+
+        //set all upper limits to MIDI_14_BIT_VALUE_MAX
+        TEST_ASSERT(database.update(Database::Section::analog_t::upperLimit, i, MIDI_14_BIT_VALUE_MAX) == true);
+
+        //use exponential curve
+        TEST_ASSERT(database.update(Database::Section::analog_t::curve, i, static_cast<int32_t>(Analog::curve_t::exp)) == true);
+    }
+
+    auto verify = [](uint32_t adcValue, uint32_t expectedValue) {
+        resetReceived();
+        Board::detail::adcReturnValue = adcValue;
+        analog.update();
+        TEST_ASSERT(messageCounter == MAX_NUMBER_OF_ANALOG);
+
+        for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+        {
+            TEST_ASSERT(midiPacket[i].Data3 == expectedValue);
+            analog.debounceReset(i);
+        }
+    };
+
+    //edges should be preserved
+    verify(0, 0);
+    verify(ADC_MAX_VALUE, MIDI_7_BIT_VALUE_MAX);
+
+    //exponential curve should send lower values than linear one in the middle of the range
+    resetReceived();
+    Board::detail::adcReturnValue = ADC_MAX_VALUE / 2;
+    analog.update();
+    TEST_ASSERT(messageCounter == MAX_NUMBER_OF_ANALOG);
+
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    {
+        TEST_ASSERT(midiPacket[i].Data3 < (MIDI_7_BIT_VALUE_MAX / 2));
+        analog.debounceReset(i);
+    }
+
+    //now use descending user curve
+    for (int i = 0; i < ANALOG_CURVE_POINTS; i++)
+        TEST_ASSERT(database.update(Database::Section::analog_t::userCurve, i, MIDI_7_BIT_VALUE_MAX - ((i * MIDI_7_BIT_VALUE_MAX) / ANALOG_CURVE_SEGMENTS)) == true);
+
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    {
+        TEST_ASSERT(database.update(Database::Section::analog_t::curve, i, static_cast<int32_t>(Analog::curve_t::custom)) == true);
+        analog.debounceReset(i);
+    }
+
+    verify(0, MIDI_7_BIT_VALUE_MAX);
+    verify(ADC_MAX_VALUE, 0);
+
+    //curve should be applied before limits and inversion
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    {
+        TEST_ASSERT(database.update(Database::Section::analog_t::invert, i, 1) == true);
+        TEST_ASSERT(database.update(Database::Section::analog_t::upperLimit, i, 100) == true);
+        analog.debounceReset(i);
+    }
+
+    verify(0, MIDI_7_BIT_VALUE_MAX - 100);
+    verify(ADC_MAX_VALUE, MIDI_7_BIT_VALUE_MAX);
+}
+
+TEST_CASE(ChangedComponentsOnly)
+{
+    using namespace Interface::analog;
+
+    //set known state
+    for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+    {
+        //enable all analog components
+        TEST_ASSERT(database.update(Database::Section::analog_t::enable, i, 1) == true);
+
+        //configure all analog components as potentiometers with CC MIDI message
+        TEST_ASSERT(database.update(Database::Section::analog_t::type, i, static_cast<int32_t>(Analog::type_t::potentiometerControlChange)) == true);
+    }
+
+    //components are checked on first readout even if sampling layer doesn't report any change
+    Board::detail::adcChangeMask  = 0;
+    Board::detail::adcReturnValue = 0;
+
+    resetReceived();
+    analog.update();
+    TEST_ASSERT(messageCounter == MAX_NUMBER_OF_ANALOG);
+
+    //value has changed but it isn't reported - nothing should be sent
+    Board::detail::adcReturnValue = ADC_MAX_VALUE;
+
+    resetReceived();
+    analog.update();
+    TEST_ASSERT(messageCounter == 0);
+
+    //report change on first component from each group only
+    Board::detail::adcChangeMask = 0x01;
+
+    resetReceived();
+    analog.update();
+    TEST_ASSERT(messageCounter == ((MAX_NUMBER_OF_ANALOG + 7) / 8));
+
+    for (int i = 0; i < messageCounter; i++)
+    {
+        TEST_ASSERT(midiPacket[i].Data2 == (i * 8));
+        TEST_ASSERT(midiPacket[i].Data3 == MIDI_7_BIT_VALUE_MAX);
+    }
+
+    //reset component should be checked again regardless of the change
+    Board::detail::adcChangeMask = 0;
+    analog.debounceReset(1);
+
+    resetReceived();
+    analog.update();
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 1);
+}
+
+TEST_CASE(NoisyInput)
+{
+    using namespace Interface::analog;
+
+    TEST_ASSERT(database.update(Database::Section::analog_t::type, 0, static_cast<int32_t>(Analog::type_t::potentiometerControlChange)) == true);
+    TEST_ASSERT(database.update(Database::Section::analog_t::type, 1, static_cast<int32_t>(Analog::type_t::pitchBend)) == true);
+
+    analog.debounceReset(0);
+    analog.debounceReset(1);
+
+    TEST_ASSERT(Board::detail::adcChangeThreshold[0] == ANALOG_CHANGE_THRESHOLD);
+    TEST_ASSERT(Board::detail::adcChangeThreshold[1] == ANALOG_STEP_MIN_DIFF_14_BIT);
+
+    //simulate sampling of idle input with noise of +-1 LSB the same way ISR stores the samples
+    auto changes = [](uint8_t threshold, int16_t center) {
+        const int16_t noise[] = { 0, 1, -1, 1, 0, -1, -1, 1 };
+
+        int16_t  stored  = center;
+        uint32_t changes = 0;
+
+        for (int scan = 0; scan < 100; scan++)
+        {
+            int16_t sampled = center + noise[scan % (sizeof(noise) / sizeof(int16_t))];
+
+            if (Board::detail::io::isAnalogChange(stored, sampled, threshold))
+            {
+                stored = sampled;
+                changes++;
+            }
+        }
+
+        return changes;
+    };
+
+    //noise shouldn't mark 7-bit input as changed
+    TEST_ASSERT(changes(Board::detail::adcChangeThreshold[0], ADC_MAX_VALUE / 2) == 0);
+
+    //14-bit input needs every change
+    TEST_ASSERT(changes(Board::detail::adcChangeThreshold[1], ADC_MAX_VALUE / 2) > 0);
+
+    //actual movement is reported
+    TEST_ASSERT(Board::detail::io::isAnalogChange(ADC_MAX_VALUE / 2, (ADC_MAX_VALUE / 2) + ANALOG_CHANGE_THRESHOLD, ANALOG_CHANGE_THRESHOLD) == true);
+    TEST_ASSERT(Board::detail::io::isAnalogChange(ADC_MAX_VALUE / 2, (ADC_MAX_VALUE / 2) - ANALOG_CHANGE_THRESHOLD, ANALOG_CHANGE_THRESHOLD) == true);
+
+    //both ends of the range can always be reached
+    TEST_ASSERT(Board::detail::io::isAnalogChange(ADC_MIN_VALUE + 1, ADC_MIN_VALUE, ANALOG_CHANGE_THRESHOLD) == true);
+    TEST_ASSERT(Board::detail::io::isAnalogChange(ADC_MAX_VALUE - 1, ADC_MAX_VALUE, ANALOG_CHANGE_THRESHOLD) == true);
+}
+
 TEST_CASE(DebouncingSetup)
 {
     //verify that the step diff is properly configured
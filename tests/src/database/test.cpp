@@ -133,6 +133,31 @@ TEST_CASE(ReadInitialValues)
         for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
             TEST_ASSERT(database.read(Database::Section::analog_t::midiChannel, i) == 0);
 
+        //curve section
+        //all values should be set to 0
+        for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+            TEST_ASSERT(database.read(Database::Section::analog_t::curve, i) == 0);
+
+        //user curve section
+        //values should describe linear curve
+        for (int i = 0; i < ANALOG_CURVE_POINTS; i++)
+            TEST_ASSERT(database.read(Database::Section::analog_t::userCurve, i) == (i * 127) / ANALOG_CURVE_SEGMENTS);
+
+        //aftertouch type section
+        //all values should be set to 0
+        for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+            TEST_ASSERT(database.read(Database::Section::analog_t::aftertouchType, i) == 0);
+
+        //peak window section
+        //all values should be set to 0
+        for (int i = 0; i < MAX_NUMBER_OF_ANALOG; i++)
+            TEST_ASSERT(database.read(Database::Section::analog_t::peakWindow, i) == 0);
+
+        //piezo setting section
+        //mask time should be set to default value, everything else to 0
+        TEST_ASSERT(database.read(Database::Section::analog_t::piezoSetting, static_cast<size_t>(Interface::analog::Analog::piezoSetting_t::maskTime)) == PIEZO_MASK_TIME_DEFAULT);
+        TEST_ASSERT(database.read(Database::Section::analog_t::piezoSetting, static_cast<size_t>(Interface::analog::Analog::piezoSetting_t::crosstalk)) == 0);
+
 #ifdef LEDS_SUPPORTED
         //LED block
         //global section
@@ -135,6 +135,10 @@ namespace Board
             return true;
         }
 
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+
         void writeLEDstate(uint8_t ledID, bool state)
         {
         }
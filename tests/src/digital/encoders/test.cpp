@@ -3,6 +3,7 @@
 #include "interface/digital/input/encoders/Encoders.h"
 #include "interface/digital/output/leds/LEDs.h"
 #include "interface/CInfo.h"
+#include "interface/MIDIOutput.h"
 #include "midi/src/MIDI.h"
 #include "core/src/general/Timing.h"
 #include "database/Database.h"
@@ -10,18 +11,19 @@
 
 namespace
 {
-    Database      database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
-    MIDI          midi;
-    ComponentInfo cInfo;
+    Database              database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
+    MIDI                  midi;
+    Interface::MIDIOutput output(midi);
+    ComponentInfo         cInfo;
 
 #ifdef DISPLAY_SUPPORTED
     Interface::Display display(database);
 #endif
 
 #ifdef DISPLAY_SUPPORTED
-    Interface::digital::input::Encoders encoders = Interface::digital::input::Encoders(database, midi, display, cInfo);
+    Interface::digital::input::Encoders encoders = Interface::digital::input::Encoders(database, output, display, cInfo);
 #else
-    Interface::digital::input::Encoders encoders = Interface::digital::input::Encoders(database, midi, cInfo);
+    Interface::digital::input::Encoders encoders = Interface::digital::input::Encoders(database, output, cInfo);
 #endif
 
     uint8_t controlValue[MAX_NUMBER_OF_ENCODERS];
@@ -103,6 +105,10 @@ namespace Board
             return true;
         }
 
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+
         void writeLEDstate(uint8_t ledID, bool state)
         {
         }
@@ -0,0 +1,189 @@
+#ifdef LEDS_SUPPORTED
+
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "interface/digital/output/leds/LEDs.h"
+#include "database/Database.h"
+#include "stubs/database/DB_ReadWrite.h"
+#include "core/src/general/Timing.h"
+
+namespace
+{
+    Database                         database = Database(DatabaseStub::read, DatabaseStub::write, EEPROM_SIZE - 3);
+    Interface::digital::output::LEDs leds     = Interface::digital::output::LEDs(database);
+
+    bool     ledWritten[MAX_NUMBER_OF_LEDS] = {};
+    uint32_t invalidWrites                  = 0;
+
+    uint8_t stateByte(Interface::digital::output::LEDs::color_t color, uint8_t blinkSpeed)
+    {
+        return static_cast<uint8_t>(color) | (blinkSpeed << 3);
+    }
+}    // namespace
+
+namespace Board
+{
+    namespace io
+    {
+        uint8_t getRGBID(uint8_t ledID)
+        {
+            return ledID / 3;
+        }
+
+        uint8_t getRGBaddress(uint8_t rgbID, Interface::digital::output::LEDs::rgbIndex_t index)
+        {
+            return rgbID * 3 + static_cast<uint8_t>(index);
+        }
+
+        bool setLEDfadeSpeed(uint8_t transitionSpeed)
+        {
+            return true;
+        }
+
+        void setLEDbrightness(uint8_t ledID, uint8_t brightness)
+        {
+        }
+
+        void writeLEDstate(uint8_t ledID, bool state)
+        {
+            if (ledID >= MAX_NUMBER_OF_LEDS)
+            {
+                invalidWrites++;
+                return;
+            }
+
+            ledWritten[ledID] = true;
+        }
+    }    // namespace io
+}    // namespace Board
+
+TEST_SETUP()
+{
+    //init checks - no point in running further tests if these conditions fail
+    TEST_ASSERT(database.init() == true);
+    //always start from known state
+    database.factoryReset(LESSDB::factoryResetType_t::full);
+    TEST_ASSERT(database.isSignatureValid() == true);
+
+    leds.init(false);
+    leds.setAllOff();
+
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+        ledWritten[i] = false;
+
+    invalidWrites = 0;
+}
+
+TEST_CASE(SetStates)
+{
+    using namespace Interface::digital::output;
+
+    uint8_t states[MAX_NUMBER_OF_LEDS];
+
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+        states[i] = stateByte(LEDs::color_t::red, i % 2 ? static_cast<uint8_t>(LEDs::blinkSpeed_t::s500ms) : 0);
+
+    leds.setStates(0, states, MAX_NUMBER_OF_LEDS);
+
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+    {
+        TEST_ASSERT(leds.getColor(i) == LEDs::color_t::red);
+        TEST_ASSERT(leds.getBlinkState(i) == static_cast<bool>(i % 2));
+    }
+}
+
+TEST_CASE(Clipping)
+{
+    using namespace Interface::digital::output;
+
+    uint8_t states[4];
+
+    for (int i = 0; i < 4; i++)
+        states[i] = stateByte(LEDs::color_t::red, 0);
+
+    //states past the last led are ignored
+    leds.setStates(MAX_NUMBER_OF_LEDS - 2, states, 4);
+    TEST_ASSERT(invalidWrites == 0);
+
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS - 2; i++)
+    {
+        TEST_ASSERT(!ledWritten[i]);
+        TEST_ASSERT(leds.getColor(i) == LEDs::color_t::off);
+    }
+
+    TEST_ASSERT(leds.getColor(MAX_NUMBER_OF_LEDS - 2) == LEDs::color_t::red);
+    TEST_ASSERT(leds.getColor(MAX_NUMBER_OF_LEDS - 1) == LEDs::color_t::red);
+
+    //nothing to set when the first led is out of range
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+        ledWritten[i] = false;
+
+    leds.setStates(MAX_NUMBER_OF_LEDS, states, 4);
+    TEST_ASSERT(invalidWrites == 0);
+
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+        TEST_ASSERT(!ledWritten[i]);
+}
+
+TEST_CASE(InvalidBlinkSpeed)
+{
+    using namespace Interface::digital::output;
+
+    //blink speed index past the last valid one turns blinking off, color is still applied
+    uint8_t states[2] = {
+        stateByte(LEDs::color_t::red, static_cast<uint8_t>(LEDs::blinkSpeed_t::s100ms)),
+        stateByte(LEDs::color_t::red, static_cast<uint8_t>(LEDs::blinkSpeed_t::AMOUNT)),
+    };
+
+    leds.setStates(0, states, 2);
+    TEST_ASSERT(leds.getBlinkState(0) == true);
+    TEST_ASSERT(leds.getBlinkState(1) == false);
+    TEST_ASSERT(leds.getColor(1) == LEDs::color_t::red);
+
+    //previous blinking is turned off as well
+    states[0] = stateByte(LEDs::color_t::red, 0x0F);
+    leds.setStates(0, states, 1);
+    TEST_ASSERT(leds.getBlinkState(0) == false);
+    TEST_ASSERT(leds.getColor(0) == LEDs::color_t::red);
+}
+
+TEST_CASE(OffDisablesBlinking)
+{
+    using namespace Interface::digital::output;
+
+    uint8_t state = stateByte(LEDs::color_t::red, static_cast<uint8_t>(LEDs::blinkSpeed_t::s200ms));
+
+    leds.setStates(0, &state, 1);
+    TEST_ASSERT(leds.getBlinkState(0) == true);
+
+    //blink speed is ignored for turned off led
+    state = stateByte(LEDs::color_t::off, static_cast<uint8_t>(LEDs::blinkSpeed_t::s200ms));
+    leds.setStates(0, &state, 1);
+    TEST_ASSERT(leds.getBlinkState(0) == false);
+    TEST_ASSERT(leds.getColor(0) == LEDs::color_t::off);
+}
+
+TEST_CASE(Blinking)
+{
+    using namespace Interface::digital::output;
+
+    uint8_t states[2] = {
+        stateByte(LEDs::color_t::red, static_cast<uint8_t>(LEDs::blinkSpeed_t::s100ms)),
+        stateByte(LEDs::color_t::red, 0),
+    };
+
+    leds.setStates(0, states, 2);
+
+    for (int i = 0; i < MAX_NUMBER_OF_LEDS; i++)
+        ledWritten[i] = false;
+
+    //only the led with changed blink state is updated
+    core::timing::detail::rTime_ms += 100;
+    leds.checkBlinking();
+    TEST_ASSERT(ledWritten[0]);
+
+    for (int i = 1; i < MAX_NUMBER_OF_LEDS; i++)
+        TEST_ASSERT(!ledWritten[i]);
+}
+
+#endif
@@ -0,0 +1,122 @@
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "OpenDeck/MIDIClock.h"
+#include "core/src/general/Timing.h"
+
+namespace
+{
+    MIDIClock midiClock;
+
+    ///
+    /// \brief Runs the clock for specified number of milliseconds while receiving clock messages at given tempo.
+    /// If BPM is set to 0, no clock messages are received.
+    /// \returns Number of local clock ticks.
+    ///
+    uint32_t run(uint32_t time, uint16_t bpm)
+    {
+        uint32_t ticks    = 0;
+        uint32_t start    = core::timing::detail::rTime_ms;
+        uint32_t received = 0;
+
+        for (uint32_t i = 0; i < time; i++)
+        {
+            //place the messages at the times they would be received with 1ms timer resolution
+            if (bpm && (i == (received * 60000UL / (bpm * MIDI_CLOCK_PPQN))))
+            {
+                midiClock.tick();
+                received++;
+            }
+
+            ticks += midiClock.update();
+            core::timing::detail::rTime_ms = start + i + 1;
+        }
+
+        return ticks;
+    }
+}    // namespace
+
+namespace Board
+{
+    uint32_t runTimeUs()
+    {
+        return core::timing::detail::rTime_ms * 1000;
+    }
+}    // namespace Board
+
+TEST_SETUP()
+{
+    midiClock                      = MIDIClock();
+    core::timing::detail::rTime_ms = 0;
+}
+
+TEST_CASE(Lock)
+{
+    TEST_ASSERT(midiClock.isLocked() == false);
+    TEST_ASSERT_EQUAL_UINT32(0, midiClock.bpm());
+
+    //first message is reported as is since the tempo isn't known yet
+    midiClock.tick();
+    TEST_ASSERT_EQUAL_UINT32(1, midiClock.update());
+    TEST_ASSERT(midiClock.isLocked() == false);
+
+    //message received too late to be a part of clock in supported range
+    core::timing::detail::rTime_ms += (60000 / (MIDI_CLOCK_BPM_MIN * MIDI_CLOCK_PPQN)) + 10;
+    midiClock.tick();
+    TEST_ASSERT_EQUAL_UINT32(1, midiClock.update());
+    TEST_ASSERT(midiClock.isLocked() == false);
+
+    //120 BPM
+    core::timing::detail::rTime_ms += 21;
+    midiClock.tick();
+    TEST_ASSERT_EQUAL_UINT32(1, midiClock.update());
+    TEST_ASSERT(midiClock.isLocked() == true);
+    TEST_ASSERT(midiClock.bpm() >= 115);
+    TEST_ASSERT(midiClock.bpm() <= 125);
+}
+
+TEST_CASE(Tempo)
+{
+    const uint16_t tempo[] = { 60, 120, 133, 174 };
+
+    for (size_t i = 0; i < sizeof(tempo) / sizeof(uint16_t); i++)
+    {
+        midiClock = MIDIClock();
+
+        //ten seconds of clock
+        uint32_t ticks    = run(10000, tempo[i]);
+        uint32_t expected = 10000UL * tempo[i] * MIDI_CLOCK_PPQN / 60000;
+
+        TEST_ASSERT(midiClock.isLocked() == true);
+        TEST_ASSERT_EQUAL_UINT32(tempo[i], midiClock.bpm());
+
+        //local ticks follow the received messages
+        TEST_ASSERT(ticks + 1 >= expected);
+        TEST_ASSERT(ticks <= expected + 1);
+    }
+}
+
+TEST_CASE(Hold)
+{
+    run(5000, 120);
+    TEST_ASSERT(midiClock.isLocked() == true);
+
+    //local clock keeps running when messages stop arriving
+    uint32_t time     = MIDI_CLOCK_HOLD_TIME / 2;
+    uint32_t ticks    = run(time, 0);
+    uint32_t expected = time * 120 * MIDI_CLOCK_PPQN / 60000;
+
+    TEST_ASSERT(midiClock.isLocked() == true);
+    TEST_ASSERT(ticks + 1 >= expected);
+    TEST_ASSERT(ticks <= expected + 1);
+
+    //and stops once the hold time passes
+    run(MIDI_CLOCK_HOLD_TIME, 0);
+    TEST_ASSERT(midiClock.isLocked() == false);
+    TEST_ASSERT_EQUAL_UINT32(0, midiClock.bpm());
+    TEST_ASSERT_EQUAL_UINT32(0, midiClock.update());
+
+    //tempo is estimated again once the messages arrive
+    run(1000, 90);
+    TEST_ASSERT(midiClock.isLocked() == true);
+    TEST_ASSERT_EQUAL_UINT32(90, midiClock.bpm());
+}
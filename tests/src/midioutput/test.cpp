@@ -0,0 +1,351 @@
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "interface/MIDIOutput.h"
+#include "midi/src/MIDI.h"
+#include "core/src/general/Timing.h"
+
+namespace
+{
+    MIDI                  midi;
+    Interface::MIDIOutput output(midi);
+
+    size_t                linkCapacity;
+    uint32_t              messageCounter;
+    MIDI::USBMIDIpacket_t midiPacket[32];
+    bool                  usbMuted;
+    uint32_t              highResCounter;
+    bool                  dinDropping;
+
+    bool midiDataHandler(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+    {
+        if (usbMuted)
+            return true;
+
+        midiPacket[messageCounter++] = USBMIDIpacket;
+
+        //the same message is written to DIN interface as well
+        //report parameter selection changes the same way the scheduler does
+        if (((USBMIDIpacket.Data1 & 0xF0) == 0xB0) && (USBMIDIpacket.Data2 >= 98) && (USBMIDIpacket.Data2 <= 101))
+        {
+            output.selectionChanged(MIDI::interface_t::usb, USBMIDIpacket.Data1 & 0x0F, true);
+            output.selectionChanged(MIDI::interface_t::din, USBMIDIpacket.Data1 & 0x0F, !dinDropping);
+        }
+
+        //each sent message takes up the link
+        if (linkCapacity)
+            linkCapacity--;
+
+        return true;
+    }
+}    // namespace
+
+TEST_SETUP()
+{
+    midi.handleUSBwrite(midiDataHandler);
+    midi.setChannelSendZeroStart(true);
+
+    output.registerCapacityHandler([]() {
+        return linkCapacity;
+    });
+
+    output.registerHighResHandler(nullptr, nullptr);
+    usbMuted       = false;
+    highResCounter = 0;
+    dinDropping    = false;
+
+    //send anything left from previous test
+    linkCapacity = 0xFF;
+    output.update();
+    output.resetNRPNselection();
+
+    messageCounter = 0;
+}
+
+TEST_CASE(Immediate)
+{
+    //link isn't busy - message should be sent right away
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 10, 20);
+
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data1 == 0xB0);
+    TEST_ASSERT(midiPacket[0].Data2 == 10);
+    TEST_ASSERT(midiPacket[0].Data3 == 20);
+}
+
+TEST_CASE(Coalescing)
+{
+    //link is busy - only the last value for each control should be sent once the link is available
+    linkCapacity = 0;
+
+    for (int i = 0; i < 100; i++)
+    {
+        output.send(Interface::MIDIOutput::message_t::controlChange, 0, 10, i);
+        output.send(Interface::MIDIOutput::message_t::controlChange, 1, 10, 127 - i);
+        output.send(Interface::MIDIOutput::message_t::pitchBend, 0, 0, i);
+    }
+
+    output.update();
+    TEST_ASSERT(messageCounter == 0);
+
+    //notes aren't delayed
+    output.sendNoteOn(60, 127, 0);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data1 == 0x90);
+
+    //send only one message
+    linkCapacity = 1;
+    output.update();
+    TEST_ASSERT(messageCounter == 2);
+
+    linkCapacity = 0xFF;
+    output.update();
+    TEST_ASSERT(messageCounter == 4);
+
+    //order of the first change is preserved
+    TEST_ASSERT(midiPacket[1].Data1 == 0xB0);
+    TEST_ASSERT(midiPacket[1].Data3 == 99);
+    TEST_ASSERT(midiPacket[2].Data1 == 0xB1);
+    TEST_ASSERT(midiPacket[2].Data3 == 28);
+    TEST_ASSERT(midiPacket[3].Data1 == 0xE0);
+    TEST_ASSERT(midiPacket[3].Data2 == 99);
+}
+
+TEST_CASE(Fairness)
+{
+    //busy control shouldn't take the link away from the others
+    linkCapacity = 0;
+
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 1, 0);
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 2, 0);
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 3, 0);
+
+    for (int i = 1; i <= 3; i++)
+    {
+        linkCapacity = 1;
+        output.update();
+        output.send(Interface::MIDIOutput::message_t::controlChange, 0, 1, i);
+    }
+
+    TEST_ASSERT(messageCounter == 3);
+    TEST_ASSERT(midiPacket[0].Data2 == 1);
+    TEST_ASSERT(midiPacket[1].Data2 == 2);
+    TEST_ASSERT(midiPacket[2].Data2 == 3);
+
+    //each control gets at most one message per pass
+    linkCapacity = 0xFF;
+    output.update();
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 1, 10);
+    TEST_ASSERT(messageCounter == 5);
+    TEST_ASSERT(midiPacket[3].Data2 == 1);
+    TEST_ASSERT(midiPacket[3].Data3 == 3);
+    TEST_ASSERT(midiPacket[4].Data2 == 1);
+    TEST_ASSERT(midiPacket[4].Data3 == 10);
+}
+
+TEST_CASE(Skipping)
+{
+    linkCapacity = 0;
+
+    output.send(Interface::MIDIOutput::message_t::nrpn14bit, 0, 200, 1000);
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 10, 20);
+
+    //nrpn doesn't fit - control change behind it can still be sent
+    linkCapacity = 3;
+    output.update();
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 10);
+
+    //nrpn has been skipped once already - others have to wait until it's sent
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 10, 21);
+    linkCapacity = 3;
+    output.update();
+    TEST_ASSERT(messageCounter == 1);
+
+    linkCapacity = 5;
+    output.update();
+    TEST_ASSERT(messageCounter == 6);
+    TEST_ASSERT(midiPacket[1].Data2 == 99);
+    TEST_ASSERT(midiPacket[5].Data2 == 10);
+    TEST_ASSERT(midiPacket[5].Data3 == 21);
+}
+
+TEST_CASE(Relative)
+{
+    //relative changes are sent right away even when the link is busy so that no steps are lost
+    linkCapacity = 0;
+
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 20, 64);
+
+    for (int i = 0; i < 5; i++)
+        output.sendControlChangeRelative(10, 1, 0);
+
+    TEST_ASSERT(messageCounter == 5);
+
+    for (int i = 0; i < 5; i++)
+    {
+        TEST_ASSERT(midiPacket[i].Data1 == 0xB0);
+        TEST_ASSERT(midiPacket[i].Data2 == 10);
+        TEST_ASSERT(midiPacket[i].Data3 == 1);
+    }
+
+    //absolute value is still waiting for the link
+    linkCapacity = 0xFF;
+    output.update();
+    TEST_ASSERT(messageCounter == 6);
+    TEST_ASSERT(midiPacket[5].Data2 == 20);
+}
+
+TEST_CASE(NRPN)
+{
+    //nrpn requires space for more than one message
+    linkCapacity = 3;
+
+    output.send(Interface::MIDIOutput::message_t::nrpn14bit, 2, 200, 1000);
+    TEST_ASSERT(messageCounter == 0);
+
+    linkCapacity = 4;
+    output.update();
+    TEST_ASSERT(messageCounter == 4);
+
+    const uint8_t expected[4][2] = {
+        { 99, 1 },
+        { 98, 72 },
+        { 6, 7 },
+        { 38, 104 },
+    };
+
+    for (int i = 0; i < 4; i++)
+    {
+        TEST_ASSERT(midiPacket[i].Data1 == 0xB2);
+        TEST_ASSERT(midiPacket[i].Data2 == expected[i][0]);
+        TEST_ASSERT(midiPacket[i].Data3 == expected[i][1]);
+    }
+}
+
+TEST_CASE(Overflow)
+{
+    linkCapacity = 0;
+
+    //once the queue is full, the oldest control is sent even though the link is busy
+    for (int i = 0; i < MIDI_OUTPUT_QUEUE_SIZE + 1; i++)
+        output.send(Interface::MIDIOutput::message_t::controlChange, 0, i, 1);
+
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 0);
+
+    linkCapacity = 0xFF;
+    output.update();
+    TEST_ASSERT(messageCounter == MIDI_OUTPUT_QUEUE_SIZE + 1);
+}
+
+TEST_CASE(NRPNSelection)
+{
+    //parameter should be selected only once as long as it doesn't change
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 10);
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 11);
+    TEST_ASSERT(messageCounter == 4);
+    TEST_ASSERT(midiPacket[0].Data2 == 99);
+    TEST_ASSERT(midiPacket[1].Data2 == 98);
+    TEST_ASSERT(midiPacket[2].Data2 == 6);
+    TEST_ASSERT(midiPacket[3].Data2 == 6);
+    TEST_ASSERT(midiPacket[3].Data3 == 11);
+
+    //selection is tracked per channel
+    messageCounter = 0;
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 1, 5, 10);
+    TEST_ASSERT(messageCounter == 3);
+
+    //different parameter requires new selection
+    messageCounter = 0;
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 6, 10);
+    TEST_ASSERT(messageCounter == 3);
+
+    //control change which modifies the selection
+    messageCounter = 0;
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 99, 0);
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 6, 11);
+    TEST_ASSERT(messageCounter == 4);
+
+    //link has room only for the value
+    messageCounter = 0;
+    linkCapacity   = 1;
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 6, 12);
+    TEST_ASSERT(messageCounter == 1);
+
+    //selection is refreshed after a while
+    messageCounter = 0;
+    linkCapacity   = 0xFF;
+    core::timing::detail::rTime_ms += MIDI_OUTPUT_NRPN_REFRESH_TIME;
+    output.update();
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 6, 13);
+    TEST_ASSERT(messageCounter == 3);
+}
+
+TEST_CASE(NRPNSelectionPerInterface)
+{
+    //selection is dropped on DIN only
+    dinDropping = true;
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 10);
+    TEST_ASSERT(messageCounter == 3);
+
+    //parameter must be selected again since DIN receiver doesn't have it
+    messageCounter = 0;
+    dinDropping    = false;
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 11);
+    TEST_ASSERT(messageCounter == 3);
+    TEST_ASSERT(midiPacket[0].Data2 == 99);
+    TEST_ASSERT(midiPacket[1].Data2 == 98);
+
+    //now selected on both interfaces
+    messageCounter = 0;
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 12);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data2 == 6);
+
+    //control change sent directly using the MIDI module, ie. from button, also changes the selection
+    messageCounter = 0;
+    midi.sendControlChange(98, 0, 0);
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 13);
+    TEST_ASSERT(messageCounter == 4);
+    TEST_ASSERT(midiPacket[1].Data2 == 99);
+    TEST_ASSERT(midiPacket[2].Data2 == 98);
+
+    //control change on another channel doesn't affect the selection
+    messageCounter = 0;
+    midi.sendControlChange(98, 0, 1);
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 14);
+    TEST_ASSERT(messageCounter == 2);
+
+    //reset on single interface
+    messageCounter = 0;
+    output.resetNRPNselection(MIDI::interface_t::usb);
+    output.send(Interface::MIDIOutput::message_t::nrpn7bit, 0, 5, 15);
+    TEST_ASSERT(messageCounter == 3);
+}
+
+TEST_CASE(HighRes)
+{
+    output.registerHighResHandler(
+        [](Interface::MIDIOutput::message_t type, uint8_t channel, uint16_t id, uint16_t value) {
+            if (type != Interface::MIDIOutput::message_t::nrpn14bit)
+                return false;
+
+            highResCounter++;
+            return true;
+        },
+        [](bool state) {
+            usbMuted = state;
+        });
+
+    //NRPN is sent using the high-resolution handler only
+    output.send(Interface::MIDIOutput::message_t::nrpn14bit, 0, 300, 1000);
+    TEST_ASSERT(highResCounter == 1);
+    TEST_ASSERT(messageCounter == 0);
+    TEST_ASSERT(usbMuted == false);
+
+    //other messages are sent using the MIDI module
+    output.send(Interface::MIDIOutput::message_t::controlChange, 0, 10, 20);
+    TEST_ASSERT(highResCounter == 1);
+    TEST_ASSERT(messageCounter == 1);
+    TEST_ASSERT(midiPacket[0].Data1 == 0xB0);
+}
@@ -0,0 +1,462 @@
+#ifdef DIN_MIDI_SUPPORTED
+
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "OpenDeck/MIDIScheduler.h"
+#include "board/Board.h"
+
+namespace
+{
+    size_t                freeSpace;
+    size_t                written;
+    uint8_t               txData[64];
+    MIDI::USBMIDIpacket_t usbTxPacket;
+    size_t                usbTxCount;
+    bool                  usbTxFull;
+    MIDI::USBMIDIpacket_t usbRxPacket;
+    bool                  usbRxAvailable;
+    size_t                rxCount;
+
+    typedef struct
+    {
+        MIDI::interface_t interface;
+        uint8_t           channel;
+        bool              written;
+    } selection_t;
+
+    selection_t selection[8];
+    size_t      selectionCount;
+
+    void selectionHandler(MIDI::interface_t interface, uint8_t channel, bool written)
+    {
+        selection[selectionCount++] = { interface, channel, written };
+    }
+
+    void reset(size_t space)
+    {
+        MIDIScheduler::resetDIN();
+        freeSpace = space;
+        written = 0;
+    }
+
+    void writeMessage(uint8_t* data, size_t length)
+    {
+        for (size_t i = 0; i < length; i++)
+            TEST_ASSERT(MIDIScheduler::writeDIN(data[i]) == true);
+    }
+}    // namespace
+
+namespace Board
+{
+    namespace io
+    {
+        void ledFlashStartup(bool fwUpdated)
+        {
+        }
+    }    // namespace io
+
+    void reboot(Board::rebootType_t type)
+    {
+    }
+
+    uint32_t runTimeUs()
+    {
+        return 0;
+    }
+
+    namespace UART
+    {
+        void init(uint8_t channel, uint32_t baudRate)
+        {
+        }
+
+        bool write(uint8_t channel, uint8_t data)
+        {
+            txData[written++] = data;
+
+            if (freeSpace)
+                freeSpace--;
+
+            return true;
+        }
+
+        bool read(uint8_t channel, uint8_t& data)
+        {
+            return false;
+        }
+
+        size_t txSpace(uint8_t channel)
+        {
+            return freeSpace;
+        }
+
+        size_t txPending(uint8_t channel)
+        {
+            return written;
+        }
+
+        bool isTxEmpty(uint8_t channel)
+        {
+            return true;
+        }
+
+        size_t rxPending(uint8_t channel)
+        {
+            return rxCount;
+        }
+
+        size_t rxDropped(uint8_t channel)
+        {
+            return 0;
+        }
+    }    // namespace UART
+
+    namespace USB
+    {
+        bool writeMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            if (usbTxFull)
+                return false;
+
+            usbTxPacket = USBMIDIpacket;
+            usbTxCount++;
+            return true;
+        }
+
+        bool isConfigured()
+        {
+            return true;
+        }
+
+        size_t peekMIDI(MIDI::USBMIDIpacket_t*& packets)
+        {
+            packets = &usbRxPacket;
+            return usbRxAvailable;
+        }
+
+        bool readMIDI(MIDI::USBMIDIpacket_t& USBMIDIpacket)
+        {
+            if (!usbRxAvailable)
+                return false;
+
+            USBMIDIpacket  = usbRxPacket;
+            usbRxAvailable = false;
+            return true;
+        }
+
+        void flushMIDI()
+        {
+        }
+    }    // namespace USB
+}    // namespace Board
+
+TEST_CASE(WholeMessages)
+{
+    uint8_t cc[3] = { 0xB0, 0x07, 0x7F };
+
+    //only part of the message fits - drop it completely
+    reset(2);
+    uint32_t dropped = MIDIScheduler::dropped(MIDI::interface_t::din);
+    writeMessage(cc, 3);
+
+    TEST_ASSERT(written == 0);
+    TEST_ASSERT(MIDIScheduler::dropped(MIDI::interface_t::din) == dropped + 1);
+
+    reset(3);
+    writeMessage(cc, 3);
+    TEST_ASSERT(written == 3);
+    TEST_ASSERT(txData[0] == 0xB0);
+    TEST_ASSERT(txData[2] == 0x7F);
+}
+
+TEST_CASE(NotesRetried)
+{
+    uint8_t noteOff[3]        = { 0x80, 0x40, 0x00 };
+    uint8_t runningNoteOff[2] = { 0x41, 0x00 };
+    uint8_t noteOn[3]         = { 0x90, 0x40, 0x7F };
+
+    //burst of note off messages against full buffer - nothing is written without waiting
+    reset(0);
+    uint32_t dropped = MIDIScheduler::dropped(MIDI::interface_t::din);
+    writeMessage(noteOff, 3);
+
+    for (int i = 0; i < 5; i++)
+        writeMessage(runningNoteOff, 2);
+
+    TEST_ASSERT(written == 0);
+
+    //messages are written in order once there is room
+    freeSpace = 5;
+    MIDIScheduler::flush();
+    TEST_ASSERT(written == 5);
+
+    freeSpace = 64;
+    MIDIScheduler::flush();
+    TEST_ASSERT(written == 13);
+    TEST_ASSERT(txData[0] == 0x80);
+    TEST_ASSERT(txData[3] == 0x41);
+    TEST_ASSERT(txData[11] == 0x41);
+    TEST_ASSERT(MIDIScheduler::dropped(MIDI::interface_t::din) == dropped);
+
+    //only continuous controls are dropped
+    //control which would overtake waiting messages is dropped as well
+    uint8_t cc[3] = { 0xB0, 0x07, 0x7F };
+
+    reset(0);
+    writeMessage(noteOn, 3);
+    freeSpace = 64;
+    writeMessage(cc, 3);
+    writeMessage(noteOff, 3);
+    TEST_ASSERT(written == 0);
+    TEST_ASSERT(MIDIScheduler::dropped(MIDI::interface_t::din) == dropped + 1);
+
+    MIDIScheduler::flush();
+    TEST_ASSERT(written == 6);
+    TEST_ASSERT(txData[0] == 0x90);
+    TEST_ASSERT(txData[3] == 0x80);
+
+    //retry buffer is limited - bytes which don't fit are dropped
+    reset(0);
+
+    for (int i = 0; i <= MIDI_SCHEDULER_DIN_RETRY_SIZE; i++)
+        TEST_ASSERT(MIDIScheduler::writeDIN(0xF8) == true);
+
+    TEST_ASSERT(MIDIScheduler::dropped(MIDI::interface_t::din) > dropped + 1);
+    reset(0);
+}
+
+TEST_CASE(RunningStatus)
+{
+    uint8_t cc1[3]          = { 0xB0, 0x07, 0x10 };
+    uint8_t cc2[3]          = { 0xB1, 0x07, 0x20 };
+    uint8_t runningCC2[2]   = { 0x07, 0x21 };
+    uint8_t runningCC2_2[2] = { 0x07, 0x22 };
+
+    reset(3);
+    writeMessage(cc1, 3);
+    TEST_ASSERT(written == 3);
+
+    //message with new status byte is dropped
+    writeMessage(cc2, 3);
+    TEST_ASSERT(written == 3);
+
+    //next message relies on running status - status byte must be inserted
+    freeSpace = 3;
+    writeMessage(runningCC2, 2);
+    TEST_ASSERT(written == 6);
+    TEST_ASSERT(txData[3] == 0xB1);
+    TEST_ASSERT(txData[4] == 0x07);
+    TEST_ASSERT(txData[5] == 0x21);
+
+    //status byte is now sent
+    freeSpace = 2;
+    writeMessage(runningCC2_2, 2);
+    TEST_ASSERT(written == 8);
+    TEST_ASSERT(txData[6] == 0x07);
+    TEST_ASSERT(txData[7] == 0x22);
+}
+
+TEST_CASE(RealTime)
+{
+    uint8_t noteOn[3] = { 0x90, 0x40, 0x7F };
+
+    reset(4);
+
+    //real-time message inside another message
+    TEST_ASSERT(MIDIScheduler::writeDIN(noteOn[0]) == true);
+    TEST_ASSERT(MIDIScheduler::writeDIN(0xF8) == true);
+    TEST_ASSERT(MIDIScheduler::writeDIN(noteOn[1]) == true);
+    TEST_ASSERT(MIDIScheduler::writeDIN(noteOn[2]) == true);
+
+    TEST_ASSERT(written == 4);
+    TEST_ASSERT(txData[0] == 0x90);
+    TEST_ASSERT(txData[1] == 0xF8);
+    TEST_ASSERT(txData[2] == 0x40);
+
+    //real-time message isn't dropped even if the buffer is full
+    uint8_t cc[3] = { 0xB0, 0x07, 0x7F };
+
+    reset(0);
+    writeMessage(cc, 3);
+    TEST_ASSERT(MIDIScheduler::writeDIN(0xF8) == true);
+    TEST_ASSERT(written == 0);
+
+    freeSpace = 1;
+    MIDIScheduler::flush();
+    TEST_ASSERT(written == 1);
+    TEST_ASSERT(txData[0] == 0xF8);
+}
+
+TEST_CASE(SysEx)
+{
+    uint8_t sysEx[5] = { 0xF0, 0x00, 0x53, 0x43, 0xF7 };
+
+    //system exclusive messages are never dropped
+    reset(0);
+    writeMessage(sysEx, 5);
+    TEST_ASSERT(written == 0);
+
+    freeSpace = 64;
+    MIDIScheduler::flush();
+    TEST_ASSERT(written == 5);
+    TEST_ASSERT(txData[4] == 0xF7);
+}
+
+TEST_CASE(NRPNSelection)
+{
+    uint8_t cc99[3]        = { 0xB2, 99, 0x01 };
+    uint8_t runningCC98[2] = { 98, 0x02 };
+    uint8_t cc7[3]         = { 0xB2, 0x07, 0x10 };
+
+    MIDIScheduler::registerSelectionHandler(selectionHandler);
+    selectionCount = 0;
+
+    //written selection is reported
+    reset(3);
+    writeMessage(cc99, 3);
+    TEST_ASSERT(selectionCount == 1);
+    TEST_ASSERT(selection[0].interface == MIDI::interface_t::din);
+    TEST_ASSERT(selection[0].channel == 2);
+    TEST_ASSERT(selection[0].written == true);
+
+    //dropped selection is reported as well, also when running status is used
+    freeSpace = 0;
+    writeMessage(runningCC98, 2);
+    TEST_ASSERT(selectionCount == 2);
+    TEST_ASSERT(selection[1].written == false);
+
+    //other controls aren't reported
+    freeSpace = 3;
+    writeMessage(cc7, 3);
+    TEST_ASSERT(selectionCount == 2);
+
+#ifdef USB_MIDI_SUPPORTED
+    MIDI::USBMIDIpacket_t packet = { 0x0B, 0xB3, 101, 0x00 };
+
+    TEST_ASSERT(MIDIScheduler::writeUSB(packet) == true);
+    TEST_ASSERT(selectionCount == 3);
+    TEST_ASSERT(selection[2].interface == MIDI::interface_t::usb);
+    TEST_ASSERT(selection[2].channel == 3);
+    TEST_ASSERT(selection[2].written == true);
+#endif
+
+    MIDIScheduler::registerSelectionHandler(nullptr);
+}
+
+TEST_CASE(InputStats)
+{
+    rxCount = 5;
+    TEST_ASSERT(MIDIScheduler::inputPending(MIDI::interface_t::din) == 5);
+
+    rxCount = 0;
+    TEST_ASSERT(MIDIScheduler::inputPending(MIDI::interface_t::din) == 0);
+
+    //each interface has its own statistics
+    MIDIScheduler::inputStats(MIDI::interface_t::din).maxDepth = 10;
+    MIDIScheduler::inputStats(MIDI::interface_t::usb).maxDepth = 0;
+    TEST_ASSERT(MIDIScheduler::inputStats(MIDI::interface_t::din).maxDepth == 10);
+    TEST_ASSERT(MIDIScheduler::inputStats(MIDI::interface_t::usb).maxDepth == 0);
+}
+
+TEST_CASE(DaisyChainCables)
+{
+    //boards without cable of their own share the daisy-chain cable
+    TEST_ASSERT(MIDIScheduler::nodeCable(0) == MIDIScheduler::usbCable_t::daisyChain);
+    TEST_ASSERT(MIDIScheduler::nodeCable(1) == MIDIScheduler::usbCable_t::node1);
+    TEST_ASSERT(MIDIScheduler::nodeCable(4) == MIDIScheduler::usbCable_t::node4);
+    TEST_ASSERT(MIDIScheduler::nodeCable(5) == MIDIScheduler::usbCable_t::daisyChain);
+
+    //traffic on daisy-chain cable is sent to all the boards
+    TEST_ASSERT(MIDIScheduler::cableNode(MIDIScheduler::usbCable_t::daisyChain) == 0);
+    TEST_ASSERT(MIDIScheduler::cableNode(MIDIScheduler::usbCable_t::node3) == 3);
+
+    //unless single board is selected - boards without cable of their own can be reached one by one
+    MIDIScheduler::setDaisyChainTarget(7);
+    TEST_ASSERT(MIDIScheduler::daisyChainTarget() == 7);
+    TEST_ASSERT(MIDIScheduler::cableNode(MIDIScheduler::usbCable_t::daisyChain) == 7);
+    TEST_ASSERT(MIDIScheduler::cableNode(MIDIScheduler::usbCable_t::node3) == 3);
+    TEST_ASSERT(MIDIScheduler::cableNode(MIDIScheduler::usbCable_t::performance) == 0);
+
+    MIDIScheduler::setDaisyChainTarget(0);
+    TEST_ASSERT(MIDIScheduler::cableNode(MIDIScheduler::usbCable_t::daisyChain) == 0);
+
+    TEST_ASSERT(MIDIScheduler::isDaisyChainCable(MIDIScheduler::usbCable_t::performance) == false);
+    TEST_ASSERT(MIDIScheduler::isDaisyChainCable(MIDIScheduler::usbCable_t::configuration) == false);
+    TEST_ASSERT(MIDIScheduler::isDaisyChainCable(MIDIScheduler::usbCable_t::daisyChain) == true);
+    TEST_ASSERT(MIDIScheduler::isDaisyChainCable(MIDIScheduler::usbCable_t::node2) == true);
+}
+
+#ifdef USB_MIDI_SUPPORTED
+TEST_CASE(USBCables)
+{
+    MIDI::USBMIDIpacket_t packet = { 0x09, 0x90, 0x40, 0x7F };
+
+    //packets written by the MIDI module use the selected cable
+    MIDIScheduler::setUSBcable(MIDIScheduler::usbCable_t::configuration);
+    TEST_ASSERT(MIDIScheduler::writeUSB(packet) == true);
+    TEST_ASSERT(usbTxPacket.Event == 0x19);
+
+    MIDIScheduler::setUSBcable(MIDIScheduler::usbCable_t::performance);
+    TEST_ASSERT(MIDIScheduler::writeUSB(packet) == true);
+    TEST_ASSERT(usbTxPacket.Event == 0x09);
+
+    TEST_ASSERT(MIDIScheduler::forwardUSB(packet, MIDIScheduler::usbCable_t::daisyChain) == true);
+    TEST_ASSERT(usbTxPacket.Event == 0x29);
+
+    //cable of incoming packet is remembered
+    usbRxPacket    = { 0x29, 0x90, 0x40, 0x7F };
+    usbRxAvailable = true;
+    TEST_ASSERT(MIDIScheduler::readUSB(packet) == true);
+    TEST_ASSERT(MIDIScheduler::receivedUSBcable() == MIDIScheduler::usbCable_t::daisyChain);
+
+    //unknown cables are treated as performance cable
+    usbRxPacket    = { 0x79, 0x90, 0x40, 0x7F };
+    usbRxAvailable = true;
+    TEST_ASSERT(MIDIScheduler::readUSB(packet) == true);
+    TEST_ASSERT(MIDIScheduler::receivedUSBcable() == MIDIScheduler::usbCable_t::performance);
+
+    TEST_ASSERT(MIDIScheduler::readUSB(packet) == false);
+}
+
+TEST_CASE(USBRetry)
+{
+    MIDI::USBMIDIpacket_t noteOn  = { 0x09, 0x90, 0x40, 0x7F };
+    MIDI::USBMIDIpacket_t cc      = { 0x0B, 0xB0, 0x07, 0x7F };
+    MIDI::USBMIDIpacket_t noteOff = { 0x08, 0x80, 0x40, 0x00 };
+
+    MIDIScheduler::setUSBcable(MIDIScheduler::usbCable_t::performance);
+    uint32_t dropped = MIDIScheduler::dropped(MIDI::interface_t::usb);
+
+    //host isn't reading - notes wait for retry, controls are dropped
+    usbTxFull  = true;
+    usbTxCount = 0;
+    TEST_ASSERT(MIDIScheduler::writeUSB(noteOn) == true);
+    TEST_ASSERT(MIDIScheduler::writeUSB(cc) == false);
+    TEST_ASSERT(MIDIScheduler::writeUSB(noteOff) == true);
+    TEST_ASSERT(usbTxCount == 0);
+    TEST_ASSERT(MIDIScheduler::dropped(MIDI::interface_t::usb) == dropped + 1);
+
+    MIDIScheduler::flush();
+    TEST_ASSERT(usbTxCount == 0);
+
+    //waiting packets are written in order once there is room
+    usbTxFull = false;
+    MIDIScheduler::flush();
+    TEST_ASSERT(usbTxCount == 2);
+    TEST_ASSERT(usbTxPacket.Event == 0x08);
+
+    //retry queue is limited
+    usbTxFull = true;
+
+    for (int i = 0; i < MIDI_SCHEDULER_USB_RETRY_SIZE; i++)
+        TEST_ASSERT(MIDIScheduler::writeUSB(noteOn) == true);
+
+    TEST_ASSERT(MIDIScheduler::writeUSB(noteOn) == false);
+    TEST_ASSERT(MIDIScheduler::dropped(MIDI::interface_t::usb) == dropped + 2);
+
+    usbTxFull = false;
+    MIDIScheduler::flush();
+}
+#endif
+
+#endif
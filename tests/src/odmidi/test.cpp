@@ -6,14 +6,21 @@
 #include "board/Board.h"
 #include "common/OpenDeckMIDIformat/OpenDeckMIDIformat.h"
 #include "core/src/general/RingBuffer.h"
+#include "core/src/general/Timing.h"
 
 #define TEST_MIDI_CHANNEL 0
-#define BUFFER_SIZE       50
+#define BUFFER_SIZE       64
 
 namespace
 {
     auto                                   rebootType = Board::rebootType_t::rebootApp;
     core::RingBuffer<uint8_t, BUFFER_SIZE> buffer;
+    uint32_t                               uartBaudRate;
+    bool                                   uartConnected = true;
+    bool                                   uartTxEmpty   = true;
+    size_t                                 uartDropped;
+    size_t                                 uartRxDropped;
+    uint32_t                               runTimeUsOffset;
 }    // namespace
 
 namespace Board
@@ -34,8 +41,21 @@ namespace Board
         rebootType = type;
     }
 
+    uint32_t runTimeUs()
+    {
+        //each call advances the time so that the measured intervals aren't zero
+        runTimeUsOffset += 250;
+        return (core::timing::detail::rTime_ms * 1000) + runTimeUsOffset;
+    }
+
     namespace UART
     {
+        void init(uint8_t channel, uint32_t baudRate)
+        {
+            uartBaudRate = baudRate;
+            buffer.reset();
+        }
+
         bool read(uint8_t channel, uint8_t& data)
         {
             return buffer.remove(data);
@@ -43,9 +63,28 @@ namespace Board
 
         bool write(uint8_t channel, uint8_t data)
         {
+            if (!uartConnected)
+            {
+                uartDropped++;
+                return true;
+            }
+
             TEST_ASSERT(buffer.insert(data) == true);
             return true;
         }
+
+        bool isTxEmpty(uint8_t channel)
+        {
+            return uartTxEmpty;
+        }
+
+        size_t rxDropped(uint8_t channel)
+        {
+            size_t dropped = uartRxDropped;
+            uartRxDropped  = 0;
+
+            return dropped;
+        }
     }    // namespace UART
 }    // namespace Board
 
@@ -61,6 +100,14 @@ TEST_CASE(MIDI)
     sending.Data3 = 0x30;
 
     TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+
+    //midi packets aren't sent until flush is called
+    TEST_ASSERT(buffer.count() == 0);
+    TEST_ASSERT(OpenDeckMIDIformat::pendingBytes(TEST_MIDI_CHANNEL) == OPENDECK_MIDI_FORMAT_PACKET_SIZE);
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+    TEST_ASSERT(buffer.count() == OPENDECK_MIDI_FORMAT_PACKET_SIZE);
+    TEST_ASSERT(OpenDeckMIDIformat::pendingBytes(TEST_MIDI_CHANNEL) == 0);
+
     TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
 
     TEST_ASSERT(receivedPacketType == OpenDeckMIDIformat::packetType_t::midi);
@@ -112,24 +159,33 @@ TEST_CASE(ManualPacketBuilding)
     sending.Data2 = 0x20;
     sending.Data3 = 0x30;
 
-    uint8_t dataXor = sending.Event ^ sending.Data1 ^ sending.Data2 ^ sending.Data3;
+    uint8_t packet[5] = {
+        static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::internalCommand),
+        sending.Event,
+        sending.Data1,
+        sending.Data2,
+        sending.Data3,
+    };
+
+    uint8_t crc      = OpenDeckMIDIformat::crc8(packet, sizeof(packet));
+    uint8_t wrongCRC = crc ? 0x00 : 0x01;
 
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::internalCommand)));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Event));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data1));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data2));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data3));
-    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, dataXor));
+    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, crc));
 
     TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
 
-    //now send the same packet but with XOR byte being wrong
+    //now send the same packet but with checksum being wrong
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::internalCommand)));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Event));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data1));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data2));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data3));
-    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, 0x00));
+    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, wrongCRC));
 
     rebootType = Board::rebootType_t::rebootApp;
 
@@ -146,18 +202,551 @@ TEST_CASE(ManualPacketBuilding)
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data1));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data2));
     TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, sending.Data3));
-    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, dataXor));
+    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, crc));
+
+    //parser should resync on the second start marker and decode the packet in single read
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(receivedPacketType == OpenDeckMIDIformat::packetType_t::internalCommand);
+    TEST_ASSERT(rebootType == Board::rebootType_t::rebootBtldr);
+
+    //nothing left in the buffer - read should return false
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+}
+
+TEST_CASE(ReadAll)
+{
+    MIDI::USBMIDIpacket_t sending;
+    static uint8_t        receivedCount;
+    static uint8_t        receivedData[4];
+
+    receivedCount = 0;
+
+    //start markers in data bytes and noise between packets shouldn't cause packets to be lost
+    for (int i = 0; i < 4; i++)
+    {
+        sending.Event = 0x03;
+        sending.Data1 = static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::internalCommand);
+        sending.Data2 = static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::midi);
+        sending.Data3 = i;
+
+        TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::midi)));
+        TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, 0x55));
+        TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+        OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+    }
+
+    TEST_ASSERT(OpenDeckMIDIformat::readAll(TEST_MIDI_CHANNEL, [](MIDI::USBMIDIpacket_t& USBMIDIpacket, OpenDeckMIDIformat::packetType_t packetType) {
+                    TEST_ASSERT(packetType == OpenDeckMIDIformat::packetType_t::midi);
+                    receivedData[receivedCount++] = USBMIDIpacket.Data3;
+                }) == 4);
+
+    TEST_ASSERT(receivedCount == 4);
+
+    for (int i = 0; i < 4; i++)
+        TEST_ASSERT(receivedData[i] == i);
+
+    //incomplete packet is completed once the rest of it arrives
+    sending.Data3 = 0x7F;
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+
+    uint8_t lastByte;
+    uint8_t partial[5];
+
+    for (int i = 0; i < 5; i++)
+        TEST_ASSERT(Board::UART::read(TEST_MIDI_CHANNEL, partial[i]) == true);
+
+    TEST_ASSERT(Board::UART::read(TEST_MIDI_CHANNEL, lastByte) == true);
+
+    for (int i = 0; i < 5; i++)
+        TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, partial[i]));
+
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, lastByte));
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(receiving.Data3 == 0x7F);
+}
+
+TEST_CASE(Batch)
+{
+    MIDI::USBMIDIpacket_t sending;
+    static uint8_t        receivedCount;
+    static uint8_t        receivedData[OPENDECK_MIDI_FORMAT_BATCH_SIZE + 3];
+
+    receivedCount = 0;
+
+    sending.Event = 0x0B;
+    sending.Data1 = static_cast<uint8_t>(MIDI::messageType_t::controlChange);
+    sending.Data2 = 0x10;
+
+    //collected packets should be sent in single frame
+    for (int i = 0; i < 3; i++)
+    {
+        sending.Data3 = i;
+        TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+    }
+
+    TEST_ASSERT(buffer.count() == 0);
+    TEST_ASSERT(OpenDeckMIDIformat::pendingBytes(TEST_MIDI_CHANNEL) == (4 + (3 * 4)));
+
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+    TEST_ASSERT(buffer.count() == (4 + (3 * 4)));
+
+    TEST_ASSERT(OpenDeckMIDIformat::readAll(TEST_MIDI_CHANNEL, [](MIDI::USBMIDIpacket_t& USBMIDIpacket, OpenDeckMIDIformat::packetType_t packetType) {
+                    TEST_ASSERT(packetType == OpenDeckMIDIformat::packetType_t::midi);
+                    receivedData[receivedCount++] = USBMIDIpacket.Data3;
+                }) == 3);
+
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT(receivedData[i] == i);
+
+    //full frame is sent right away and the rest is kept for the next one
+    receivedCount = 0;
+
+    for (int i = 0; i < (OPENDECK_MIDI_FORMAT_BATCH_SIZE + 2); i++)
+    {
+        sending.Data3 = i;
+        TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+    }
+
+    TEST_ASSERT(buffer.count() == (4 + (OPENDECK_MIDI_FORMAT_BATCH_SIZE * 4)));
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+
+    //packet of different type ends the frame
+    sending.Data3 = OPENDECK_MIDI_FORMAT_BATCH_SIZE + 2;
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midiDaisyChain) == true);
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
 
-    //there are several reads now which should return failure:
-    //5 more failed reads until wrong XOR packet is cleared out of memory
-    //2 more failed reads for first two bytes
-    for (int i = 0; i < 7; i++)
+    TEST_ASSERT(OpenDeckMIDIformat::readAll(TEST_MIDI_CHANNEL, [](MIDI::USBMIDIpacket_t& USBMIDIpacket, OpenDeckMIDIformat::packetType_t packetType) {
+                    if (USBMIDIpacket.Data3 == (OPENDECK_MIDI_FORMAT_BATCH_SIZE + 2))
+                        TEST_ASSERT(packetType == OpenDeckMIDIformat::packetType_t::midiDaisyChain);
+                    else
+                        TEST_ASSERT(packetType == OpenDeckMIDIformat::packetType_t::midi);
+
+                    receivedData[receivedCount++] = USBMIDIpacket.Data3;
+                }) == (OPENDECK_MIDI_FORMAT_BATCH_SIZE + 3));
+
+    for (int i = 0; i < (OPENDECK_MIDI_FORMAT_BATCH_SIZE + 3); i++)
+        TEST_ASSERT(receivedData[i] == i);
+
+    //corrupted batch frame should be dropped as a whole
+    for (int i = 0; i < 2; i++)
+    {
+        sending.Data3 = i;
+        TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+    }
+
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+
+    uint8_t frame[4 + (2 * 4)];
+
+    for (size_t i = 0; i < sizeof(frame); i++)
+        TEST_ASSERT(Board::UART::read(TEST_MIDI_CHANNEL, frame[i]) == true);
+
+    frame[sizeof(frame) - 1] ^= 0xFF;
+
+    for (size_t i = 0; i < sizeof(frame); i++)
+        TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, frame[i]));
+
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+}
+
+TEST_CASE(BaudRate)
+{
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+
+    //all the data written to uart is read back so the board sees its own commands returned as if
+    //they were passed on by other boards
+    core::timing::detail::rTime_ms = 0;
+    OpenDeckMIDIformat::negotiateBaudRate(TEST_MIDI_CHANNEL);
+
+    TEST_ASSERT(OpenDeckMIDIformat::baudRate(TEST_MIDI_CHANNEL) == UART_BAUDRATE_MIDI_OD);
+
+    //request, switch and verify commands
+    for (int i = 0; i < 3; i++)
+    {
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+        TEST_ASSERT(receivedPacketType == OpenDeckMIDIformat::packetType_t::internalCommand);
+    }
+
+    TEST_ASSERT(OpenDeckMIDIformat::baudRate(TEST_MIDI_CHANNEL) == UART_BAUDRATE_MIDI_OD_MAX);
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD_MAX);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+
+    //request has been returned without passing through any other board
+    TEST_ASSERT(OpenDeckMIDIformat::nodes(TEST_MIDI_CHANNEL) == 0);
+
+    //nothing should change after the negotiation is done
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD_MAX);
+
+    //test pattern is lost - next lower rate should be used
+    OpenDeckMIDIformat::negotiateBaudRate(TEST_MIDI_CHANNEL);
+
+    for (int i = 0; i < 2; i++)
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD_MAX);
+
+    //pattern isn't returned in time
+    buffer.reset();
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD);
+
+    for (int i = 0; i < 2; i++)
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    TEST_ASSERT(uartBaudRate == 500000);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+
+    //other side doesn't respond - request should be repeated limited number of times
+    uartConnected = false;
+    uartDropped   = 0;
+
+    OpenDeckMIDIformat::negotiateBaudRate(TEST_MIDI_CHANNEL);
+
+    //reset commands for all the rates above the default one and first request
+    TEST_ASSERT(uartDropped == (4 * OPENDECK_MIDI_FORMAT_PACKET_SIZE));
+
+    for (int i = 0; i < (OPENDECK_MIDI_FORMAT_BAUD_RATE_ATTEMPTS * 2); i++)
+    {
+        core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT;
         TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    }
+
+    TEST_ASSERT(uartDropped == ((3 + OPENDECK_MIDI_FORMAT_BAUD_RATE_ATTEMPTS) * OPENDECK_MIDI_FORMAT_PACKET_SIZE));
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD);
+
+    uartConnected = true;
+
+    //board which doesn't start the negotiation passes the commands on
+    OpenDeckMIDIformat::resetBaudRate(TEST_MIDI_CHANNEL);
+
+    MIDI::USBMIDIpacket_t sending;
 
-    //next read should return success
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::baudRateSwitch);
+    sending.Data1 = 1;
+    sending.Data2 = 0;
+    sending.Data3 = 0;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(uartBaudRate == 250000);
+
+    //passed on switch command is cleared by re-initialization in uart stub
+    //without the test pattern, default rate is restored
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD);
+}
+
+TEST_CASE(Addressing)
+{
+    MIDI::USBMIDIpacket_t            sending;
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+
+    OpenDeckMIDIformat::resetBaudRate(TEST_MIDI_CHANNEL);
+    buffer.reset();
+
+    //board which receives the request takes the address from it and passes on the next one
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::baudRateRequest);
+    sending.Data1 = 0;
+    sending.Data2 = 3;
+    sending.Data3 = 0;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::address(TEST_MIDI_CHANNEL) == 3);
+
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(receiving.Event == static_cast<uint8_t>(OpenDeckMIDIformat::command_t::baudRateRequest));
+    TEST_ASSERT(receiving.Data2 == 4);
+    TEST_ASSERT(OpenDeckMIDIformat::address(TEST_MIDI_CHANNEL) == 4);
+
+    //boards beyond the addressable range don't get the address
+    buffer.reset();
+    sending.Data2 = OPENDECK_MIDI_FORMAT_MAX_NODES + 1;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::address(TEST_MIDI_CHANNEL) == 0);
+
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(receiving.Data2 == (OPENDECK_MIDI_FORMAT_MAX_NODES + 1));
+    buffer.reset();
+}
+
+TEST_CASE(Stats)
+{
+    MIDI::USBMIDIpacket_t            sending;
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+    OpenDeckMIDIformat::stats_t      stats;
+
+    OpenDeckMIDIformat::resetStats(TEST_MIDI_CHANNEL);
+    buffer.reset();
+
+    sending.Event = static_cast<uint8_t>(MIDI::messageType_t::noteOn);
+    sending.Data1 = 0x10;
+    sending.Data2 = 0x20;
+    sending.Data3 = 0x30;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    //corrupt the checksum of the next frame
+    uint8_t frame[OPENDECK_MIDI_FORMAT_PACKET_SIZE];
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+    OpenDeckMIDIformat::flush(TEST_MIDI_CHANNEL);
+
+    for (int i = 0; i < OPENDECK_MIDI_FORMAT_PACKET_SIZE; i++)
+        TEST_ASSERT(Board::UART::read(TEST_MIDI_CHANNEL, frame[i]) == true);
+
+    frame[OPENDECK_MIDI_FORMAT_PACKET_SIZE - 1] ^= 0x01;
+
+    for (int i = 0; i < OPENDECK_MIDI_FORMAT_PACKET_SIZE; i++)
+        TEST_ASSERT(true == Board::UART::write(TEST_MIDI_CHANNEL, frame[i]));
+
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+
+    uartRxDropped = 3;
+
+    TEST_ASSERT(OpenDeckMIDIformat::stats(TEST_MIDI_CHANNEL, stats) == true);
+    TEST_ASSERT(stats.framesSent == 2);
+    TEST_ASSERT(stats.framesReceived == 1);
+    TEST_ASSERT(stats.crcErrors == 1);
+    TEST_ASSERT(stats.resyncs == 1);
+    TEST_ASSERT(stats.rxOverflows == 3);
+
+    //counters should be cleared
+    OpenDeckMIDIformat::resetStats(TEST_MIDI_CHANNEL);
+    TEST_ASSERT(OpenDeckMIDIformat::stats(TEST_MIDI_CHANNEL, stats) == true);
+    TEST_ASSERT(stats.framesSent == 0);
+    TEST_ASSERT(stats.framesReceived == 0);
+    TEST_ASSERT(stats.crcErrors == 0);
+    TEST_ASSERT(stats.resyncs == 0);
+    TEST_ASSERT(stats.rxOverflows == 0);
+
+    TEST_ASSERT(OpenDeckMIDIformat::stats(UART_INTERFACES, stats) == false);
+}
+
+TEST_CASE(Ping)
+{
+    MIDI::USBMIDIpacket_t            sending;
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+    OpenDeckMIDIformat::stats_t      stats;
+
+    buffer.reset();
+    OpenDeckMIDIformat::resetStats(TEST_MIDI_CHANNEL);
+
+    //board which has started the negotiation pings other boards once it's done
+    core::timing::detail::rTime_ms = 0;
+    OpenDeckMIDIformat::negotiateBaudRate(TEST_MIDI_CHANNEL);
+
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_PING_INTERVAL;
+
+    //ping is returned right away
     TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
     TEST_ASSERT(receivedPacketType == OpenDeckMIDIformat::packetType_t::internalCommand);
-    rebootType = Board::rebootType_t::rebootBtldr;
+    TEST_ASSERT(receiving.Event == static_cast<uint8_t>(OpenDeckMIDIformat::command_t::ping));
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+
+    TEST_ASSERT(OpenDeckMIDIformat::stats(TEST_MIDI_CHANNEL, stats) == true);
+    TEST_ASSERT(stats.pingTime == 250);
+    TEST_ASSERT(stats.pingHops == 0);
+    TEST_ASSERT(stats.hopTime == 250);
+    TEST_ASSERT(stats.pingsLost == 0);
+
+    //next ping isn't sent before the interval passes
+    uartConnected = false;
+    uartDropped   = 0;
+
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_PING_INTERVAL - 1;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(uartDropped == 0);
+
+    core::timing::detail::rTime_ms++;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(uartDropped == OPENDECK_MIDI_FORMAT_PACKET_SIZE);
+
+    //ping which hasn't returned is counted once the next one is sent
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_PING_INTERVAL;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(OpenDeckMIDIformat::stats(TEST_MIDI_CHANNEL, stats) == true);
+    TEST_ASSERT(stats.pingsLost == 1);
+
+    uartConnected = true;
+
+    //latency of single board is reported as well
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::ping);
+    sending.Data1 = 3;
+    sending.Data2 = 3;
+    sending.Data3 = 0;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::stats(TEST_MIDI_CHANNEL, stats) == true);
+    TEST_ASSERT(stats.pingTime == 250);
+    TEST_ASSERT(stats.pingHops == 3);
+    TEST_ASSERT(stats.hopTime == 62);
+
+    //other boards pass the ping on and increase the number of hops
+    OpenDeckMIDIformat::resetBaudRate(TEST_MIDI_CHANNEL);
+
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::ping);
+    sending.Data1 = 5;
+    sending.Data2 = 2;
+    sending.Data3 = 0;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(receiving.Event == static_cast<uint8_t>(OpenDeckMIDIformat::command_t::ping));
+    TEST_ASSERT(receiving.Data1 == 5);
+    TEST_ASSERT(receiving.Data2 == 3);
+    buffer.reset();
+}
+
+TEST_CASE(DeferredSwitch)
+{
+    MIDI::USBMIDIpacket_t            sending;
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+
+    OpenDeckMIDIformat::resetBaudRate(TEST_MIDI_CHANNEL);
+    buffer.reset();
+
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::baudRateSwitch);
+    sending.Data1 = 1;
+    sending.Data2 = 0;
+    sending.Data3 = 0;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+
+    //rate isn't switched while the passed on command is still being sent
+    uartTxEmpty = false;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD);
+    TEST_ASSERT(OpenDeckMIDIformat::baudRate(TEST_MIDI_CHANNEL) == UART_BAUDRATE_MIDI_OD);
+
+    //nothing can be written until the switch is done
+    sending.Event = static_cast<uint8_t>(MIDI::messageType_t::noteOn);
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == false);
+
+    uartTxEmpty = true;
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(uartBaudRate == 250000);
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::midi) == true);
+
+    OpenDeckMIDIformat::resetBaudRate(TEST_MIDI_CHANNEL);
+    buffer.reset();
+}
+
+TEST_CASE(LinkFallback)
+{
+    MIDI::USBMIDIpacket_t            sending;
+    MIDI::USBMIDIpacket_t            receiving;
+    OpenDeckMIDIformat::packetType_t receivedPacketType;
+
+    //initiating board negotiates the rate again once the other side stops responding
+    buffer.reset();
+    core::timing::detail::rTime_ms = 0;
+    OpenDeckMIDIformat::negotiateBaudRate(TEST_MIDI_CHANNEL);
+
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    uartConnected = false;
+
+    for (int i = 0; i < (OPENDECK_MIDI_FORMAT_LINK_TIMEOUT / OPENDECK_MIDI_FORMAT_PING_INTERVAL); i++)
+    {
+        TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD_MAX);
+        core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_PING_INTERVAL;
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    }
+
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD);
+
+    //request is repeated once the other side is back
+    uartConnected = true;
+    core::timing::detail::rTime_ms += OPENDECK_MIDI_FORMAT_BAUD_RATE_TIMEOUT;
+
+    for (int i = 0; i < 3; i++)
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD_MAX);
+
+    //other boards return to the default rate once they receive only invalid frames
+    OpenDeckMIDIformat::resetBaudRate(TEST_MIDI_CHANNEL);
+    buffer.reset();
+
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::baudRateSwitch);
+    sending.Data1 = 1;
+    sending.Data2 = 0;
+    sending.Data3 = 0;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    sending.Event = static_cast<uint8_t>(OpenDeckMIDIformat::command_t::baudRateVerify);
+    sending.Data1 = 0x55;
+    sending.Data2 = 0xAA;
+    sending.Data3 = 0x33;
+
+    TEST_ASSERT(OpenDeckMIDIformat::write(TEST_MIDI_CHANNEL, sending, OpenDeckMIDIformat::packetType_t::internalCommand) == true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+    buffer.reset();
+
+    TEST_ASSERT(uartBaudRate == 250000);
+
+    uint8_t frame[OPENDECK_MIDI_FORMAT_PACKET_SIZE] = { static_cast<uint8_t>(OpenDeckMIDIformat::packetType_t::midi), 0x09, 0x90, 0x40, 0x7F, 0x00 };
+
+    auto writeFrame = [&frame](bool valid) {
+        frame[OPENDECK_MIDI_FORMAT_PACKET_SIZE - 1] = OpenDeckMIDIformat::crc8(frame, OPENDECK_MIDI_FORMAT_PACKET_SIZE - 1) ^ (valid ? 0x00 : 0x01);
+
+        for (int i = 0; i < OPENDECK_MIDI_FORMAT_PACKET_SIZE; i++)
+            TEST_ASSERT(Board::UART::write(TEST_MIDI_CHANNEL, frame[i]) == true);
+    };
+
+    //valid frame restarts the count
+    for (int i = 0; i < (OPENDECK_MIDI_FORMAT_FALLBACK_ERRORS - 1); i++)
+    {
+        writeFrame(false);
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    }
+
+    writeFrame(true);
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == true);
+
+    for (int i = 0; i < OPENDECK_MIDI_FORMAT_FALLBACK_ERRORS; i++)
+    {
+        TEST_ASSERT(uartBaudRate == 250000);
+        writeFrame(false);
+        TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    }
+
+    //rate is switched on the next read
+    TEST_ASSERT(OpenDeckMIDIformat::read(TEST_MIDI_CHANNEL, receiving, receivedPacketType) == false);
+    TEST_ASSERT(uartBaudRate == UART_BAUDRATE_MIDI_OD);
+    buffer.reset();
 }
 
 #endif
@@ -0,0 +1,124 @@
+#include "unity/src/unity.h"
+#include "unity/Helpers.h"
+#include "OpenDeck/UMP.h"
+
+namespace
+{
+    MIDI::USBMIDIpacket_t packet(uint8_t event, uint8_t data1, uint8_t data2, uint8_t data3)
+    {
+        MIDI::USBMIDIpacket_t packet;
+
+        packet.Event = event;
+        packet.Data1 = data1;
+        packet.Data2 = data2;
+        packet.Data3 = data3;
+
+        return packet;
+    }
+
+    void verifyPacket(const MIDI::USBMIDIpacket_t& packet, uint8_t event, uint8_t data1, uint8_t data2, uint8_t data3)
+    {
+        TEST_ASSERT_EQUAL_UINT32(event, packet.Event);
+        TEST_ASSERT_EQUAL_UINT32(data1, packet.Data1);
+        TEST_ASSERT_EQUAL_UINT32(data2, packet.Data2);
+        TEST_ASSERT_EQUAL_UINT32(data3, packet.Data3);
+    }
+}    // namespace
+
+TEST_CASE(Scaling)
+{
+    //minimum, center and maximum values are preserved
+    TEST_ASSERT_EQUAL_UINT32(0, UMP::scaleUp(0, 7, 32));
+    TEST_ASSERT_EQUAL_UINT32(0x80000000, UMP::scaleUp(64, 7, 32));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, UMP::scaleUp(127, 7, 32));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFF, UMP::scaleUp(127, 7, 16));
+    TEST_ASSERT_EQUAL_UINT32(0x80000000, UMP::scaleUp(8192, 14, 32));
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, UMP::scaleUp(16383, 14, 32));
+
+    for (uint32_t i = 0; i < 16384; i++)
+        TEST_ASSERT_EQUAL_UINT32(i, UMP::scaleDown(UMP::scaleUp(i, 14, 32), 32, 14));
+}
+
+TEST_CASE(ToUMP)
+{
+    uint32_t words[UMP_MAX_WORDS];
+
+    //control change on cable 1
+    TEST_ASSERT_EQUAL_UINT32(2, UMP::fromUSBMIDI(packet(0x1B, 0xB2, 7, 127), words));
+    TEST_ASSERT_EQUAL_UINT32(0x41B20700, words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFFFF, words[1]);
+
+    //note on with velocity 0 is note off
+    TEST_ASSERT_EQUAL_UINT32(2, UMP::fromUSBMIDI(packet(0x09, 0x90, 60, 0), words));
+    TEST_ASSERT_EQUAL_UINT32(0x40803C00, words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, words[1]);
+
+    //pitch bend center
+    TEST_ASSERT_EQUAL_UINT32(2, UMP::fromUSBMIDI(packet(0x0E, 0xE0, 0x00, 0x40), words));
+    TEST_ASSERT_EQUAL_UINT32(0x40E00000, words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0x80000000, words[1]);
+
+    //real-time message
+    TEST_ASSERT_EQUAL_UINT32(1, UMP::fromUSBMIDI(packet(0x0F, 0xF8, 0, 0), words));
+    TEST_ASSERT_EQUAL_UINT32(0x10F80000, words[0]);
+
+    //system exclusive message split into start, continue and end
+    TEST_ASSERT_EQUAL_UINT32(2, UMP::fromUSBMIDI(packet(0x04, 0xF0, 0x00, 0x53), words));
+    TEST_ASSERT_EQUAL_UINT32(0x30120053, words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, words[1]);
+
+    TEST_ASSERT_EQUAL_UINT32(2, UMP::fromUSBMIDI(packet(0x04, 0x43, 0x4F, 0x44), words));
+    TEST_ASSERT_EQUAL_UINT32(0x3023434F, words[0]);
+    TEST_ASSERT_EQUAL_UINT32(0x44000000, words[1]);
+
+    TEST_ASSERT_EQUAL_UINT32(2, UMP::fromUSBMIDI(packet(0x05, 0xF7, 0, 0), words));
+    TEST_ASSERT_EQUAL_UINT32(0x30300000, words[0]);
+
+    //single byte system common message uses the same code index number as system exclusive end
+    TEST_ASSERT_EQUAL_UINT32(1, UMP::fromUSBMIDI(packet(0x05, 0xF6, 0, 0), words));
+    TEST_ASSERT_EQUAL_UINT32(0x10F60000, words[0]);
+}
+
+TEST_CASE(FromUMP)
+{
+    UMP                   ump;
+    MIDI::USBMIDIpacket_t packets[UMP_MAX_USB_PACKETS];
+
+    //MIDI 1.0 channel voice message is passed as is
+    uint32_t midi1[] = { 0x22903C40 };
+    TEST_ASSERT_EQUAL_UINT32(1, ump.toUSBMIDI(midi1, packets));
+    verifyPacket(packets[0], 0x29, 0x90, 0x3C, 0x40);
+
+    //MIDI 2.0 control change is scaled down
+    uint32_t cc[] = { 0x40B10A00, 0x80000000 };
+    TEST_ASSERT_EQUAL_UINT32(1, ump.toUSBMIDI(cc, packets));
+    verifyPacket(packets[0], 0x0B, 0xB1, 0x0A, 0x40);
+
+    //note on velocity can't be 0
+    uint32_t noteOn[] = { 0x40903C00, 0x00010000 };
+    TEST_ASSERT_EQUAL_UINT32(1, ump.toUSBMIDI(noteOn, packets));
+    verifyPacket(packets[0], 0x09, 0x90, 0x3C, 0x01);
+
+    //assignable controller is converted to NRPN
+    uint32_t nrpn[] = { 0x40300205, UMP::scaleUp(1000, 14, 32) };
+    TEST_ASSERT_EQUAL_UINT32(4, ump.toUSBMIDI(nrpn, packets));
+    verifyPacket(packets[0], 0x0B, 0xB0, 99, 0x02);
+    verifyPacket(packets[1], 0x0B, 0xB0, 98, 0x05);
+    verifyPacket(packets[2], 0x0B, 0xB0, 6, 1000 >> 7);
+    verifyPacket(packets[3], 0x0B, 0xB0, 38, 1000 & 0x7F);
+
+    //system exclusive message spanning two UMP messages: F0 01 02 03 04 05 06 07 F7
+    uint32_t sysExStart[] = { 0x30160102, 0x03040506 };
+    TEST_ASSERT_EQUAL_UINT32(2, ump.toUSBMIDI(sysExStart, packets));
+    verifyPacket(packets[0], 0x04, 0xF0, 0x01, 0x02);
+    verifyPacket(packets[1], 0x04, 0x03, 0x04, 0x05);
+
+    uint32_t sysExEnd[] = { 0x30310700, 0x00000000 };
+    TEST_ASSERT_EQUAL_UINT32(1, ump.toUSBMIDI(sysExEnd, packets));
+    verifyPacket(packets[0], 0x07, 0x06, 0x07, 0xF7);
+
+    //message types without MIDI 1.0 equivalent are ignored
+    uint32_t data[] = { 0x50000000, 0, 0, 0 };
+    TEST_ASSERT_EQUAL_UINT32(0, ump.toUSBMIDI(data, packets));
+    TEST_ASSERT_EQUAL_UINT32(4, UMP::messageWords(data[0]));
+}